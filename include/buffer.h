@@ -67,17 +67,28 @@ public:
     }
 
 
+    // 交换两个缓冲区的内容，不拷贝数据
+    void swap(Buffer& rhs){
+        buffer_.swap(rhs.buffer_);
+        std::swap(reader_index_, rhs.reader_index_);
+        std::swap(write_index_, rhs.write_index_);
+    }
+
     // 从fd读取数据到缓冲区
     ssize_t readFd(int fd, int* saved_errno);
 
-private:
-    // 提供只读和可修改重载
-    char* begin() { return &*buffer_.begin(); }
-    const char* begin() const { return &*buffer_.begin(); }
+    // 直接向可写区域写入数据（如SSL_read），写完后调用hasWritten提交
     char* beginWrite() { return begin() + write_index_; }
     const char* beginWrite() const { return begin() + write_index_; }
-
-    void hasWritten(size_t len) { write_index_ += len; }
+    void hasWritten(size_t len) {
+        assert(len <= writableBytes());
+        write_index_ += len;
+    }
+    // 撤销最近写入的len字节
+    void unwrite(size_t len) {
+        assert(len <= readableBytes());
+        write_index_ -= len;
+    }
 
     void ensureWritableBytes(size_t len){
         if(writableBytes() < len){
@@ -86,6 +97,11 @@ private:
         assert(writableBytes() >= len);
     }
 
+private:
+    // 提供只读和可修改重载
+    char* begin() { return &*buffer_.begin(); }
+    const char* begin() const { return &*buffer_.begin(); }
+
     // 空间扩容
     void makeSpace(size_t len);
 
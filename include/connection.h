@@ -3,11 +3,16 @@
 #include "net/channel.h"
 #include "socket.h"
 #include "buffer.h"
+#include "shared_buffer.h"
 #include "utils/timestamp.h"
 #include "http_request.h"
 #include "net/timer.h"
 #include <memory>
 #include <functional>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <openssl/ssl.h>
 #include <any> // cpp17 用于存储定时器上下文, 类型安全的方式持有任何类型的值
@@ -23,18 +28,46 @@ public:
     using ConnectionCallback = std::function<void(const ConnectionPtr&)>;
     using MessageCallback = std::function<void(const ConnectionPtr&, Buffer*)>;
     using closeCallback = std::function<void(const ConnectionPtr&)>;
+    // 流式发送的数据源：向 buf 追加下一段数据，返回 false 表示数据已全部产生
+    using StreamProducer = std::function<bool(Buffer* buf)>;
+    // 零拷贝流式发送的数据源：给出下一段数据的只读视图，视图须保持有效直到下一次调用
+    using SliceProducer = std::function<bool(std::string_view* slice)>;
+
+    static const size_t kDefaultInputWindow = 256 * 1024;
+    // 流式发送时输出缓冲区低于该值才向生产者要数据
+    static const size_t kStreamLowWaterMark = 64 * 1024;
+    // 更小的共享数据直接拷贝进输出缓冲区，省去单独的 iovec 和引用计数
+    static const size_t kMinSharedSize = 16 * 1024;
 
     // ssl为nullptr则为普通HTTP连接
     Connection(EventLoop* loop, int sockfd, const struct sockaddr_in& peer_addr, SSL* ssl);
     ~Connection();
     
     void send(const std::string& msg);
+    // 在 I/O 线程中调用时直接接管 buf 的内容（buf 被清空），不做额外拷贝
     void send(Buffer* buf);
+    // 发送 buf（如响应头）及其后的共享数据（如响应正文）：共享数据不小于 kMinSharedSize 时
+    // 以引用方式排进输出队列，直接交给 writev / SSL_write，缓存和广播的内容发给多少连接都不拷贝
+    void send(Buffer* buf, const SharedBuffer& data);
+    void send(const SharedBuffer& data);
+    // 流式发送：由可写事件驱动，输出缓冲区低于低水位时调用 producer 补充数据，socket 写不动时自然暂停，
+    // producer 返回 false 后调用 done。必须在 I/O 线程中调用，期间不应再调用 send
+    void sendStream(const StreamProducer& producer, const ConnectionCallback& done);
+    // 同 sendStream，但数据不经过输出缓冲区：每段直接交给 SSL_write 或与缓冲区中的数据一起 writev，
+    // 上一段写完后才取下一段
+    void sendSliceStream(const SliceProducer& producer, const ConnectionCallback& done);
+    bool isStreaming() const { return stream_producer_ || slice_producer_; }
+    // 生产者暂时没有数据时（如等待磁盘读取）不产生数据，数据就绪后调用返回的函数继续发送；
+    // 返回的函数可在任意线程调用，连接已销毁时什么也不做
+    std::function<void()> streamWakeup();
 
     // 设置回调函数
     void setConnectionCallback(const ConnectionCallback& cb) { connection_callback_ = cb; }
     void setMessageCallback(const MessageCallback& cb) { message_callback_ = cb; }
     void setCloseCallback(const closeCallback& cb) { close_callback_ = cb; }
+    // 读事件中输入缓冲区累计到 bytes 时立即交给消息回调，而不是读空 socket 后再处理，
+    // 使流式请求体（大文件上传）的内存占用不超过该窗口
+    void setInputWindow(size_t bytes) { input_window_ = bytes; }
 
     // 当建立连接时由Server调用
     void connectionEstablished();
@@ -51,6 +84,9 @@ public:
 
     // 设置当前连接的状态
     void setState(StateE s) { state_ = s; }
+    bool connected() const { return state_ == kConnected; }
+    // 尚未写出的数据量，推送方据此判断对端是否跟得上
+    size_t outputBytes() const;
 
     // 让Server可以获得Channel
     Channel* getChannel() const { return channel_.get(); }
@@ -66,6 +102,16 @@ public:
     Timestamp getLastActiveTime() const { return last_active_time_; }
 
     HttpRequest& getRequest() { return request_; }
+
+    // 协议层状态（如 HTTP/2 会话），由业务回调自行解释
+    void setContext(const std::any& context) { context_ = context; }
+    std::any* getMutableContext() { return &context_; }
+
+    // TLS 握手时 ALPN 协商结果为 h2
+    bool negotiatedHttp2() const;
+
+    // TLS 1.3 握手尚未完成，当前数据来自 0-RTT early data（可能被重放）
+    bool inEarlyData() const { return ssl_ && ssl_state_ == SslState::kHandshaking; }
 private:
     // 在Server主循环中被调用，处理读事件
     void handleRead();
@@ -77,11 +123,44 @@ private:
     void handleError();
 
     void sendInLoop(const std::string& msg);
+    void sendSharedInLoop(const SharedBuffer& data);
+    // 消息回调期间的明文输出先按响应暂存，回调结束后用一次 writev 写出
+    void appendToBatch(Buffer* buf, const SharedBuffer& data = SharedBuffer());
+    // 共享数据排在输出缓冲区现有数据之后，太小时直接拷贝
+    void appendShared(const SharedBuffer& data);
+    // 按发送顺序（缓冲区数据与共享数据交错，最后是流式切片）填充 iov，返回个数
+    int gatherOutput(struct iovec* iov, int max_iov) const;
+    // 从输出队列头部移除已写出的 n 字节
+    void consumeOutput(size_t n);
+    void flushBatch();
     void shutdownInLoop();
     void forceCloseInLoop(); 
 
     // SSL握手逻辑
     void handleHandShake();
+    // 读取 0-RTT early data，返回 true 表示 early data 阶段已结束，可以继续握手
+    bool readEarlyData();
+    // 将已读到的 early data 交给业务回调，并以 0.5-RTT 写出产生的响应
+    void dispatchEarlyData();
+    // 根据握手返回的 WANT_READ/WANT_WRITE 调整监听事件
+    void waitForHandshakeIo(int ssl_err);
+
+    // 按动态记录大小将output_buffer_（及其后的流式切片）写入SSL，出错时返回false
+    bool writeSslOutput();
+    // 当前应使用的TLS记录大小：连接初期用小记录降低首字节时间，之后增长到16KB
+    size_t tlsRecordSize() const;
+    // SSL关闭流程的一步，可能需要多次I/O才能完成
+    void sslShutdownStep();
+
+    // 将输入缓冲区交给消息回调，并写出回调期间产生的 TLS 输出
+    void deliverInput();
+    // 在输出缓冲区低于低水位时向其中填充流式数据（或取下一个切片），生产结束时调用 stream_done_
+    void fillStream();
+    void startStream(const ConnectionCallback& done);
+    void resumeStream();
+    void finishStream();
+    bool hasBufferedOutput() const { return output_buffer_.readableBytes() > 0 || !shared_output_.empty(); }
+    bool hasPendingOutput() const { return hasBufferedOutput() || !stream_slice_.empty(); }
 
     // 一个私有函数，用于在连接真正建立后（HTTP）或握手成功后（HTTPS）进行通用设置
     void onConnectionEstablished();
@@ -91,6 +170,13 @@ private:
     std::unique_ptr<Channel> channel_; // 每个connection拥有一个Channel
     Buffer input_buffer_;
     Buffer output_buffer_;
+    // 以引用方式排队的共享数据，每段排在输出缓冲区中（上一段共享数据之后的）前 before 字节之后
+    struct SharedSlice {
+        size_t before;
+        SharedBuffer data;
+    };
+    std::deque<SharedSlice> shared_output_;
+    size_t shared_before_; // 各段 before 之和，即输出缓冲区中排在最后一段共享数据之前的字节数
 
     ConnectionCallback connection_callback_;
     MessageCallback message_callback_;
@@ -106,4 +192,34 @@ private:
     enum class SslState { kHandshaking, kEstablished, kClosing};
     SslState ssl_state_;
     HttpRequest request_; 
+
+    // message_callback_执行期间为true，此时TLS发送只写入output_buffer_，明文发送暂存在batch_，
+    // 回调结束后合并为一次写出
+    bool in_message_callback_;
+    // 一批流水线请求产生的响应，每个元素是一条响应（头部和以引用方式携带的正文）；
+    // 只在输出队列为空时使用，保证顺序
+    struct BatchEntry {
+        Buffer buf;
+        SharedBuffer data;
+    };
+    std::vector<BatchEntry> batch_;
+    // SSL_write返回WANT_*后必须以相同长度重试
+    size_t ssl_retry_len_;
+    // 空闲后累计写出的TLS明文字节数，用于决定记录大小
+    size_t tls_bytes_since_idle_;
+    Timestamp last_write_time_;
+
+    // 是否仍处于读取 0-RTT early data 的阶段
+    bool reading_early_data_;
+    // early data 阶段请求了关闭，握手完成并写完响应后再执行
+    bool shutdown_after_handshake_;
+
+    size_t input_window_;
+
+    StreamProducer stream_producer_;
+    SliceProducer slice_producer_;
+    std::string_view stream_slice_;   // 尚未写出的切片，排在 output_buffer_ 之后
+    ConnectionCallback stream_done_;
+
+    std::any context_;
 };
\ No newline at end of file
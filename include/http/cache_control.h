@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <regex>
+
+// 静态资源的 Cache-Control 策略，由 server.ini 的 [cache_control] 节按路径模式配置
+// 规则按添加顺序匹配，第一个匹配的生效；没有规则匹配时不发送 Cache-Control
+class CacheControlPolicy {
+public:
+    static CacheControlPolicy& instance();
+
+    // 启动时添加规则，之后只读，不加锁
+    // @return: 正则表达式编译成功返回 true
+    bool addRule(const std::string& path_pattern, const std::string& directive);
+
+    // 请求路径匹配的 Cache-Control 值，没有匹配时返回 nullptr
+    const std::string* lookup(const std::string& path) const;
+
+private:
+    CacheControlPolicy() = default;
+
+    struct Rule {
+        std::regex path_regex;
+        std::string directive;
+    };
+    std::vector<Rule> rules_;
+};
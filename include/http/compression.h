@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+class Buffer;
+struct z_stream_s;
+struct BrotliEncoderStateStruct;
+
+// 响应正文的内容编码（gzip / brotli）与 Accept-Encoding 协商
+namespace Compression {
+
+enum Encoding { kIdentity, kGzip, kBrotli };
+
+// 按 Accept-Encoding 选出客户端可接受且 q 值最高的压缩编码，q 值相同时优先 br
+// 客户端不接受任何压缩编码时返回 kIdentity
+Encoding negotiate(std::string_view accept_encoding);
+
+// Content-Encoding 头部使用的名字，kIdentity 返回空串
+const char* encodingName(Encoding encoding);
+
+// level: zlib 压缩级别 1~9
+bool gzip(std::string_view input, std::string* output, int level);
+// quality: brotli 质量 0~11
+bool brotli(std::string_view input, std::string* output, int quality);
+
+// 流式压缩器，用于长度事先未知的流式正文
+// 每次调用后已输入的数据都会被刷出（gzip 的 Z_SYNC_FLUSH，brotli 的 FLUSH），客户端无需等到正文结束即可解压
+class StreamCompressor {
+public:
+    // level: gzip 时为 zlib 压缩级别，brotli 时为质量
+    StreamCompressor(Encoding encoding, int level);
+    ~StreamCompressor();
+    StreamCompressor(const StreamCompressor&) = delete;
+    StreamCompressor& operator=(const StreamCompressor&) = delete;
+
+    // 压缩 input 并把输出追加到 output；finish 为 true 时结束压缩流，之后不能再调用
+    bool compress(std::string_view input, bool finish, Buffer* output);
+
+private:
+    bool compressGzip(std::string_view input, bool finish, Buffer* output);
+    bool compressBrotli(std::string_view input, bool finish, Buffer* output);
+
+    Encoding encoding_;
+    z_stream_s* zstream_;
+    BrotliEncoderStateStruct* brotli_;
+};
+
+} // namespace Compression
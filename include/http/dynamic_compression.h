@@ -0,0 +1,54 @@
+#pragma once
+#include "http_request.h"
+#include "http_response.h"
+#include "http/compression.h"
+#include <string>
+#include <map>
+#include <mutex>
+#include <cstdint>
+
+// 动态响应（接口返回的 JSON 等）的实时压缩
+// 压缩级别随处理请求的 I/O 线程繁忙程度调整：空闲时用较高级别换压缩率，繁忙时降到最快级别，
+// 过载时不压缩，把 CPU 留给请求处理。按路由统计压缩率与 CPU 耗时，用于调整阈值
+class DynamicCompression {
+public:
+    struct Options {
+        bool enabled = true;
+        size_t min_size = 1024;   // 小于该字节数的响应不压缩（流式响应长度未知，总是压缩）
+        double fast_load = 0.5;   // 繁忙度超过该值改用最快的压缩级别
+        double off_load = 0.85;   // 繁忙度超过该值不再压缩
+    };
+
+    struct RouteStats {
+        uint64_t compressed = 0;       // 压缩过的响应数
+        uint64_t fast = 0;             // 其中使用最快级别的响应数
+        uint64_t skipped_busy = 0;     // 因线程繁忙而未压缩的响应数
+        uint64_t bytes_in = 0;
+        uint64_t bytes_out = 0;
+        uint64_t cpu_ns = 0;           // 压缩消耗的线程 CPU 时间
+    };
+
+    static DynamicCompression& instance();
+
+    void setOptions(const Options& options) { options_ = options; }
+    const Options& options() const { return options_; }
+
+    // 路由处理完成后、序列化之前调用：按 Accept-Encoding 压缩正文，流式响应则包装其生产者
+    // 已设置 Content-Encoding 或 Vary 的响应（如静态文件）由处理函数自行协商过，不再处理
+    // @param load: 处理该请求的 EventLoop 的 busyRatio()
+    void apply(const HttpRequest& req, HttpResponse* resp, double load);
+
+    // 各路由统计的快照，key 为路由模式
+    std::map<std::string, RouteStats> snapshot() const;
+
+private:
+    DynamicCompression() = default;
+
+    // @return: 压缩级别，0 表示不压缩
+    int chooseLevel(Compression::Encoding encoding, double load) const;
+    void record(const std::string& route, const RouteStats& delta);
+
+    Options options_;
+    mutable std::mutex mutex_;
+    std::map<std::string, RouteStats> stats_;
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include "http/static_file_cache.h"
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <ctime>
+
+// 构建时由 embed_assets 工具从 www/ 生成的一个资源，数据位于只读段，多个进程共享同一份物理页
+struct EmbeddedAsset {
+    const char* path;            // 请求路径，如 "/index.html"
+    const char* mime_type;
+    const char* etag;            // 由内容哈希生成，不依赖部署后的文件系统
+    time_t mtime;                // 构建时源文件的修改时间
+    const unsigned char* data;
+    size_t size;
+    const unsigned char* gzip;   // 没有压缩变体时为 nullptr
+    size_t gzip_size;
+    const unsigned char* brotli;
+    size_t brotli_size;
+};
+
+// 编译进程序的静态资源（CMake 选项 EMBED_WWW）
+// 按请求路径直接取得现成的缓存条目，没有磁盘 I/O 和路径规范化；未开启该选项时为空
+class EmbeddedAssets {
+public:
+    // 条目的 Cache-Control 取自 CacheControlPolicy，须在加载规则之后第一次调用
+    static EmbeddedAssets& instance();
+    // 编译进程序的资源数，不构造实例
+    static size_t count();
+
+    std::shared_ptr<const StaticFileCache::Entry> lookup(const std::string& path) const;
+
+private:
+    EmbeddedAssets();
+
+    std::unordered_map<std::string, std::shared_ptr<const StaticFileCache::Entry>> entries_;
+};
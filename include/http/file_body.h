@@ -0,0 +1,75 @@
+#pragma once
+#include "buffer.h"
+#include "http/mapped_file.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <sys/types.h>
+
+// 由文件区间和少量文本拼成的响应正文，作为定长流式正文按需从文件映射中取出
+// 大文件和 Range 请求只触及要发送的部分，内存占用与文件大小无关
+// 开启异步模式后，不在页缓存中的区间交给 DiskIoPool 读入，期间生产者不产生数据，读完后调用 wakeup
+class FileBody {
+public:
+    // 打开文件失败时返回 nullptr
+    static std::shared_ptr<FileBody> open(const std::string& path);
+    FileBody(const FileBody&) = delete;
+    FileBody& operator=(const FileBody&) = delete;
+
+    // 区间超出文件（文件在解析请求后被截断或替换）时返回 false
+    bool addRange(off_t offset, size_t length);
+    // multipart/byteranges 的分隔行和 part 头部
+    void addText(const std::string& text);
+    size_t totalLength() const { return total_length_; }
+    size_t fileSize() const { return file_->size(); }
+    // 所有文件区间是否都已在页缓存中
+    bool resident() const;
+    // 文件在发送期间被截断，正文无法完整发送；此后生产者直接结束，发送方应中止响应
+    bool failed() const { return file_->truncated(); }
+
+    // 开启异步模式；wakeup 可在任意线程调用，负责让发送方再次调用生产者
+    void enableAsync(std::function<void()> wakeup) { wakeup_ = std::move(wakeup); }
+
+    // 读出 [offset, offset + length) 到 content，用于较小的区间直接作为普通正文；文件被截断时返回 false
+    bool readRange(off_t offset, size_t length, std::string* content) const;
+
+    // 作为 HttpResponse::BodyProducer：每次最多写出 kChunkSize 字节，返回 false 表示正文已结束
+    bool produce(Buffer* buf);
+
+    // 作为 HttpResponse::SliceProducer：给出下一段正文的只读视图（指向映射或文本段），不拷贝
+    // 视图在 FileBody 存活期间有效；正文已结束时返回 false
+    bool nextSlice(std::string_view* slice);
+
+    static const size_t kChunkSize = 64 * 1024;
+    // 文件区间的切片上限，也是异步预读的粒度
+    static const size_t kSliceSize = 256 * 1024;
+
+private:
+    explicit FileBody(std::shared_ptr<const MappedFile> file)
+        : file_(std::move(file)), total_length_(0), segment_(0), segment_offset_(0), prefetching_(false) {}
+
+    // text 为空时表示文件区间
+    struct Segment {
+        off_t offset;
+        size_t length;
+        std::string text;
+    };
+
+    // 当前段从 segment_offset_ 开始、最多 limit 字节的视图，并前移位置
+    std::string_view take(size_t limit);
+    // 当前文件段接下来的 length 字节能否不阻塞地访问；不能时提交预读并返回 false
+    bool ready(size_t length);
+
+    std::shared_ptr<const MappedFile> file_;
+    std::vector<Segment> segments_;
+    size_t total_length_;
+    size_t segment_;         // 正在写出的段
+    size_t segment_offset_;  // 该段已写出的字节数
+
+    std::function<void()> wakeup_;
+    bool prefetching_;
+    std::shared_ptr<std::atomic<bool>> prefetch_done_;
+};
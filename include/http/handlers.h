@@ -34,8 +34,21 @@ public:
     HandlerRegistrar(const std::string& name, HttpHandler handler);
 };
 
+// 流式请求体处理器的注册表，与普通 Handler 共用 server.ini 中的名字空间
+using BodyReaderRegistry = std::map<std::string, BodyReaderFactory>;
+
+BodyReaderRegistry& getBodyReaderRegistry();
+
+class BodyReaderRegistrar {
+public:
+    BodyReaderRegistrar(const std::string& name, BodyReaderFactory factory);
+};
+
 } // namespace Handlers
 
 // 用于自动注册的宏
 #define REGISTER_HANDLER(name, func) \
     static Handlers::HandlerRegistrar registrar_##func(name, Handlers::func)
+
+#define REGISTER_BODY_READER(name, factory) \
+    static Handlers::BodyReaderRegistrar body_reader_registrar_##factory(name, Handlers::factory)
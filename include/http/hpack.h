@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <cstddef>
+
+// HPACK 头部压缩（RFC 7541），供 HTTP/2 使用
+
+struct HpackHeader {
+    std::string name;
+    std::string value;
+};
+
+// 解码器：每个 HTTP/2 连接一个，动态表在连接内的所有头部块之间共享
+class HpackDecoder {
+public:
+    // max_table_size: 我们在 SETTINGS_HEADER_TABLE_SIZE 中允许的动态表上限
+    explicit HpackDecoder(size_t max_table_size = 4096);
+
+    // 解码一个完整的头部块（HEADERS + CONTINUATION 拼接后的数据）
+    // @return: 失败返回 false，调用方应以 COMPRESSION_ERROR 关闭连接
+    bool decode(const uint8_t* data, size_t len, std::vector<HpackHeader>* headers);
+
+private:
+    bool lookup(uint64_t index, HpackHeader* header) const;
+    void insert(const HpackHeader& header);
+    void evictTo(size_t size);
+
+    std::deque<HpackHeader> dynamic_table_; // 最新插入的条目在前
+    size_t table_size_;        // 当前动态表大小，按 RFC 7541 4.1 计算（name + value + 32）
+    size_t max_table_size_;    // 当前生效的上限，由动态表大小更新指令调整
+    size_t settings_max_size_; // 动态表大小更新不能超过的值
+};
+
+// 编码器：不使用动态表，只引用静态表，其余以字面量发送
+// 因此无需跟踪对端的 SETTINGS_HEADER_TABLE_SIZE，也不持有状态
+class HpackEncoder {
+public:
+    static void encodeHeader(const std::string& name, const std::string& value, std::string* out);
+};
+
+namespace Hpack {
+// Huffman 解码（RFC 7541 5.2），填充位不合法时返回 false
+bool huffmanDecode(const uint8_t* data, size_t len, std::string* out);
+}
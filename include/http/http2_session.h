@@ -0,0 +1,96 @@
+#pragma once
+#include "buffer.h"
+#include "http_request.h"
+#include "http_response.h"
+#include "http/hpack.h"
+#include "shared_buffer.h"
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// HTTP/2 连接状态（RFC 7540）：帧编解码、HPACK、流复用与流量控制
+// 由 Connection 的 context 持有，每个流解析出的请求仍交给 HttpRouter 处理
+class Http2Session {
+public:
+    using RequestHandler = std::function<void(HttpRequest&, HttpResponse*)>;
+
+    enum PrefaceMatch { kPrefaceMatch, kPrefacePartial, kPrefaceMismatch };
+
+    // 检查缓冲区开头是否为 h2c prior knowledge 的连接前言
+    static PrefaceMatch matchPreface(const Buffer* buf);
+
+    explicit Http2Session(RequestHandler handler);
+
+    // 处理输入缓冲区中所有完整的帧，需要发送的帧追加到 output
+    // @return: false 表示连接应关闭（GOAWAY 已写入 output）
+    bool onData(Buffer* input, Buffer* output);
+
+    // 流式响应在输出缓冲区达到上限时暂停产生数据，由连接的可写事件通过 produce 继续
+    // @return: 是否还有可以立即发送的数据（流量控制窗口耗尽时为 false，等待对端 WINDOW_UPDATE）
+    bool hasWritableData() const;
+    bool produce(Buffer* output);
+
+    // 异步正文（如等待磁盘读取的文件）就绪时调用的 wakeup，负责回到连接的 I/O 线程再次调用 produce
+    // 未设置时异步正文的响应在 dispatch 中同步产生
+    void setWakeup(const HttpResponse::Wakeup& wakeup) { wakeup_ = wakeup; }
+
+private:
+    enum FrameType : uint8_t {
+        kData = 0x0, kHeaders = 0x1, kPriority = 0x2, kRstStream = 0x3, kSettings = 0x4,
+        kPushPromise = 0x5, kPing = 0x6, kGoAway = 0x7, kWindowUpdate = 0x8, kContinuation = 0x9,
+    };
+    enum ErrorCode : uint32_t {
+        kNoError = 0x0, kProtocolError = 0x1, kInternalError = 0x2, kFlowControlError = 0x3,
+        kStreamClosed = 0x5, kFrameSizeError = 0x6, kRefusedStream = 0x7, kCancel = 0x8, kCompressionError = 0x9,
+    };
+
+    struct Stream {
+        std::string header_block;           // HEADERS + CONTINUATION 的头部块片段
+        std::vector<HpackHeader> headers;   // 解码后的请求头部
+        std::string body;
+        bool end_stream = false;            // 对端已发送 END_STREAM
+        bool responded = false;             // 已生成响应
+        int64_t send_window = 0;
+        SharedBuffer pending;               // 尚未发送的响应正文（受流量控制），与响应共享数据
+        size_t pending_offset = 0;
+        HttpResponse::BodyProducer producer; // 流式响应：pending 发完且窗口有余量时再取下一段
+        HttpResponse::FailureCheck failed;   // 生产者结束后返回 true 时重置流，而不是正常结束
+    };
+
+    // 返回 false 表示发生连接级错误，GOAWAY 已写入
+    bool handleFrame(uint8_t type, uint8_t flags, uint32_t stream_id,
+                     const uint8_t* payload, size_t len, Buffer* output);
+    bool handleHeaders(uint8_t flags, uint32_t stream_id, const uint8_t* payload, size_t len, Buffer* output);
+    bool handleContinuation(uint8_t flags, uint32_t stream_id, const uint8_t* payload, size_t len, Buffer* output);
+    bool handleData(uint8_t flags, uint32_t stream_id, const uint8_t* payload, size_t len, Buffer* output);
+    bool handleSettings(uint8_t flags, uint32_t stream_id, const uint8_t* payload, size_t len, Buffer* output);
+    bool handleWindowUpdate(uint32_t stream_id, const uint8_t* payload, size_t len, Buffer* output);
+
+    // 头部块接收完整后解码；请求完整时分发给业务
+    bool finishHeaderBlock(uint32_t stream_id, Buffer* output);
+    void dispatch(uint32_t stream_id, Stream& stream, Buffer* output);
+    // 在流量控制窗口允许的范围内发送各流的待发数据
+    void flushPending(Buffer* output);
+
+    bool connectionError(ErrorCode code, Buffer* output);
+    void resetStream(uint32_t stream_id, ErrorCode code, Buffer* output);
+    static void writeFrameHeader(Buffer* output, uint32_t length, uint8_t type, uint8_t flags, uint32_t stream_id);
+    static void writeWindowUpdate(Buffer* output, uint32_t stream_id, uint32_t increment);
+
+    RequestHandler handler_;
+    HttpResponse::Wakeup wakeup_;
+    HpackDecoder decoder_;
+    std::map<uint32_t, Stream> streams_;
+
+    bool preface_received_;
+    bool going_away_;             // 对端发来 GOAWAY，处理完现有流后关闭
+    uint32_t last_stream_id_;     // 已处理的最大客户端流 ID，用于 GOAWAY
+    uint32_t continuation_stream_; // 正在接收 CONTINUATION 的流，0 表示没有
+
+    // 对端的 SETTINGS
+    uint32_t peer_max_frame_size_;
+    int64_t peer_initial_window_;
+    int64_t conn_send_window_;
+};
@@ -6,39 +6,109 @@
 #include <string>
 #include <vector>
 #include <regex>
+#include <memory>
 
 // 所有HTTP请求处理函数的统一签名
 // 参数：解析好的请求对象，待填充的响应对象
 using HttpHandler = std::function<void(const HttpRequest&, HttpResponse*)>;
 
+// 流式路由的处理器工厂：请求头解析完成后为每个请求创建一个 BodyReader，
+// 请求体逐块交给它，结束后由 BodyReader::onComplete 生成响应
+using BodyReaderFactory = std::function<std::unique_ptr<BodyReader>(const HttpRequest&)>;
+
+// 路由的附加属性，在 server.ini 路由配置的第四个字段中声明
+struct RouteOptions {
+    // 可在 TLS 1.3 0-RTT early data 中处理（重放无副作用的只读请求）
+    bool replay_safe = false;
+    // 同一 GET 请求（方法 + 路径 + 查询串）的并发副本只执行一次处理函数，共享同一个响应
+    // 只适用于响应不依赖请求头（Cookie 等）的路由
+    bool coalesce = false;
+    // 响应缓存（见 ResponseCache）：有效期（秒），0 表示不缓存；过期后 cache_stale 秒内仍返回旧响应
+    double cache_ttl = 0;
+    double cache_stale = 0;
+    // 响应所依赖的 TFDB key 前缀，这些 key 被写入或删除时缓存失效
+    std::vector<std::string> cache_tags;
+    // 处理期限（秒），从收到请求算起；超过期限仍未开始处理的请求不再调用处理函数，0 表示不限
+    double deadline = 0;
+    // 低优先级：I/O 线程过载时最先被拒绝（见 OverloadController）
+    bool low_priority = false;
+};
+
+// 路由器：路径模式保存在压缩前缀树（radix tree）中，匹配耗时只与路径长度有关，与路由数量无关
+//
+// 路径模式语法：
+//   /api/problems            静态路径
+//   /api/problems/:id        命名参数，匹配一个非空路径段
+//   /api/problems/{id:int}   带类型的参数：int（数字）、slug（字母数字和 _-）、str（任意非空段）
+//   /static/*path            通配，匹配剩余的全部路径（可跨 /），捕获为参数
+//   *.css                    通配后可跟字面量后缀，匹配以该后缀结尾的路径；不带名字时不捕获
+// 同一位置的候选按 静态 > int > slug > str > 通配 的顺序尝试，失败时回溯
+// server.ini 中原有的正则写法（如 /users/(\d+)、.*\.css）在注册时尽量翻译为上述语法，
+// 无法翻译的仍按正则匹配，只在前缀树未命中时逐条尝试
 class HttpRouter{
 public:
 
-    // 路由规则结构体
-    struct Route {
-        HttpRequest::Method method;
-        std::regex path_regex;
+    // 路由目标：普通处理函数与 BodyReader 工厂二选一
+    struct RouteTarget {
         HttpHandler handler;
+        BodyReaderFactory reader_factory;
+        RouteOptions options;
+        std::string pattern; // 注册时的路径模式
+        std::vector<std::string> param_names; // 参数名，与 RouteParams 一一对应
     };
 
+    HttpRouter();
+    ~HttpRouter();
+
     // 添加一个路由规则
     // @param method: HTTP方法
-    // @param path_pattern: 包含正则表达式的URL模式
+    // @param path_pattern: 前缀树语法或正则表达式的URL模式
     // @param handler: 处理函数
-    // @return: 如果正则表达式编译成功，返回 true
-    bool addRoute(HttpRequest::Method method, const std::string& path_pattern, HttpHandler handler);
+    // @return: 如果模式合法，返回 true
+    bool addRoute(HttpRequest::Method method, const std::string& path_pattern, HttpHandler handler,
+                  const RouteOptions& options = RouteOptions());
+    // 添加流式请求体路由
+    bool addStreamRoute(HttpRequest::Method method, const std::string& path_pattern, BodyReaderFactory factory,
+                        const RouteOptions& options = RouteOptions());
+
+    // 路由匹配之后、调用处理函数之前的检查，返回 false 时不调用处理函数，由它填写响应
+    using RouteGuard = std::function<bool(HttpRequest& req, const RouteOptions& options, HttpResponse* resp)>;
+    void setGuard(RouteGuard guard) { guard_ = std::move(guard); }
+
+    // 请求头解析完成、读取请求体之前调用：匹配到流式路由时为请求安装 BodyReader
+    void prepareBody(HttpRequest& req) const;
 
     // 根据请求进行路由分发
     // @param req: 客户端请求
     // @param resp: 待填充的响应
     void route(HttpRequest& req, HttpResponse* resp) const;
 
+    // 查找请求匹配的路由属性，没有匹配的路由时返回 nullptr；pattern 非空时填入路由模式
+    const RouteOptions* findOptions(const HttpRequest& req, std::string_view* pattern = nullptr) const;
+
+    // 把 server.ini 中的正则路由翻译为前缀树语法，无法翻译时返回 false
+    static bool translateRegex(const std::string& regex, std::string* pattern);
+
 private:
+    struct Node;
+
+    // 无法翻译为前缀树语法的正则路由
+    struct RegexRoute {
+        HttpRequest::Method method;
+        std::regex path_regex;
+        RouteTarget target;
+    };
+
+    bool addTarget(HttpRequest::Method method, const std::string& path_pattern, RouteTarget target);
+    // 按前缀树语法插入，语法错误时返回 false
+    bool insert(HttpRequest::Method method, const std::string& pattern, RouteTarget target);
+    // 查找匹配的路由，params 非空时填入捕获的参数
+    const RouteTarget* findRoute(const HttpRequest& req, RouteParams* params) const;
+
     // 404 Not Found 的默认处理函数
     void handleNotFound(const HttpRequest& req, HttpResponse* resp) const;
-    
-    // 精确匹配：map<path, map<method, handler>>
-    std::map<std::string, std::map<HttpRequest::Method, HttpHandler>> static_routes_;
-    // 正则匹配：vector<Route>
-    std::vector<Route> regex_routes_;
-};
\ No newline at end of file
+
+    std::unique_ptr<Node> root_;
+    std::vector<RegexRoute> regex_routes_;
+    RouteGuard guard_;
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <sys/types.h>
+#include <ctime>
+
+// 只读映射的整个文件，正文直接从映射交给 SSL_write / writev，不经过 read 和中间缓冲
+// 同一文件（inode、大小、修改时间都相同）的并发请求共享一个映射，最后一个使用者释放时解除映射；
+// 文件被替换后新请求得到新的映射，旧映射在进行中的请求结束后释放
+// 文件在发送期间被原地截断时，访问映射中超出新文件末尾的页会收到 SIGBUS：进程内的 SIGBUS 处理函数
+// 在出错页上覆盖一个全零的匿名页并标记该映射已截断（truncated），由正文的发送方中止这个响应，
+// 而不是让整个进程退出；部署静态资源仍应写新文件再 rename 替换，使进行中的请求继续发送旧内容
+class MappedFile {
+public:
+    // 打开或映射失败时返回 nullptr
+    static std::shared_ptr<const MappedFile> open(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    // 访问映射时发现文件已被截断，读到的内容（截断处之后为全零）不再可信
+    bool truncated() const;
+
+    // 提示内核预读即将发送的区间（MADV_WILLNEED）
+    void willNeed(off_t offset, size_t length) const;
+    // 区间是否已全部在页缓存中（mincore），访问时不会因读盘而阻塞
+    bool resident(off_t offset, size_t length) const;
+    // 逐页访问区间，把数据读入页缓存；可能阻塞，只在磁盘线程中调用
+    void prefault(off_t offset, size_t length) const;
+
+private:
+    MappedFile(const char* data, size_t size, int slot, ino_t ino, const struct timespec& mtime)
+        : data_(data), size_(size), slot_(slot), ino_(ino), mtime_(mtime) {}
+
+    bool sameFile(ino_t ino, size_t size, const struct timespec& mtime) const;
+    static size_t pageSize();
+
+    const char* data_;   // 空文件为 nullptr
+    size_t size_;
+    int slot_;           // 在 SIGBUS 保护表中的位置，空文件为 -1
+    ino_t ino_;
+    struct timespec mtime_;
+};
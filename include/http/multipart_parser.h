@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <functional>
+
+// multipart/form-data 的流式解析器（RFC 7578）
+// 请求体可以任意切分后逐块喂入，内部只保留不足以判断分隔符的尾部数据，
+// 因此内存占用与上传大小无关
+class MultipartParser {
+public:
+    struct Part {
+        std::string name;         // Content-Disposition 中的 name
+        std::string filename;     // 文件字段的 filename，普通字段为空
+        std::string content_type;
+    };
+
+    // 回调返回 false 会中止解析
+    using PartBeginCallback = std::function<bool(const Part&)>;
+    using PartDataCallback = std::function<bool(const char* data, size_t len)>;
+    using PartEndCallback = std::function<bool()>;
+
+    explicit MultipartParser(const std::string& boundary);
+
+    // 从 Content-Type 中取出 boundary 参数，不是 multipart/form-data 时返回空串
+    static std::string boundaryFromContentType(std::string_view content_type);
+
+    void setPartBeginCallback(const PartBeginCallback& cb) { part_begin_callback_ = cb; }
+    void setPartDataCallback(const PartDataCallback& cb) { part_data_callback_ = cb; }
+    void setPartEndCallback(const PartEndCallback& cb) { part_end_callback_ = cb; }
+
+    // @return: 格式错误或回调中止时返回 false，此后不应继续调用
+    bool feed(const char* data, size_t len);
+    // 是否已遇到结束分隔符
+    bool finished() const { return state_ == kDone; }
+
+private:
+    enum State { kPreamble, kAfterBoundary, kPartHeaders, kPartData, kDone, kError };
+
+    bool process();
+    bool parsePartHeaders(std::string_view block, Part* part) const;
+
+    // "\r\n--boundary"：首个分隔符前没有 CRLF，构造时在 pending_ 中预置一个
+    std::string delimiter_;
+    std::string pending_;
+    State state_;
+
+    PartBeginCallback part_begin_callback_;
+    PartDataCallback part_data_callback_;
+    PartEndCallback part_end_callback_;
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include "http_request.h"
+#include "http_response.h"
+#include "http/http_router.h"
+#include <atomic>
+#include <cstdint>
+
+// 过载保护：在路由匹配之后、处理函数之前决定是否接受请求（由 HttpRouter 的 RouteGuard 调用）
+// - 已超过路由处理期限（RouteOptions::deadline）的请求，客户端多半已经放弃，不再处理
+// - 处理该请求的 I/O 线程的事件延迟（EventLoop::eventLag）超过阈值时，拒绝低优先级路由的请求
+// 被拒绝的请求立即得到 503 和 Retry-After，把线程留给其余请求，使被接受请求的延迟保持有界
+class OverloadController {
+public:
+    struct Options {
+        bool enabled = true;
+        double max_lag = 0.1;  // 事件延迟（秒）超过该值时拒绝低优先级路由
+        int retry_after = 1;   // 503 响应中 Retry-After 的秒数
+    };
+
+    static OverloadController& instance();
+
+    void setOptions(const Options& options) { options_ = options; }
+    const Options& options() const { return options_; }
+
+    // @param lag: 处理该请求的 EventLoop 的 eventLag()
+    // @return: false 表示拒绝，resp 已填写为 503
+    bool admit(const HttpRequest& req, const RouteOptions& route, double lag, HttpResponse* resp);
+
+    // 填写 503 响应，处理函数发现超过期限时也可以用它提前结束
+    void reject(HttpResponse* resp) const;
+
+    // 启动以来因超过期限、因过载而拒绝的请求数
+    uint64_t expiredCount() const { return expired_.load(std::memory_order_relaxed); }
+    uint64_t shedCount() const { return shed_.load(std::memory_order_relaxed); }
+
+private:
+    OverloadController() = default;
+
+    Options options_;
+    std::atomic<uint64_t> expired_{0};
+    std::atomic<uint64_t> shed_{0};
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include "http/compression.h"
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <ctime>
+
+// 静态资源的预压缩变体（gzip / brotli）
+// 每个文件只在启动预热或第一次被请求时压缩一次，之后按 Accept-Encoding 直接取用，请求路径上没有压缩开销
+// 磁盘上已有不旧于源文件的 .gz / .br 同名文件时直接使用，不再自己压缩
+class PrecompressedCache {
+public:
+    struct Variants {
+        time_t mtime = 0;        // 源文件的修改时间和大小，任一变化即重新压缩
+        size_t size = 0;
+        std::string gzip;        // 为空表示压缩后没有变小，不提供该编码
+        std::string brotli;
+
+        const std::string* get(Compression::Encoding encoding) const;
+    };
+
+    // 小于该大小的文件压缩收益太小，不处理
+    static const size_t kMinCompressSize = 256;
+
+    static PrecompressedCache& instance();
+
+    // 取出文件的压缩变体，不存在或已过期时用 content（源文件内容）重新生成
+    // content 为 nullptr 时只查缓存，未命中返回 nullptr
+    std::shared_ptr<const Variants> get(const std::string& path, time_t mtime, size_t size, const std::string* content);
+
+    // 在 DiskIoPool 中读出文件并生成变体，同一文件同时只有一个任务；完成前的请求发送原文
+    void buildAsync(const std::string& path, time_t mtime, size_t size);
+
+    // 启动时预先压缩目录下所有可压缩的文件
+    void warmUp(const std::string& root);
+
+private:
+    PrecompressedCache() = default;
+
+    std::shared_ptr<const Variants> build(const std::string& path, time_t mtime, size_t size, const std::string& content) const;
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const Variants>> entries_;
+    std::unordered_set<std::string> building_;  // 正在后台生成变体的文件
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include "http_request.h"
+#include "http_response.h"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 合并并发的相同请求（single-flight）：同一个 key 同时只执行一次处理函数，执行期间到达的
+// 相同请求（可能来自其他 I/O 线程）不再执行，等它完成后得到同一个不可变的响应
+// 只合并进行中的执行，完成后不缓存结果，下一个请求重新执行
+class RequestCoalescer {
+public:
+    // 为空表示结果不能共享（流式正文或协议升级），等待者应自己执行处理函数
+    using Result = std::shared_ptr<const HttpResponse>;
+    // 在执行处理函数的线程中调用，等待者应自行回到所属的 I/O 线程
+    using Waiter = std::function<void(const Result& result)>;
+    using Handler = std::function<void(HttpResponse* resp)>;
+
+    static RequestCoalescer& instance();
+
+    // 请求的合并 key（方法 + 路径 + 查询串），不合并的请求（非 GET）返回空
+    static std::string key(const HttpRequest& req);
+
+    // 加入 key 上进行中的执行，完成后调用 waiter
+    // @return: false 表示当前没有进行中的执行，调用方成为第一个请求，应调用 lead，waiter 不会被调用
+    bool join(const std::string& key, const Waiter& waiter);
+    // 第一个请求执行 handler 生成 resp，再把结果交给 join 的等待者
+    // handler 抛出异常时等待者得到空结果，异常继续向上传播
+    void lead(const std::string& key, const Handler& handler, HttpResponse* resp);
+
+    // 供不能挂起请求的调用方（HTTP/2 会话）：没有进行中的执行时作为第一个请求执行，结果交给其他等待者；
+    // 已有进行中的执行时不等待（阻塞会卡住整个 I/O 线程），直接自己执行处理函数
+    void run(const std::string& key, const Handler& handler, HttpResponse* resp);
+
+private:
+    RequestCoalescer() = default;
+
+    // 结束 key 上的执行并通知等待者；resp 为 nullptr 表示没有结果
+    void finish(const std::string& key, const HttpResponse* resp);
+
+    std::mutex mutex_;
+    // 进行中的执行 -> 等待者；key 存在即表示有第一个请求在执行
+    std::unordered_map<std::string, std::vector<Waiter>> flights_;
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include "http_request.h"
+#include "http_response.h"
+#include "http/http_router.h"
+#include "http/compression.h"
+#include "utils/timestamp.h"
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+// 只读接口（题目列表、标签、收藏夹等）的响应缓存，在路由之前查找，命中时不执行处理函数
+// 条目按路由配置的 cache_ttl 过期，过期后 cache_stale 秒内仍返回旧响应，由第一个看到它过期的请求
+// 重新执行处理函数；路由在 cache_tags 中声明所依赖的 TFDB key 前缀，这些 key 被写入或删除时相关条目立即失效
+// 处理函数的输出只保存一份，各压缩编码的版本在第一次需要时生成并保存，之后的命中不再压缩
+class ResponseCache {
+public:
+    struct Options {
+        bool enabled = true;
+        size_t max_entries = 1024;           // 超出时先清理过期条目，仍超出时淘汰任意一条
+        size_t max_body_size = 1024 * 1024;  // 正文超过该值的响应不缓存
+    };
+
+    // 未命中时由 lookup 填入，调用方执行处理函数后交给 store
+    struct Ticket {
+        std::vector<uint64_t> generations; // 执行前各依赖标签的版本，执行期间的写入会使结果立即失效
+    };
+
+    static ResponseCache& instance();
+
+    // 在启动时设置
+    void setOptions(const Options& options) { options_ = options; }
+    const Options& options() const { return options_; }
+
+    // 启动时为路由声明的标签建立版本计数
+    void addTags(const std::vector<std::string>& tags);
+    // TFDB 中 key 被写入或删除：以其为前缀的标签版本加一，依赖这些标签的条目随之失效
+    void invalidate(const std::string& db_key);
+
+    // 命中时把缓存的响应（已按 Accept-Encoding 压缩）填入 resp
+    // @param key: 请求的缓存 key（方法 + 路径 + 查询串）
+    // @param load: 处理该请求的 EventLoop 的 busyRatio()，生成压缩版本时使用
+    // @return: false 表示未命中或由本请求重新生成过期条目，应执行处理函数后调用 store
+    bool lookup(const std::string& key, const RouteOptions& route, const HttpRequest& req, HttpResponse* resp,
+                double load, Ticket* ticket);
+    // 保存处理函数的输出（压缩之前），只缓存 200 的普通响应
+    void store(const std::string& key, const RouteOptions& route, const Ticket& ticket, const HttpResponse& resp);
+
+private:
+    ResponseCache() = default;
+
+    struct Entry {
+        std::shared_ptr<const HttpResponse> response;
+        // 按 Compression::Encoding 索引的压缩版本，kIdentity 不使用
+        std::array<std::shared_ptr<const HttpResponse>, 3> encoded;
+        Timestamp expires;
+        Timestamp stale_until;
+        std::vector<uint64_t> generations; // 与路由的 cache_tags 一一对应
+        bool refreshing = false;           // 已有请求在重新生成过期的条目
+    };
+
+    // 调用方持有 mutex_
+    bool tagsUnchanged(const RouteOptions& route, const std::vector<uint64_t>& generations) const;
+    void evict(Timestamp now);
+
+    Options options_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, uint64_t> tags_; // 标签（TFDB key 前缀）-> 版本
+    std::unordered_map<std::string, Entry> entries_;
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include "http/precompressed_cache.h"
+#include <string>
+#include <string_view>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+#include <ctime>
+#include <cstdint>
+
+class EventLoop;
+class Channel;
+
+// 静态文件的进程内缓存：请求路径 -> 解析后的文件、内容、MIME 类型和验证器
+// 命中时不再做路径规范化、stat 和读文件，热点资源的响应路径上只剩写 socket 的系统调用
+// 条目的有效性由 StaticFileWatcher（inotify）保证，而不是每次请求都 stat
+class StaticFileCache {
+public:
+    struct Entry {
+        std::string file_path;      // 规范化后的文件路径
+        std::string mime_type;
+        size_t size = 0;
+        time_t mtime = 0;
+        bool compressible = false;  // 是否按 Accept-Encoding 选择预压缩变体
+        // 预先生成的头部值，与表示一一对应
+        std::string etag;
+        std::string gzip_etag;
+        std::string br_etag;
+        std::string last_modified;
+        std::string cache_control;  // 为空表示没有匹配的规则
+        // 内容与压缩变体的只读视图，指向 holder 持有的数据或编译进程序的资源
+        // 超过单文件上限的文件只缓存元数据（has_content 为 false），正文仍从磁盘分段读出
+        bool has_content = false;
+        std::string_view content;
+        std::string_view gzip;      // 为空表示不提供该编码
+        std::string_view brotli;
+        std::shared_ptr<const void> holder;
+
+        const std::string& etagFor(Compression::Encoding encoding) const;
+        std::string_view variant(Compression::Encoding encoding) const;
+        size_t charge() const;  // 计入内存预算的字节数
+    };
+
+    struct Options {
+        size_t budget = 64 * 1024 * 1024;    // 内容与压缩变体占用的内存上限，0 表示关闭缓存
+        size_t max_file_size = 256 * 1024;   // 超过该大小的文件不缓存内容
+    };
+
+    static StaticFileCache& instance();
+
+    void setOptions(const Options& options);
+    const Options& options() const { return options_; }
+    bool enabled() const { return options_.budget > 0; }
+
+    std::shared_ptr<const Entry> lookup(const std::string& path);
+
+    // 填充前取得的代数；期间发生过失效时不插入，避免把刚被修改的文件的旧内容放进缓存
+    uint64_t generation() const;
+    void insert(const std::string& path, std::shared_ptr<const Entry> entry, uint64_t generation);
+
+    // 使对应文件（及以其为源文件的 .gz / .br）的条目失效
+    void invalidateFile(const std::string& file_path);
+    void clear();
+
+private:
+    StaticFileCache() = default;
+
+    using LruList = std::list<std::string>;
+    struct Slot {
+        std::shared_ptr<const Entry> entry;
+        LruList::iterator lru_it;
+    };
+
+    void eraseLocked(std::unordered_map<std::string, Slot>::iterator it);
+
+    Options options_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Slot> entries_;
+    LruList lru_;             // 表头为最近使用
+    size_t charged_ = 0;
+    uint64_t generation_ = 0;
+};
+
+// 用 inotify 监视 web 根目录树，文件变化时使 StaticFileCache 的条目失效
+// 与 Server 一样属于创建它的 EventLoop，须在该线程中析构
+class StaticFileWatcher {
+public:
+    StaticFileWatcher(EventLoop* loop, const std::string& root);
+    ~StaticFileWatcher();
+
+    StaticFileWatcher(const StaticFileWatcher&) = delete;
+    StaticFileWatcher& operator=(const StaticFileWatcher&) = delete;
+
+    bool valid() const { return inotify_fd_ >= 0; }
+
+private:
+    void addWatches(const std::string& dir);
+    void handleRead();
+
+    EventLoop* loop_;
+    int inotify_fd_;
+    std::unique_ptr<Channel> channel_;
+    std::unordered_map<int, std::string> watch_dirs_;  // watch descriptor -> 目录路径
+};
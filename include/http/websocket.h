@@ -0,0 +1,110 @@
+#pragma once
+#include "buffer.h"
+#include "http_request.h"
+#include "http_response.h"
+#include "shared_buffer.h"
+#include "utils/timestamp.h"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+class Connection;
+class EventLoop;
+
+// WebSocket 连接状态（RFC 6455）：帧的解析与编码、分片重组、控制帧应答和心跳
+// 升级后由 Connection 的 context 持有；与 Http2Session 一样只处理字节流，写出和关闭连接由调用方完成
+class WebSocketSession {
+public:
+    enum Opcode : uint8_t {
+        kContinuation = 0x0, kText = 0x1, kBinary = 0x2, kClose = 0x8, kPing = 0x9, kPong = 0xA,
+    };
+    enum CloseCode : uint16_t {
+        kNormalClosure = 1000, kGoingAway = 1001, kProtocolError = 1002, kUnsupportedData = 1003,
+        kInvalidPayload = 1007, kPolicyViolation = 1008, kMessageTooBig = 1009,
+    };
+
+    // 收到一条完整的数据消息（分片已重组、掩码已去除），需要回复的帧追加到 output
+    using MessageHandler = std::function<void(Opcode opcode, std::string_view payload, Buffer* output)>;
+
+    // 在 HTTP handler 中调用：校验升级请求并生成 101 响应，响应写出后连接由新的会话接管，
+    // topic 不为空时加入 WebSocketHub 的该主题；请求不合法时生成 400（版本不支持时 426）
+    // @return: 是否接受了升级
+    static bool accept(const HttpRequest& req, HttpResponse* resp, const std::string& topic,
+                       MessageHandler handler = nullptr);
+
+    // 服务端发出的帧不加掩码
+    static void appendFrame(Opcode opcode, std::string_view payload, Buffer* output);
+    static void appendClose(CloseCode code, Buffer* output);
+
+    // 已升级连接上的会话，其他连接返回 nullptr
+    static WebSocketSession* get(const std::shared_ptr<Connection>& conn);
+
+    WebSocketSession(MessageHandler handler, size_t max_message_size);
+
+    // 处理输入缓冲区中所有完整的帧，需要发送的帧追加到 output
+    // @return: false 表示连接应关闭（Close 帧已写入 output）
+    bool onData(Buffer* input, Buffer* output);
+
+    // 由心跳定时器每 interval 秒调用一次：期间没有收到任何数据时发送 Ping
+    // @return: false 表示上一个 Ping 发出后整个周期都没有回应，对端已失联
+    bool heartbeat(double interval, Buffer* output);
+
+private:
+    // 已去掩码的帧：数据帧的载荷已追加到 message_，控制帧的载荷在 control_payload_
+    // 返回 false 表示协议错误或对端关闭，Close 帧已写入
+    bool handleFrame(Opcode opcode, bool fin, Buffer* output);
+    bool handleClose(std::string_view payload, Buffer* output);
+    bool fail(CloseCode code, Buffer* output);
+
+    MessageHandler handler_;
+    size_t max_message_size_;
+
+    std::string message_;           // 正在重组的分片消息
+    Opcode message_opcode_;         // 分片消息的类型，kContinuation 表示当前没有未完成的消息
+    std::string control_payload_;   // 控制帧的载荷，去掩码时使用
+    bool closing_;                  // 已发出 Close 帧，之后收到的数据全部丢弃
+
+    Timestamp last_received_;
+    bool ping_outstanding_;
+};
+
+// 按主题向 WebSocket 连接广播消息，可在任意线程调用 publish
+// 订阅表按 I/O 线程分开，只在所属线程中访问，投递时不加锁；一条消息只序列化为一个共享的帧，
+// 每个 I/O 线程投递一个任务，其中的各连接写出和积压的都是同一份帧的引用
+class WebSocketHub {
+public:
+    struct Options {
+        double ping_interval = 30;               // 心跳间隔（秒），0 表示不发送心跳
+        size_t max_message_size = 64 * 1024;     // 客户端单条消息（重组后）的上限
+        size_t max_pending_output = 1024 * 1024; // 输出积压超过该值的订阅者跟不上推送，直接断开
+    };
+
+    static WebSocketHub& instance();
+
+    // 在启动时设置
+    void setOptions(const Options& options) { options_ = options; }
+    const Options& options() const { return options_; }
+
+    // 在连接所属的 I/O 线程中调用；连接关闭后在下一次投递时移除
+    void subscribe(const std::shared_ptr<Connection>& conn, const std::string& topic);
+    void publish(const std::string& topic, std::string_view payload,
+                 WebSocketSession::Opcode opcode = WebSocketSession::kText);
+
+private:
+    WebSocketHub() = default;
+
+    // 一个 I/O 线程上的订阅者：主题 -> 连接
+    using Subscribers = std::unordered_map<std::string, std::vector<std::weak_ptr<Connection>>>;
+
+    static void deliver(Subscribers* subscribers, const std::string& topic,
+                        const SharedBuffer& frame, size_t max_pending_output);
+
+    std::mutex mutex_;
+    std::unordered_map<EventLoop*, std::shared_ptr<Subscribers>> loops_;
+    Options options_;
+};
@@ -1,11 +1,59 @@
 #pragma once
 #include "buffer.h"
+#include "utils/request_arena.h"
+#include "utils/timestamp.h"
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
+#include <deque>
+#include <array>
 #include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <cstdint>
+
+class HttpRequest;
+class HttpResponse;
 
 // 用于存储从URL中捕获的参数，例如 /users/123 中的 "123"
-using RouteParams = std::vector<std::string>;
+// 从请求的内存池分配（见 HttpRequest::arena）
+using RouteParams = std::pmr::vector<std::pmr::string>;
+
+// 流式请求体的接收方，请求头解析完成后由路由创建，请求体到达时逐块交给它，不在内存中整体缓存
+class BodyReader {
+public:
+    virtual ~BodyReader() = default;
+    // 收到一段已解码（已去掉 chunked 编码）的请求体，返回 false 表示中止接收
+    virtual bool onBody(const char* data, size_t len) = 0;
+    // 请求体接收完毕，或 onBody 中止接收后调用，生成响应
+    virtual void onComplete(const HttpRequest& req, HttpResponse* resp) = 0;
+};
+
+// application/x-www-form-urlencoded 格式的参数（查询串或表单请求体），第一次查询时才建立索引
+// 名字和值是指向原始字节的切片，只有含 % 或 + 转义的才解码，解码结果放在请求的内存池中；
+// 同名参数以最后一个为准。原始字节和内存池都属于 HttpRequest，reset() 之后切片失效
+class UrlParams {
+public:
+    explicit UrlParams(std::pmr::memory_resource* arena) : indexed_(false), entries_(arena) {}
+
+    // 换成新的原始字节，丢弃已建立的索引
+    void assign(std::string_view raw);
+
+    // 参数不存在时返回 false
+    bool get(std::string_view name, std::string_view* value) const;
+    // 参数不存在时返回空
+    std::string_view get(std::string_view name) const;
+    bool has(std::string_view name) const;
+    size_t size() const;
+
+private:
+    void buildIndex() const;
+
+    std::string_view raw_;
+    mutable bool indexed_;
+    mutable std::pmr::vector<std::pair<std::string_view, std::string_view>> entries_;
+};
 
 class HttpRequest{
 public:
@@ -17,50 +65,187 @@ public:
         kGotALL,
     };
 
+    // 常用头部在解析时直接放入固定槽位，查询无需字符串比较
+    enum HeaderId {
+        kHost,
+        kConnection,
+        kContentLength,
+        kContentType,
+        kTransferEncoding,
+        kAcceptEncoding,
+        kIfNoneMatch,
+        kIfModifiedSince,
+        kRange,
+        kIfRange,
+        kCookie,
+        kUserAgent,
+        kAccept,
+        kExpect,
+        kUpgrade,
+        kHeaderIdCount,
+    };
+
+    // parse() 返回 false 的原因，调用方据此选择 400/414/431/413 响应
+    enum ParseError {
+        kMalformed,          // 语法错误
+        kRequestLineTooLong, // 请求行超过 Limits::max_request_line
+        kHeadersTooLarge,    // 请求头总长或头部个数超出上限
+        kBodyTooLarge,       // 缓存在内存中的请求体超过 Limits::max_body_size
+    };
+
+    // 解析时的大小上限，缓慢发送或超大的请求不能让连接的缓冲区无限增长
+    // 所有连接共用，启动时按 server.ini 设置一次
+    struct Limits {
+        size_t max_request_line = 8 * 1024;
+        size_t max_header_size = 32 * 1024;      // 请求行和全部头部（含结尾空行）的字节数
+        size_t max_headers = 100;
+        size_t max_body_size = 8 * 1024 * 1024;  // 交给 BodyReader 的流式请求体不受此限制
+    };
+    static void setLimits(const Limits& limits);
+    static const Limits& limits();
+
+    // 头部名和值都是指向 raw_head_（或 HTTP/2 的 owned_fields_）的切片
+    struct Header {
+        std::string_view name;
+        std::string_view value;
+    };
+
     HttpRequest();
+    // 头部切片指向对象自身的存储，拷贝后会悬空
+    HttpRequest(const HttpRequest&) = delete;
+    HttpRequest& operator=(const HttpRequest&) = delete;
 
-    // 简化版解析函数，直接收取字符串
+    // 解析缓冲区中的数据。请求头解析完成时先返回一次（状态为 kExpectBody），
+    // 调用方可在读取请求体之前决定是否安装 BodyReader，再次调用继续解析请求体
     bool parse(Buffer* buffer);
     bool gotAll() const { return state_ == kGotALL; };
+    bool headersComplete() const { return state_ == kExpectBody || state_ == kGotALL; }
+    // parse() 返回 false 时的错误原因
+    ParseError parseError() const { return parse_error_; }
+    // 收到本请求第一个字节的时间，请求头的读取期限和处理期限都从这里计时
+    // 调用方可在 parse() 之前设为数据就绪的时间（如 EventLoop::pollReturnTime），否则取 parse() 第一次看到数据的时间
+    Timestamp receiveTime() const { return receive_time_; }
+    void setReceiveTime(Timestamp time) { receive_time_ = time; }
+    // 请求头解析完成、开始接收请求体的时间，没有请求体时无效
+    Timestamp bodyStartTime() const { return body_start_time_; }
+    // 处理期限：路由声明了 deadline 时为 receiveTime() 加上该时长，由路由器在调用处理函数前设置，没有期限时无效
+    // 耗时的处理函数可以在循环中检查 deadlineExceeded()，客户端多半已经放弃时提前结束
+    Timestamp deadline() const { return deadline_; }
+    void setDeadline(Timestamp deadline) { deadline_ = deadline; }
+    bool deadlineExceeded() const {
+        return deadline_.microSecondSinceEpoch() != 0 && deadline_ < Timestamp::now();
+    }
 
     Method getMethod() const {return method_; }
     const std::string& getPath() const {return path_; }
-    const std::string& getQuery() const { return query_; } // 获取查询字符串
-    const std::string& getVersion() const { return version_; }
+    // 原始（未解码）的查询串，不含 '?'
+    std::string_view getQuery() const { return query_; }
+    // 查询串中的参数
+    const UrlParams& queryParams() const { return query_params_; }
+    std::string_view getVersion() const { return version_; }
+    // 头部名大小写不敏感
     std::string getHeader(const std::string& key) const;
-    const std::unordered_map<std::string, std::string>& getHeaders() const { return headers_; }
+    std::string_view header(HeaderId id) const { return known_headers_[id]; }
+    const std::vector<Header>& getHeaders() const { return headers_; }
     const std::string& getBody() const { return body_; }
+    // 没有 Content-Length 时为 0
+    size_t contentLength() const { return content_length_; }
+    bool isChunked() const { return chunked_; }
+
+    // 安装流式请求体接收方，之后的请求体不再写入 body_；传入 nullptr 表示按普通方式缓存
+    void setBodyReader(std::unique_ptr<BodyReader> reader);
+    BodyReader* getBodyReader() const { return body_reader_.get(); }
+    // 是否已经为本请求调用过 setBodyReader
+    bool bodyReaderDecided() const { return body_reader_decided_; }
 
-    // 解析POST表单数据 (x-www-form-urlencoded)
-    std::string getPostValue(const std::string& key) const;
+    // x-www-form-urlencoded 请求体中的参数，其他请求体时为空
+    const UrlParams& formParams() const { return form_params_; }
+    // 表单参数的拷贝，不存在时返回空串
+    std::string getPostValue(std::string_view key) const { return std::string(form_params_.get(key)); }
 
     void reset();
     bool keepAlive() const;
 
+    // 本请求的内存池，reset() 时整体回收：处理函数的临时对象可以用 std::pmr 容器从这里分配，
+    // 例如 std::pmr::string key("problem:", req.arena())；响应对象以它构造时头部也从这里分配
+    // 注意：流式正文的生产者、缓存和其他线程在 reset() 之后仍会使用的数据不能放在这里
+    std::pmr::memory_resource* arena() const { return &arena_; }
+
     const RouteParams& getRouteParams() const { return route_params_; }
-    void setRouteParams(const RouteParams& params) { route_params_ = params; }
-    // URL 解码辅助函数
-    static std::string urlDecode(const std::string& str);
+    void setRouteParams(RouteParams params) { route_params_ = std::move(params); }
+    // 按名字取路由参数（如 /api/problems/{id:int} 中的 id），不存在时返回空串
+    std::string getRouteParam(std::string_view name) const;
+    // 参数名列表由路由表持有，与 route_params_ 一一对应
+    void setRouteParamNames(const std::vector<std::string>* names) { route_param_names_ = names; }
+    // 匹配到的路由模式（server.ini 中的路径），用于按路由统计；指向路由表，未匹配时为空
+    std::string_view getRoutePattern() const { return route_pattern_; }
+    void setRoutePattern(std::string_view pattern) { route_pattern_ = pattern; }
+
+    // 供 HTTP/2 从伪头部和 HPACK 解码结果直接构造请求，不经过文本解析
+    bool setRequestLine(const std::string& method, const std::string& target, const std::string& version);
+    bool addHeader(const std::string& key, const std::string& value);
+    // 设置完整的请求体，请求进入 kGotALL 状态
+    void setBody(const std::string& body);
+
+    // URL 解码辅助函数：% 后不是两位十六进制数时原样保留
+    static std::string urlDecode(std::string_view str);
+    // 常用头部名到槽位的映射，不是常用头部时返回 kHeaderIdCount
+    static HeaderId lookupHeaderId(std::string_view name);
 
 private:
 
     bool parseRequestLine(const char* begin, const char* end);
     bool parseHeader(const char* begin, const char* end);
-    void parseBody(Buffer* buffer);
+    // 记录错误原因并返回 false
+    bool fail(ParseError error) { parse_error_ = error; return false; }
+    // 记录一个头部并填充常用头部槽位
+    bool storeHeader(std::string_view name, std::string_view value);
+    // 请求头解析完成后确定请求体的长度或编码方式
+    bool prepareBody();
+    bool parseBody(Buffer* buffer);
+    bool parseChunkedBody(Buffer* buffer);
+    // 将解码后的请求体交给 BodyReader 或追加到 body_
+    bool deliverBody(const char* data, size_t len);
+    void finishBody();
 
-    // 解析表单数据
-    void parsePost();
+    // 下面从内存池分配的成员依赖它，必须最先构造、最后析构
+    mutable RequestArena arena_;
 
     ParseState state_;
+    ParseError parse_error_;
+    Timestamp receive_time_;
+    Timestamp body_start_time_;
+    Timestamp deadline_;
     Method method_;
     std::string path_;
-    std::string version_;
-    std::string query_;
-    std::unordered_map<std::string, std::string> headers_;
+    std::string_view version_;
+    std::string_view query_; // 指向 raw_head_
+
+    // 请求行和头部的原始字节，一次拷贝出 Buffer 后所有切片都指向这里
+    // reset() 只清空内容，keep-alive 连接上的后续请求复用已分配的容量
+    std::string raw_head_;
+    // 在 Buffer 中查找头部结束位置时已扫描过的字节数，数据不完整时避免从头重扫
+    size_t head_scanned_;
+    std::vector<Header> headers_;
+    std::array<std::string_view, kHeaderIdCount> known_headers_;
+    // HTTP/2 逐个添加的头部没有连续的原始字节，单独保存（deque 扩容不会移动已有元素）
+    std::deque<std::string> owned_fields_;
+    size_t content_length_;
+
+    // 请求体解码状态
+    enum ChunkState { kChunkSize, kChunkData, kChunkDataEnd, kChunkTrailer };
+    bool chunked_;
+    ChunkState chunk_state_;
+    size_t body_remaining_; // Content-Length 剩余字节数，或当前 chunk 的剩余字节数
+    std::unique_ptr<BodyReader> body_reader_;
+    bool body_reader_decided_;
+
     std::string body_;
 
-    // 用于存储POST解析后的键值对
-    std::unordered_map<std::string, std::string> post_params_;
+    UrlParams query_params_;
+    UrlParams form_params_;
 
     RouteParams route_params_;
-};
\ No newline at end of file
+    const std::vector<std::string>* route_param_names_;
+    std::string_view route_pattern_;
+};
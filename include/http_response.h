@@ -1,47 +1,192 @@
 #pragma once
 #include "buffer.h"
+#include "shared_buffer.h"
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+
+class Connection;
 
 
 class HttpResponse{
 public:
     enum HttpStatusCode{
         kUnknow,
+        k101SwitchingProtocols = 101,
         k200Ok = 200,
+        k206PartialContent = 206,
         k400BadRequest = 400,
         k403Forbidden = 403,
         k404NotFound = 404,
+        k408RequestTimeout = 408,
+        k413PayloadTooLarge = 413,
+        k414UriTooLong = 414,
+        k416RangeNotSatisfiable = 416,
+        k426UpgradeRequired = 426,
+        k431RequestHeaderFieldsTooLarge = 431,
         k500InternalServerError = 500,
+        k503ServiceUnavailable = 503,
         k302Found = 302,
+        k304NotModified = 304,
+    };
+
+    // 常用响应头部名预先驻留：设置时不保存名字字符串，序列化时直接写出静态字节
+    enum HeaderId {
+        kContentType,
+        kContentLength,
+        kConnection,
+        kKeepAlive,
+        kServer,
+        kDate,
+        kLocation,
+        kContentDisposition,
+        kContentEncoding,
+        kVary,
+        kCacheControl,
+        kETag,
+        kLastModified,
+        kAcceptRanges,
+        kContentRange,
+        kRetryAfter,
+        kOtherHeader, // 不在上表中的头部，名字保存在 Header::name
+    };
+
+    // 名字和值从所在响应的内存池分配，复制到其他响应（缓存、合并请求）时改用目标响应的分配器
+    struct Header {
+        using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+        HeaderId id;
+        std::pmr::string name; // 只有 kOtherHeader 使用
+        std::pmr::string value;
+
+        Header(HeaderId id, std::string_view name, std::string_view value, const allocator_type& alloc = {})
+            : id(id), name(name, alloc), value(value, alloc) {}
+        Header(const Header& other, const allocator_type& alloc)
+            : id(other.id), name(other.name, alloc), value(other.value, alloc) {}
+        Header(Header&& other, const allocator_type& alloc)
+            : id(other.id), name(std::move(other.name), alloc), value(std::move(other.value), alloc) {}
+        Header(const Header&) = default;
+        Header(Header&&) = default;
+        Header& operator=(const Header&) = default;
+        Header& operator=(Header&&) = default;
     };
 
-    explicit HttpResponse();
+    // 流式正文的生产者：每次向 buf 追加下一段正文，返回 false 表示正文已全部产生
+    // 返回 true 时至少要追加一个字节，否则会被当作没有进展；异步正文（见 setWakeupReceiver）除外
+    using BodyProducer = std::function<bool(Buffer* buf)>;
+    // 零拷贝的流式正文：每次给出下一段正文的只读视图，视图须保持有效直到下一次调用；
+    // 返回 false 表示正文已全部产生，异步正文暂时没有数据时给出空视图
+    using SliceProducer = std::function<bool(std::string_view* slice)>;
+    // 异步正文的数据就绪后调用，可在任意线程调用，让发送方再次调用生产者
+    using Wakeup = std::function<void()>;
+    using WakeupReceiver = std::function<void(const Wakeup& wakeup)>;
+    using FailureCheck = std::function<bool()>;
+    // 101 响应写出后以该连接调用，由升级后的协议（如 WebSocket）接管连接
+    using UpgradeHandler = std::function<void(const std::shared_ptr<Connection>& conn)>;
+
+    // 头部从 arena 分配，通常传入请求的内存池（HttpRequest::arena），此时响应不能活过 HttpRequest::reset()；
+    // 需要保留的响应（缓存、合并请求的结果）以复制构造或 assignFrom 复制到默认分配器的响应中
+    explicit HttpResponse(std::pmr::memory_resource* arena = std::pmr::get_default_resource());
     ~HttpResponse() = default;
 
     void setStatusCode(HttpStatusCode code) {status_code_ = code; }
     void setStatusMessage(const std::string& message) {status_message_ = message; }
-    void setContentType(const std::string& content_type) {addHeader("Content-Type", content_type); }
-    void addHeader(const std::string& key, const std::string& value) {headers_[key] = value; }
-    void setBody(const std::string& body) {body_ = body; }
+    void setContentType(std::string_view content_type) {addHeader(kContentType, content_type); }
+    // 同名头部只保留最后一次设置的值
+    void addHeader(HeaderId id, std::string_view value);
+    void addHeader(std::string_view key, std::string_view value);
+    // 头部不存在时返回空
+    std::string_view getHeader(HeaderId id) const;
+    // 正文保存为引用计数的只读缓冲区，复制响应（缓存、合并请求）和写出时都不拷贝正文
+    void setBody(const std::string& body) { body_ = SharedBuffer(body); }
+    void setBody(std::string&& body) { body_ = SharedBuffer(std::move(body)); }
+    void setBody(const char* data, size_t len) { body_ = SharedBuffer(std::string(data, len)); }
+    // 直接引用已有的共享数据（如缓存条目中的内容）
+    void setBody(const SharedBuffer& body) { body_ = body; }
     // 添加Content-Length头
-    void setContentLength(int len) { addHeader("Content-Length", std::to_string(len)); }
+    void setContentLength(int len) { addHeader(kContentLength, std::to_string(len)); }
     // 添加Connection头为Keep-Alive做准备
     void setKeepAlive(bool on){
-        if(on) addHeader("Connection", "Keep-Alive");
-        else addHeader("Connection", "close");
+        if(on) addHeader(kConnection, "Keep-Alive");
+        else addHeader(kConnection, "close");
     }
+    // 每个响应都相同的头部（Server、Connection 等）预先拼成以 \r\n 结尾的整块，序列化时原样写出
+    // block 必须是静态存储，这些头部不会出现在 getHeaders() 中
+    void setHeaderBlock(std::string_view block) { header_block_ = block; }
     HttpStatusCode getStatusCode() const { return status_code_; }
     std::string getStatusMessage() const { return status_message_; } 
-    std::string getBody() const { return body_; }
-    
+    std::string_view getBody() const { return body_.view(); }
+    const SharedBuffer& getSharedBody() const { return body_; }
+    const std::pmr::vector<Header>& getHeaders() const { return headers_; }
+    static std::string_view headerName(const Header& header);
+    // 复制 other 的状态、头部和正文（包括流式生产者），同名头部以 other 为准，本响应的公共头部块不变
+    // 合并的并发请求（RequestCoalescer）用它把同一个处理结果交给各自的连接发送
+    void assignFrom(const HttpResponse& other);
+
+    // 设置后响应进入流式模式：不再使用 body_ 和 Content-Length，HTTP/1.1 下按 chunked 编码发送，
+    // 由连接在输出缓冲区腾出空间时逐段调用生产者，大响应的内存占用与正文长度无关
+    void setBodyProducer(const BodyProducer& producer) {
+        body_producer_ = producer;
+        slice_producer_ = nullptr;
+        wakeup_receiver_ = nullptr;
+        chunked_ = true;
+    }
+    // 正文长度事先已知的流式响应（如文件区间）：带 Content-Length 原样发送，不使用 chunked 编码
+    void setSizedBodyProducer(const BodyProducer& producer, size_t length) {
+        body_producer_ = producer;
+        slice_producer_ = nullptr;
+        wakeup_receiver_ = nullptr;
+        chunked_ = false;
+        addHeader(kContentLength, std::to_string(length));
+    }
+    // 定长流式正文的零拷贝形式，产生与 body_producer_ 相同的字节（如文件映射的切片）
+    // HTTP/1.1 连接优先使用它直接写出；替换 body_producer_ 时被清除，包装生产者的一方不必关心
+    void setSliceProducer(const SliceProducer& producer) { slice_producer_ = producer; }
+    const SliceProducer& getSliceProducer() const { return slice_producer_; }
+    // 能够在数据就绪时重新驱动生产者的发送方（HTTP/1.1 连接、HTTP/2 会话），在开始流式发送前把 wakeup 交给 receiver，
+    // 此后生产者可以暂时不产生数据；没有交出 wakeup 的发送方要求正文同步产生
+    void setWakeupReceiver(const WakeupReceiver& receiver) { wakeup_receiver_ = receiver; }
+    const WakeupReceiver& getWakeupReceiver() const { return wakeup_receiver_; }
+    // 流式正文中途无法继续（如文件在发送期间被截断）时 check 返回 true：已写出的正文不完整，
+    // 发送方在生产者结束后关闭连接（HTTP/2 重置流），而不是当作正常结束的响应
+    void setFailureCheck(const FailureCheck& check) { failure_check_ = check; }
+    bool streamFailed() const { return failure_check_ && failure_check_(); }
+    const FailureCheck& getFailureCheck() const { return failure_check_; }
+    // 协议升级只在 HTTP/1.1 连接上进行，HTTP/2 会话忽略它
+    void setUpgradeHandler(const UpgradeHandler& handler) { upgrade_handler_ = handler; }
+    const UpgradeHandler& getUpgradeHandler() const { return upgrade_handler_; }
+    bool isStreaming() const { return static_cast<bool>(body_producer_); }
+    // HTTP/1.1 下正文是否需要 chunked 编码
+    bool isChunked() const { return isStreaming() && chunked_; }
+    const BodyProducer& getBodyProducer() const { return body_producer_; }
+    // 调用一次生产者，把产生的数据编码为一个 chunk 追加到 buffer；正文结束时追加结尾的 0 长度 chunk
+    // @return: false 表示正文已结束
+    static bool appendChunk(const BodyProducer& producer, Buffer* buffer);
+
+    // 当前时间的 HTTP-date，每个 I/O 线程缓存一份，每秒最多格式化一次
+    static std::string_view cachedDate();
+
     // 将HTTP响应报文写入Buffer, 实现字符串拼接，状态行\r\n，头部：值\r\n，\r\n，正文的格式
+    // 流式响应只写出状态行和头部，正文由 appendChunk 逐段产生
     void appendToBuffer(Buffer* buffer) const;
+    // 只写出状态行和头部，正文由调用方以 getSharedBody() 引用发送（见 Connection::send）
+    void appendHeadToBuffer(Buffer* buffer) const;
 private:
+    // 状态行和头部，body_reserve 为随后追加的正文预留空间
+    void appendHead(Buffer* buffer, size_t body_reserve) const;
+
     HttpStatusCode status_code_;
     std::string status_message_;
-    std::unordered_map<std::string, std::string> headers_;
-    std::string body_;
-    void addStatusLineToBuffer(Buffer* buffer) const;
-    void addHeadersToBuffer(Buffer* buffer) const;
-};
\ No newline at end of file
+    std::pmr::vector<Header> headers_;
+    std::string_view header_block_;
+    SharedBuffer body_;
+    BodyProducer body_producer_;
+    SliceProducer slice_producer_;
+    WakeupReceiver wakeup_receiver_;
+    FailureCheck failure_check_;
+    UpgradeHandler upgrade_handler_;
+    bool chunked_;
+};
@@ -1,10 +1,36 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <filesystem>
 #include <optional>
+#include <vector>
+#include <ctime>
+#include <sys/types.h>
 
 namespace HttpUtils{
     // 根据基目录验证并解析所请求的路径
     // 有效则返回完整的安全路径，否则返回std::nullopt
     std::optional<std::string> getSafeFilePath(const std::string& base_path, const std::string& req_path);
+    // 格式化为 HTTP-date（RFC 9110 IMF-fixdate），如 "Sun, 06 Nov 1994 08:49:37 GMT"
+    std::string formatHttpDate(time_t t);
+    // 解析 HTTP-date，接受 IMF-fixdate 以及过时的 RFC 850、asctime 格式，格式错误时返回 -1
+    time_t parseHttpDate(std::string_view date);
+
+    // 由文件的 inode、大小和纳秒级修改时间生成强 ETag（带引号），suffix 用于区分同一文件的不同内容编码
+    std::string makeETag(ino_t ino, off_t size, const struct timespec& mtime, std::string_view suffix = "");
+    // If-None-Match 是否与 etag 匹配：列表中任一实体标签按弱比较相等（忽略 W/ 前缀）或为 "*"
+    bool etagMatches(std::string_view if_none_match, std::string_view etag);
+
+    // Range 请求中的一个字节区间
+    struct ByteRange {
+        off_t offset;
+        size_t length;
+    };
+    enum RangeResult {
+        kRangeIgnored,        // 格式错误、不是 bytes 单位或区间过多：忽略 Range，返回完整内容
+        kRangeSatisfiable,    // ranges 中至少有一个可满足的区间
+        kRangeUnsatisfiable,  // 所有区间都超出文件范围：返回 416
+    };
+    // 解析 Range 头部（RFC 9110 14.1.2），不可满足的单个区间直接丢弃，区间按请求中的顺序保存
+    RangeResult parseRange(std::string_view range, size_t size, std::vector<ByteRange>* ranges);
 }
\ No newline at end of file
@@ -6,6 +6,8 @@
 class MimeTypes{
 public:
     static std::string getMimeType(const std::string& extension);
+    // 文本类资源压缩收益明显；图片等已压缩的格式再压缩只会浪费 CPU
+    static bool isCompressible(const std::string& mime_type);
 private:
     static const std::unordered_map<std::string, std::string> mime_map_;
 };
\ No newline at end of file
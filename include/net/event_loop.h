@@ -55,10 +55,25 @@ public:
     void removeConnectionInLoop(const ConnectionPtr& conn);
     void addConnection(int fd, ConnectionPtr conn);
 
+    // 最近一段时间内处理事件（而不是阻塞在 epoll_wait 中）所占的时间比例，0~1
+    // 用于在线程繁忙时降低可选工作（如动态压缩）的开销，只应在所属线程中读取
+    double busyRatio() const { return busy_ratio_; }
+    // 事件从就绪到被处理的延迟（秒）：连续繁忙（epoll_wait 不阻塞）期间各轮循环处理耗时的最大值（平滑后），
+    // 与本轮 epoll_wait 返回至今的时间取大者。一轮循环处理得越久，这一轮中排在后面的事件、以及这期间新就绪的事件
+    // 等待得越久；epoll_wait 阻塞过则说明积压已清空。只应在所属线程中读取
+    double eventLag() const;
+    // 本轮 epoll_wait 返回的时间
+    Timestamp pollReturnTime() const { return poll_return_time_; }
+
+    // 当前线程的 EventLoop，不在 I/O 线程中时返回 nullptr
+    static EventLoop* getEventLoopOfCurrentThread();
+
 private:
     void abortNotInLoopThread();
     void doPendingFunctors();
     void handleRead(); // 用于wakeupFd_的读回调
+    // 每轮循环结束后累计空闲/繁忙时间，每个统计窗口更新一次 busy_ratio_
+    void updateBusyRatio(Timestamp poll_begin, Timestamp poll_end, Timestamp loop_end);
     
 
     using ChannelList = std::vector<Channel*>;
@@ -76,4 +91,15 @@ private:
     std::unique_ptr<Channel> wakeup_channel_;
     // 管理所有连接，key是sockfd
     std::map<int, ConnectionPtr> connections_;
+
+    // 繁忙度统计窗口（微秒），窗口之间做指数平滑，避免单次突发导致级别来回跳变
+    static const int64_t kLoadWindowUs = 100 * 1000;
+    // epoll_wait 阻塞超过该时间（微秒）视为线程曾经空闲，事件没有积压
+    static const int64_t kIdlePollUs = 1000;
+    double busy_ratio_;
+    int64_t window_busy_us_;
+    int64_t window_total_us_;
+    int64_t window_max_busy_us_; // 窗口内单轮循环处理耗时的最大值
+    double loop_lag_;            // 秒
+    Timestamp poll_return_time_;
 };
@@ -4,10 +4,17 @@
 
 class SslContext{
 public:
-    SslContext(const std::string& cert_path, const std::string& key_path);
+    // max_early_data > 0 时接受 TLS 1.3 0-RTT 数据，单位字节
+    // enable_http2 为 true 时通过 ALPN 优先协商 h2，否则只接受 http/1.1
+    SslContext(const std::string& cert_path, const std::string& key_path, uint32_t max_early_data = 0,
+               bool enable_http2 = false);
     ~SslContext();
 
     SSL_CTX* get() const { return ctx_; }
 private:
+    static int alpnSelectCallback(SSL* ssl, const unsigned char** out, unsigned char* outlen,
+                                  const unsigned char* in, unsigned int inlen, void* arg);
+
     SSL_CTX* ctx_;
+    bool enable_http2_;
 };
\ No newline at end of file
@@ -24,11 +24,14 @@ public:
     void start();
 
     // 启动SSL
-    void enableSsl(const std::string& cert_path, const std::string& key_path);
+    void enableSsl(const std::string& cert_path, const std::string& key_path, uint32_t max_early_data = 0,
+                   bool enable_http2 = false);
 
     // 设置回调
     void setConnectionCallback(const ConnectionCallback& cb) { connection_callback_ = cb; }
     void setMessageCallback(const MessageCallback& cb) { message_callback_ = cb; }
+    // 单次读事件中输入缓冲区累计超过该值时先交给业务处理，见 Connection::setInputWindow
+    void setInputWindow(size_t bytes) { input_window_ = bytes; }
     void onConnection(const ConnectionPtr& conn);
 private:
     // 处理新的连接的建立
@@ -47,6 +50,7 @@ private:
     // 回调函数
     ConnectionCallback connection_callback_;
     MessageCallback message_callback_;
+    size_t input_window_;
 
     
     const int kIdleConnectionTimeout; // 60秒空闲超时
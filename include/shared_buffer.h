@@ -0,0 +1,37 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+
+// 引用计数的只读字节：响应正文、缓存的内容、广播的帧在多个响应和连接之间共享，传递和发送时都不拷贝
+// 数据可以是更大缓冲区（缓存条目、预压缩变体）中的一段，由 owner 保证其生命周期；
+// owner 为空表示数据是静态存储（如编译进程序的资源）
+class SharedBuffer {
+public:
+    SharedBuffer() = default;
+    // 接管 data，之后不再修改
+    explicit SharedBuffer(std::string data) {
+        auto owner = std::make_shared<const std::string>(std::move(data));
+        data_ = *owner;
+        owner_ = std::move(owner);
+    }
+    explicit SharedBuffer(std::shared_ptr<const std::string> data)
+        : owner_(data), data_(data ? std::string_view(*data) : std::string_view()) {}
+    SharedBuffer(std::shared_ptr<const void> owner, std::string_view data)
+        : owner_(std::move(owner)), data_(data) {}
+
+    // [offset, offset + length) 的一段，与原缓冲区共享数据
+    SharedBuffer slice(size_t offset, size_t length = std::string_view::npos) const {
+        return SharedBuffer(owner_, data_.substr(offset, length));
+    }
+    void removePrefix(size_t n) { data_.remove_prefix(n); }
+
+    std::string_view view() const { return data_; }
+    const char* data() const { return data_.data(); }
+    size_t size() const { return data_.size(); }
+    bool empty() const { return data_.empty(); }
+
+private:
+    std::shared_ptr<const void> owner_;
+    std::string_view data_;
+};
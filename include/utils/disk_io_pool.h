@@ -0,0 +1,35 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// 执行可能阻塞在磁盘上的操作（冷文件的读取和缺页、静态资源的压缩）的线程池
+// I/O 线程只提交任务，任务完成后由任务自己通过 EventLoop::runInLoop 回到所属的 I/O 线程
+class DiskIoPool {
+public:
+    using Task = std::function<void()>;
+
+    static DiskIoPool& instance();
+
+    // 启动 num_threads 个线程，0 表示不启用，调用方应退回同步读取
+    void start(int num_threads);
+    void stop();
+    bool enabled() const { return !threads_.empty(); }
+
+    void submit(Task task);
+
+private:
+    DiskIoPool() = default;
+    ~DiskIoPool();
+
+    void threadFunc();
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<Task> tasks_;
+    bool running_ = false;
+};
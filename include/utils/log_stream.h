@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <cstring>
 #include <algorithm>
 #include <thread>
@@ -72,6 +73,10 @@ public:
         buffer_.append(v.c_str(), v.size());
         return *this;
     }
+    LogStream& operator<<(std::string_view v) {
+        buffer_.append(v.data(), v.size());
+        return *this;
+    }
 
     LogStream& operator<<(const std::thread::id& tid) {
         std::stringstream ss;
@@ -0,0 +1,49 @@
+#pragma once
+#include <memory_resource>
+#include <vector>
+#include <cstddef>
+
+// 请求级的单调内存池：分配只移动指针，释放是空操作，reset() 时整体回收
+// 请求对象、响应头部和处理函数的临时对象（路由参数、解码后的表单字段、std::pmr 容器）从这里分配，
+// 内存块在 reset() 后留给同一连接上的下一个请求，keep-alive 连接的稳定状态下不再向系统申请内存
+// 只能在一个线程中使用；从这里分配的对象不能活过 reset()，需要保留的数据（缓存、流式正文）应拷贝到普通堆上
+class RequestArena : public std::pmr::memory_resource {
+public:
+    // first_block: 第一个内存块的大小，之后的块按两倍增长
+    // max_retained: reset() 后保留的内存上限，超出的块归还系统
+    explicit RequestArena(size_t first_block = 1024, size_t max_retained = 64 * 1024);
+    ~RequestArena() override;
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    // 回收本次请求分配的全部内存
+    // 超出保留上限的块推迟到下一次分配时才归还：reset() 之后同一作用域内仍可能有容器在析构
+    void reset();
+
+    // 本次请求已分配的字节数（不含对齐填充）
+    size_t allocatedBytes() const { return allocated_; }
+
+private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    // 当前块放不下时切换到下一个能放下的块，没有时申请新块
+    void nextBlock(size_t bytes, size_t alignment);
+    // 归还超出保留上限的块
+    void trim();
+
+    size_t first_block_;
+    size_t max_retained_;
+    std::vector<Block> blocks_;
+    size_t current_;    // 正在分配的块在 blocks_ 中的下标
+    char* ptr_;         // 当前块中下一次分配的位置
+    char* end_;
+    size_t allocated_;
+    bool trim_pending_;
+};
@@ -34,8 +34,8 @@ void Buffer::makeSpace(size_t len){
     }else{
         // 内部腾挪，将可读数据移动到前面
         size_t readable = readableBytes();
-        std::copy(begin() + readableBytes(),
-                  begin() + writableBytes(),
+        std::copy(begin() + reader_index_,
+                  begin() + write_index_,
                   begin() + kCheapPrepend);
         reader_index_ = kCheapPrepend;
         write_index_ = reader_index_ + readable;
@@ -4,8 +4,20 @@
 #include <iostream>
 #include <cerrno>
 #include <arpa/inet.h>
+#include <sys/uio.h>
 #include <openssl/err.h>
 
+// TLS 单条记录的明文上限
+const size_t kTlsMaxRecordSize = 16 * 1024;
+// 连接初期使用的小记录，恰好装进一个 TCP 段（1460 MSS 减去 TLS 头部、MAC 等开销）
+const size_t kTlsSmallRecordSize = 1400;
+// 累计写出超过该字节数后切换到大记录
+const size_t kTlsBoostThreshold = 1024 * 1024;
+// 空闲超过该秒数后，拥塞窗口可能已回落，重新从小记录开始
+const double kTlsIdleResetSeconds = 1.0;
+// 一次 writev 最多携带的 iovec 数（每条响应的头部和共享正文各占一个）
+const size_t kMaxBatchIov = 64;
+
 // SSL_free的包装，用于unique_ptr
 void ssl_free_deleter(SSL* ssl){
     if(ssl){
@@ -17,11 +29,18 @@ Connection::Connection(EventLoop* loop, int sockfd, const struct sockaddr_in& pe
   : loop_(loop), 
     socket_(std::make_unique<Socket>(sockfd)), 
     channel_(std::make_unique<Channel>(loop, sockfd)),
+    shared_before_(0),
     peer_addr_(peer_addr),
     state_(kConnecting),
     last_active_time_(Timestamp::now()),
     ssl_(ssl, &ssl_free_deleter),
-    ssl_state_(ssl ? SslState::kHandshaking : SslState::kEstablished){ // 如果有ssl，则初始状态为握手
+    ssl_state_(ssl ? SslState::kHandshaking : SslState::kEstablished), // 如果有ssl，则初始状态为握手
+    in_message_callback_(false),
+    ssl_retry_len_(0),
+    tls_bytes_since_idle_(0),
+    reading_early_data_(ssl && SSL_get_max_early_data(ssl) > 0),
+    shutdown_after_handshake_(false),
+    input_window_(kDefaultInputWindow){
         
 }
 
@@ -37,6 +56,14 @@ std::string Connection::getPeerAddrStr() const {
     return std::string(ip_str) + ":" + std::to_string(port);
 }
 
+bool Connection::negotiatedHttp2() const {
+    if (!ssl_) return false;
+    const unsigned char* proto = nullptr;
+    unsigned int len = 0;
+    SSL_get0_alpn_selected(ssl_.get(), &proto, &len);
+    return len == 2 && proto[0] == 'h' && proto[1] == '2';
+}
+
 void Connection::setupHttpContext() {
     loop_->assertInLoopThread();
     setState(kConnected);
@@ -91,6 +118,9 @@ void Connection::connectionEstablished(){
 // 处理TLS握手
 void Connection::handleHandShake(){
     loop_->assertInLoopThread();
+    if(reading_early_data_ && !readEarlyData()){
+        return;
+    }
     int ret = SSL_do_handshake(ssl_.get());
 
     if(ret == 1){
@@ -99,23 +129,34 @@ void Connection::handleHandShake(){
 
         // 将回调切换到正常的HTTP数据处理
         setupHttpContext();
+        if (!channel_->isReading()) channel_->enableReading();
 
-        // 握手后可能已经有数据可读，所以立即调用read
-        if (SSL_pending(ssl_.get()) > 0) {
-            handleRead();
+        // early data 阶段未能写出的 0.5-RTT 响应，现在按普通数据写出
+        if (hasBufferedOutput()) {
+            if (!writeSslOutput()) {
+                handleError();
+                return;
+            }
+            if (hasBufferedOutput() && !channel_->isWriting()) {
+                channel_->enableWriting();
+            }
+        }
+
+        // early data 阶段开始的流式响应，现在由写事件驱动
+        if (isStreaming() && !channel_->isWriting()) {
+            channel_->enableWriting();
         }
 
+        // 握手后可能已经有数据可读，或有等待握手完成的 early data 请求，所以立即调用read
+        handleRead();
+
+        if (shutdown_after_handshake_ && state_ == kConnected) {
+            shutdownInLoop();
+        }
     }else{
         int err = SSL_get_error(ssl_.get(), ret);
-        if (err == SSL_ERROR_WANT_READ) {
-            // 关键：必须确保我们正在监听读事件
-            if (!channel_->isReading()) channel_->enableReading();
-            // 握手期间通常不需要监听写，除非 WANT_WRITE
-            if (channel_->isWriting()) channel_->disableWriting();
-        } else if (err == SSL_ERROR_WANT_WRITE) {
-            // 关键：必须监听写事件
-            if (!channel_->isWriting()) channel_->enableWriting();
-            if (channel_->isReading()) channel_->disableReading();
+        if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) {
+            waitForHandshakeIo(err);
         } else {
             // **失败处理**
             // 打印详细错误日志
@@ -129,6 +170,68 @@ void Connection::handleHandShake(){
     }
 }
 
+void Connection::waitForHandshakeIo(int ssl_err){
+    if (ssl_err == SSL_ERROR_WANT_READ) {
+        // 关键：必须确保我们正在监听读事件
+        if (!channel_->isReading()) channel_->enableReading();
+        // 握手期间通常不需要监听写，除非 WANT_WRITE
+        if (channel_->isWriting()) channel_->disableWriting();
+    } else {
+        // 关键：必须监听写事件
+        if (!channel_->isWriting()) channel_->enableWriting();
+        if (channel_->isReading()) channel_->disableReading();
+    }
+}
+
+bool Connection::readEarlyData(){
+    while (true) {
+        input_buffer_.ensureWritableBytes(kTlsMaxRecordSize);
+        size_t n = 0;
+        int ret = SSL_read_early_data(ssl_.get(), input_buffer_.beginWrite(), input_buffer_.writableBytes(), &n);
+        if (n > 0) {
+            input_buffer_.hasWritten(n);
+            updateLastActiveTime();
+        }
+        if (ret == SSL_READ_EARLY_DATA_SUCCESS) {
+            continue;
+        }
+        if (ret == SSL_READ_EARLY_DATA_FINISH) {
+            // 客户端的 early data 已全部读完（或客户端没有发送/被拒绝）
+            reading_early_data_ = false;
+            break;
+        }
+        int err = SSL_get_error(ssl_.get(), ret);
+        if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) {
+            // 先处理已经到达的请求，不必等待客户端的 Finished
+            dispatchEarlyData();
+            if (state_ != kDisconnected) waitForHandshakeIo(err);
+            return false;
+        }
+        char err_buf[256];
+        ERR_error_string_n(ERR_get_error(), err_buf, sizeof(err_buf));
+        LOG_ERROR << "SSL_read_early_data failed, fd=" << socket_->getFd() << ", Detail: " << err_buf;
+        handleError();
+        return false;
+    }
+    dispatchEarlyData();
+    return state_ != kDisconnected;
+}
+
+void Connection::dispatchEarlyData(){
+    if (input_buffer_.readableBytes() == 0 || state_ == kDisconnected) return;
+    if (SSL_get_early_data_status(ssl_.get()) != SSL_EARLY_DATA_ACCEPTED) return;
+
+    // 业务层通过 inEarlyData() 判断，只处理 replay_safe 的请求，其余的等握手完成
+    in_message_callback_ = true;
+    message_callback_(shared_from_this(), &input_buffer_);
+    in_message_callback_ = false;
+    if (state_ == kDisconnected) return;
+    // 以 0.5-RTT 数据写出响应，写不出去的部分留到握手完成后
+    if (hasBufferedOutput() && !writeSslOutput()) {
+        handleError();
+    }
+}
+
 void Connection::send(const std::string& msg){
     if(loop_->isInLoopThread()){
         sendInLoop(msg);
@@ -148,22 +251,31 @@ void Connection::sendInLoop(const std::string& msg){
     size_t remaining = msg.length();
     bool fault_error = false;
 
-    // 如果输出缓冲区为空，尝试直接发送
-    if(!channel_->isWriting() && output_buffer_.readableBytes() == 0){
-        if(ssl_){
-            nwrote = SSL_write(ssl_.get(), msg.data(), msg.length());
-            if(nwrote <= 0){
-                int err = SSL_get_error(ssl_.get(), nwrote);
-                if(err != SSL_ERROR_WANT_WRITE && err != SSL_ERROR_WANT_READ){
-                    ERR_print_errors_fp(stderr);
-                    fault_error = true;
-                }
-                nwrote = 0;
+    if(!ssl_ && in_message_callback_){
+        // 与同一批的其他响应保持顺序
+        Buffer buf;
+        buf.append(msg);
+        appendToBatch(&buf);
+        return;
+    }
+
+    if(ssl_){
+        // TLS：先进入输出缓冲，由writeSslOutput按记录大小写出
+        // 在message_callback_中产生的多个响应会在回调结束后合并写出
+        output_buffer_.append(msg);
+        if(!in_message_callback_ && !channel_->isWriting()){
+            if(!writeSslOutput()){
+                handleError();
+            }else if(hasBufferedOutput()){
+                channel_->enableWriting();
             }
-        }else{
-            nwrote = ::write(socket_->getFd(), msg.c_str(), msg.length());
-            
         }
+        return;
+    }
+
+    // 如果输出队列为空，尝试直接发送
+    if(!channel_->isWriting() && !hasBufferedOutput()){
+        nwrote = ::write(socket_->getFd(), msg.c_str(), msg.length());
         if(nwrote >= 0){
             remaining = msg.length() - nwrote;
             if(remaining == 0){
@@ -182,7 +294,7 @@ void Connection::sendInLoop(const std::string& msg){
     // 如果没有出错，并且还有数据没发完
     if(!fault_error && remaining > 0){
         // 将剩余数据放入输出缓存区
-        output_buffer_.append(msg.substr(nwrote));
+        output_buffer_.append(msg.data() + nwrote, remaining);
         // 开始监听可写事件
         if(!channel_->isWriting()){
             channel_->enableWriting();
@@ -196,13 +308,322 @@ void Connection::sendInLoop(const std::string& msg){
 
 void Connection::send(Buffer* buf){
     if(loop_->isInLoopThread()){
-        sendInLoop(buf->retrieveAllAsString());
+        if(in_message_callback_ && state_ == kConnected){
+            appendToBatch(buf);
+        }else{
+            sendInLoop(buf->retrieveAllAsString());
+        }
     }else{
         loop_->runInLoop(std::bind(&Connection::sendInLoop, this, buf->retrieveAllAsString()));
     }
     // ::write(socket_->getFd(), buf->peek(), buf->readableBytes());
 }
 
+void Connection::send(Buffer* buf, const SharedBuffer& data){
+    if(!loop_->isInLoopThread()){
+        std::string head = buf->retrieveAllAsString();
+        loop_->runInLoop([this, head, data](){
+            sendInLoop(head);
+            sendSharedInLoop(data);
+        });
+        return;
+    }
+    if(in_message_callback_ && state_ == kConnected){
+        appendToBatch(buf, data);
+        return;
+    }
+    if(buf->readableBytes() > 0){
+        sendInLoop(buf->retrieveAllAsString());
+    }
+    sendSharedInLoop(data);
+}
+
+void Connection::send(const SharedBuffer& data){
+    if(loop_->isInLoopThread()){
+        Buffer empty;
+        send(&empty, data);
+    }else{
+        loop_->runInLoop([this, data](){ sendSharedInLoop(data); });
+    }
+}
+
+void Connection::sendSharedInLoop(const SharedBuffer& data){
+    loop_->assertInLoopThread();
+    if(data.empty()) return;
+    if(state_ == kDisconnected || state_ == kDisconnecting){
+        LOG_WARN << "disconnected, give up writing";
+        return;
+    }
+    SharedBuffer remaining = data;
+    if(!ssl_ && !channel_->isWriting() && !hasBufferedOutput()){
+        // 输出队列为空时直接写，内核写不下的部分再以引用方式排队
+        ssize_t n = ::write(socket_->getFd(), remaining.data(), remaining.size());
+        if(n > 0){
+            remaining.removePrefix(static_cast<size_t>(n));
+            if(remaining.empty()) return;
+        }else if(n < 0 && errno != EWOULDBLOCK && errno != EAGAIN){
+            handleError();
+            return;
+        }
+    }
+    appendShared(remaining);
+    if(ssl_){
+        if(!in_message_callback_ && !channel_->isWriting()){
+            if(!writeSslOutput()){
+                handleError();
+            }else if(hasBufferedOutput()){
+                channel_->enableWriting();
+            }
+        }
+        return;
+    }
+    if(!channel_->isWriting()){
+        channel_->enableWriting();
+    }
+}
+
+void Connection::appendShared(const SharedBuffer& data){
+    if(data.empty()) return;
+    if(data.size() < kMinSharedSize){
+        output_buffer_.append(data.data(), data.size());
+        return;
+    }
+    size_t before = output_buffer_.readableBytes() - shared_before_;
+    shared_output_.push_back(SharedSlice{before, data});
+    shared_before_ = output_buffer_.readableBytes();
+}
+
+size_t Connection::outputBytes() const {
+    size_t bytes = output_buffer_.readableBytes();
+    for(const auto& slice : shared_output_){
+        bytes += slice.data.size();
+    }
+    return bytes;
+}
+
+int Connection::gatherOutput(struct iovec* iov, int max_iov) const {
+    int count = 0;
+    const char* buffered = output_buffer_.peek();
+    size_t remaining = output_buffer_.readableBytes();
+    for(const auto& slice : shared_output_){
+        if(count == max_iov) return count;
+        if(slice.before > 0){
+            iov[count].iov_base = const_cast<char*>(buffered);
+            iov[count++].iov_len = slice.before;
+            buffered += slice.before;
+            remaining -= slice.before;
+            if(count == max_iov) return count;
+        }
+        iov[count].iov_base = const_cast<char*>(slice.data.data());
+        iov[count++].iov_len = slice.data.size();
+    }
+    if(count < max_iov && remaining > 0){
+        iov[count].iov_base = const_cast<char*>(buffered);
+        iov[count++].iov_len = remaining;
+    }
+    if(count < max_iov && !stream_slice_.empty()){
+        iov[count].iov_base = const_cast<char*>(stream_slice_.data());
+        iov[count++].iov_len = stream_slice_.size();
+    }
+    return count;
+}
+
+void Connection::consumeOutput(size_t n){
+    while(n > 0 && !shared_output_.empty()){
+        SharedSlice& front = shared_output_.front();
+        if(front.before > 0){
+            size_t k = std::min(n, front.before);
+            output_buffer_.retrieve(k);
+            front.before -= k;
+            shared_before_ -= k;
+            n -= k;
+            continue;
+        }
+        size_t k = std::min(n, front.data.size());
+        front.data.removePrefix(k);
+        n -= k;
+        if(front.data.empty()) shared_output_.pop_front();
+    }
+    size_t from_buffer = std::min(n, output_buffer_.readableBytes());
+    output_buffer_.retrieve(from_buffer);
+    stream_slice_.remove_prefix(n - from_buffer);
+}
+
+void Connection::appendToBatch(Buffer* buf, const SharedBuffer& data){
+    if(ssl_ || channel_->isWriting() || hasBufferedOutput()){
+        // TLS 本来就在回调结束后合并写出；已有积压输出时必须排在其后
+        output_buffer_.append(buf->peek(), buf->readableBytes());
+        buf->retrieveAll();
+        appendShared(data);
+        return;
+    }
+    batch_.emplace_back();
+    batch_.back().buf.swap(*buf);
+    if(data.size() < kMinSharedSize){
+        batch_.back().buf.append(data.data(), data.size());
+    }else{
+        batch_.back().data = data;
+    }
+}
+
+void Connection::flushBatch(){
+    if(state_ == kDisconnected){
+        batch_.clear();
+        return;
+    }
+    size_t index = 0;
+    while(index < batch_.size()){
+        struct iovec iov[kMaxBatchIov];
+        size_t count = 0;
+        size_t total = 0;
+        for(size_t i = index; i < batch_.size() && count + 2 <= kMaxBatchIov; ++i){
+            iov[count].iov_base = const_cast<char*>(batch_[i].buf.peek());
+            iov[count++].iov_len = batch_[i].buf.readableBytes();
+            total += batch_[i].buf.readableBytes();
+            if(!batch_[i].data.empty()){
+                iov[count].iov_base = const_cast<char*>(batch_[i].data.data());
+                iov[count++].iov_len = batch_[i].data.size();
+                total += batch_[i].data.size();
+            }
+        }
+        ssize_t n = ::writev(socket_->getFd(), iov, static_cast<int>(count));
+        if(n < 0){
+            if(errno != EAGAIN && errno != EWOULDBLOCK){
+                batch_.clear();
+                handleError();
+                return;
+            }
+            break;
+        }
+        updateLastActiveTime();
+        size_t written = static_cast<size_t>(n);
+        while(index < batch_.size()){
+            BatchEntry& entry = batch_[index];
+            size_t k = std::min(written, entry.buf.readableBytes());
+            entry.buf.retrieve(k);
+            written -= k;
+            k = std::min(written, entry.data.size());
+            entry.data.removePrefix(k);
+            written -= k;
+            if(entry.buf.readableBytes() > 0 || !entry.data.empty()) break;
+            ++index;
+        }
+        if(static_cast<size_t>(n) < total){
+            // 部分写出，说明内核发送缓冲区已满
+            break;
+        }
+    }
+    // 没写完的部分转入输出队列，等待可写事件
+    for(size_t i = index; i < batch_.size(); ++i){
+        output_buffer_.append(batch_[i].buf.peek(), batch_[i].buf.readableBytes());
+        appendShared(batch_[i].data);
+    }
+    batch_.clear();
+    if(hasBufferedOutput()){
+        if(!channel_->isWriting()) channel_->enableWriting();
+    }else if(state_ == kDisconnecting && !channel_->isWriting()){
+        socket_->shutdownWrite();
+    }
+}
+
+void Connection::sendStream(const StreamProducer& producer, const ConnectionCallback& done){
+    loop_->assertInLoopThread();
+    stream_producer_ = producer;
+    startStream(done);
+}
+
+void Connection::sendSliceStream(const SliceProducer& producer, const ConnectionCallback& done){
+    loop_->assertInLoopThread();
+    slice_producer_ = producer;
+    startStream(done);
+}
+
+void Connection::startStream(const ConnectionCallback& done){
+    if(state_ != kConnected){
+        LOG_WARN << "disconnected, give up streaming";
+        stream_producer_ = nullptr;
+        slice_producer_ = nullptr;
+        return;
+    }
+    // 回调中暂存的输出（如响应头）必须先于流式数据
+    flushBatch();
+    if(state_ != kConnected){
+        stream_producer_ = nullptr;
+        slice_producer_ = nullptr;
+        return;
+    }
+    stream_done_ = done;
+    if(inEarlyData()){
+        // 0.5-RTT 阶段不驱动写事件，握手完成后再开始
+        return;
+    }
+    // 之前的输出（如响应头）和第一段数据一起由写路径发出，写不完时保持监听可写事件
+    if(!channel_->isWriting()){
+        channel_->enableWriting();
+    }
+    handleWrite();
+}
+
+std::function<void()> Connection::streamWakeup(){
+    std::weak_ptr<Connection> weak_self = shared_from_this();
+    EventLoop* loop = loop_;
+    return [weak_self, loop]() {
+        loop->runInLoop([weak_self]() {
+            if (auto self = weak_self.lock()) self->resumeStream();
+        });
+    };
+}
+
+void Connection::resumeStream(){
+    loop_->assertInLoopThread();
+    // 0.5-RTT 阶段的流由握手完成时驱动
+    if(state_ == kDisconnected || !isStreaming() || inEarlyData()) return;
+    if(!channel_->isWriting()){
+        channel_->enableWriting();
+    }
+    handleWrite();
+}
+
+void Connection::fillStream(){
+    // 切片不进入输出缓冲区，上一个切片写完后才取下一个
+    if(slice_producer_){
+        if(stream_slice_.empty() && !slice_producer_(&stream_slice_)){
+            slice_producer_ = nullptr;
+            finishStream();
+        }
+        return;
+    }
+    while(stream_producer_ && output_buffer_.readableBytes() < kStreamLowWaterMark){
+        size_t before = output_buffer_.readableBytes();
+        bool more = stream_producer_(&output_buffer_);
+        if(!more){
+            stream_producer_ = nullptr;
+            finishStream();
+        }else if(output_buffer_.readableBytes() == before){
+            // 生产者暂时没有数据，避免空转
+            break;
+        }
+    }
+}
+
+void Connection::finishStream(){
+    ConnectionCallback done = std::move(stream_done_);
+    stream_done_ = nullptr;
+    if(done) done(shared_from_this());
+    // 流式发送期间到达的流水线请求被搁置在输入缓冲区，结束后继续处理
+    // 在消息回调中结束的流由回调自己的循环继续；其余情况放到本轮事件处理之后，避免在写路径中重入
+    if(!in_message_callback_ && input_buffer_.readableBytes() > 0){
+        std::weak_ptr<Connection> weak_self = shared_from_this();
+        loop_->queueInLoop([weak_self]() {
+            auto self = weak_self.lock();
+            if (self && self->state_ == kConnected && !self->isStreaming() &&
+                self->input_buffer_.readableBytes() > 0) {
+                self->deliverInput();
+            }
+        });
+    }
+}
+
 void Connection::handleRead() {
     loop_->assertInLoopThread();
     int saved_errno = 0;
@@ -210,17 +631,24 @@ void Connection::handleRead() {
     if (state_ == kDisconnecting || state_ == kDisconnected) return;
     if (ssl_) { // HTTPS 逻辑
         while (true) {
-            char buf[65536];
-            int n = SSL_read(ssl_.get(), buf, sizeof(buf));
+            // 直接解密到 Buffer 的可写区域，省去栈上数组到 Buffer 的拷贝
+            input_buffer_.ensureWritableBytes(kTlsMaxRecordSize);
+            int n = SSL_read(ssl_.get(), input_buffer_.beginWrite(), static_cast<int>(input_buffer_.writableBytes()));
             if (n > 0) {
-                input_buffer_.append(buf, n);
+                input_buffer_.hasWritten(n);
                 updateLastActiveTime(); // 成功读到数据，更新时间
+                if (input_buffer_.readableBytes() >= input_window_ && state_ == kConnected) {
+                    deliverInput();
+                    if (state_ != kConnected) break;
+                }
             } else {
                 int err = SSL_get_error(ssl_.get(), n);
                 if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) {
                     break; 
                 } else if (err == SSL_ERROR_ZERO_RETURN) {
-                    // 收到 TLS 关闭通知
+                    // 收到 TLS 关闭通知，回应 close_notify
+                    // 未发送 close_notify 就释放的会话会被 OpenSSL 从会话缓存中剔除，无法再恢复
+                    SSL_shutdown(ssl_.get());
                     // 如果此时 buffer 里没有待处理数据，说明是空闲连接关闭，或者请求发送完毕后的关闭
                     if (input_buffer_.readableBytes() == 0) {
                         handleClose();
@@ -249,7 +677,10 @@ void Connection::handleRead() {
         while (true) {
             ssize_t n = input_buffer_.readFd(socket_->getFd(), &saved_errno);
             if (n > 0) {
-                // 继续
+                if (input_buffer_.readableBytes() >= input_window_ && state_ == kConnected) {
+                    deliverInput();
+                    if (state_ != kConnected) break;
+                }
             } else if (n == 0) {
                 handleClose();
                 break;
@@ -272,70 +703,159 @@ void Connection::handleRead() {
 
     // 统一的后续处理
     if (state_ != kConnected) return;
-    if (input_buffer_.readableBytes() > 0) {
+    // request_ 已完整但尚未处理，说明它是在 early data 阶段等待握手完成的请求
+    if (input_buffer_.readableBytes() > 0 || request_.gotAll()) {
         if (state_ == kConnected) {
-            updateLastActiveTime();
-            message_callback_(shared_from_this(), &input_buffer_);
+            deliverInput();
         } else {
             LOG_WARN << "Received data in non-connected state";
         }
     }
 }
 
+void Connection::deliverInput() {
+    updateLastActiveTime();
+    in_message_callback_ = true;
+    message_callback_(shared_from_this(), &input_buffer_);
+    in_message_callback_ = false;
+    if (!ssl_) {
+        // 回调期间产生的所有响应用一次 writev 写出
+        flushBatch();
+    } else if (!channel_->isWriting()) {
+        // 回调期间产生的所有 TLS 响应在这里一次性写出
+        if (!writeSslOutput()) {
+            handleError();
+        } else if (hasBufferedOutput()) {
+            channel_->enableWriting();
+        } else if (state_ == kDisconnecting) {
+            sslShutdownStep();
+        }
+    }
+}
+
+
+size_t Connection::tlsRecordSize() const {
+    if (tls_bytes_since_idle_ < kTlsBoostThreshold) {
+        return kTlsSmallRecordSize;
+    }
+    return kTlsMaxRecordSize;
+}
+
+bool Connection::writeSslOutput(){
+    loop_->assertInLoopThread();
+    // 空闲一段时间后重新从小记录开始
+    Timestamp now = Timestamp::now();
+    if (timeDifference(now, last_write_time_) > kTlsIdleResetSeconds) {
+        tls_bytes_since_idle_ = 0;
+    }
+    while (hasPendingOutput()) {
+        // 按发送顺序取下一段连续数据；共享数据和流式切片直接交给 SSL_write，不拷贝进缓冲区
+        struct iovec next;
+        gatherOutput(&next, 1);
+        const char* data = static_cast<const char*>(next.iov_base);
+        size_t available = next.iov_len;
+        // 上次写被打断时必须使用相同长度重试（缓冲区位置可变，已开启 ACCEPT_MOVING_WRITE_BUFFER）
+        size_t len = ssl_retry_len_ > 0 ? ssl_retry_len_ : std::min(available, tlsRecordSize());
+        int n = 0;
+        if (ssl_state_ == SslState::kHandshaking) {
+            // 0.5-RTT：握手完成前只能通过 SSL_write_early_data 写出
+            size_t written = 0;
+            int ret = SSL_write_early_data(ssl_.get(), data, len, &written);
+            if (ret != 1) {
+                int err = SSL_get_error(ssl_.get(), ret);
+                if (err == SSL_ERROR_WANT_WRITE || err == SSL_ERROR_WANT_READ) {
+                    // 暂时写不出去，保留在缓冲区，握手完成后以相同长度重试
+                    ssl_retry_len_ = len;
+                    return true;
+                }
+                LOG_ERROR << "SSL_write_early_data error code: " << err << ", fd=" << socket_->getFd();
+                ERR_print_errors_fp(stderr);
+                return false;
+            }
+            n = static_cast<int>(written);
+        } else {
+            n = SSL_write(ssl_.get(), data, static_cast<int>(len));
+        }
+        if (n > 0) {
+            ssl_retry_len_ = 0;
+            consumeOutput(static_cast<size_t>(n));
+            tls_bytes_since_idle_ += n;
+            last_write_time_ = now;
+            updateLastActiveTime();
+        } else {
+            int err = SSL_get_error(ssl_.get(), n);
+            if (err == SSL_ERROR_WANT_WRITE || err == SSL_ERROR_WANT_READ) {
+                ssl_retry_len_ = len;
+                return true;
+            }
+            ERR_print_errors_fp(stderr);
+            return false;
+        }
+    }
+    return true;
+}
+
+void Connection::sslShutdownStep(){
+    int ret = SSL_shutdown(ssl_.get());
+    if (ret >= 0) {
+        // close_notify 已发出，不必等待对端的 close_notify
+        if (channel_->isWriting()) channel_->disableWriting();
+        socket_->shutdownWrite(); // 最后关闭TCP写端
+    } else {
+        int err = SSL_get_error(ssl_.get(), ret);
+        if (err == SSL_ERROR_WANT_WRITE) {
+            // close_notify 还没写完，监听写事件继续
+            if (!channel_->isWriting()) channel_->enableWriting();
+        } else if (err != SSL_ERROR_WANT_READ) {
+            ERR_print_errors_fp(stderr);
+            handleError();
+        }
+    }
+}
 
 void Connection::handleWrite(){
     loop_->assertInLoopThread();
     if(channel_->isWriting()){
-        if (state_ == kDisconnecting && ssl_) {
-            // **正在执行 SSL 关闭**
-            int ret = SSL_shutdown(ssl_.get());
-            if (ret == 1) {
-                // SSL 关闭完成
-                channel_->disableWriting();
-                socket_->shutdownWrite(); // 最后关闭TCP写端
-            } else {
-                int err = SSL_get_error(ssl_.get(), ret);
-                if (err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE) {
-                    ERR_print_errors_fp(stderr);
+        if(ssl_){
+            while(true){
+                // 流式发送：每次写完都补充数据，直到 SSL 写不动或数据产生完毕
+                if(isStreaming()) fillStream();
+                if(!hasPendingOutput()) break;
+                if(!writeSslOutput()){
                     handleError();
+                    return;
+                }
+                if(hasPendingOutput()){
+                    // 保持isWriting，等待下一次机会
+                    return;
                 }
-                // 否则保持isWriting，等待下一次机会
             }
-        }else if(ssl_){
-            ssize_t n = SSL_write(ssl_.get(), output_buffer_.peek(), output_buffer_.readableBytes());
-            if(n > 0){
-                updateLastActiveTime();
-                output_buffer_.retrieve(n);
-                if(output_buffer_.readableBytes() == 0){
+            // 如果此时有关闭连接的计划，在数据写完后执行 SSL 关闭
+            if (state_ == kDisconnecting) {
+                sslShutdownStep();
+            } else if (channel_->isWriting()) {
+                // 数据发送完毕，必须停止监听可写事件，否则会busy-loop
+                channel_->disableWriting();
+            }
+        }else{
+            while(true){
+                if(isStreaming()) fillStream();
+                if(!hasPendingOutput()){
                     // 数据发送完毕，必须停止监听可写事件，否则会busy-loop
                     channel_->disableWriting();
                     // 如果此时有关闭连接的计划，可以在这里执行
                     if(state_ == kDisconnecting){
-                        shutdownInLoop();
+                        socket_->shutdownWrite();
                     }
+                    break;
                 }
-            }else{
-                int err = SSL_get_error(ssl_.get(), n);
-                if(err != SSL_ERROR_WANT_WRITE && err != SSL_ERROR_WANT_READ){
-                    ERR_print_errors_fp(stderr);
-                    handleError();
-                }
-            }
-        }else{
-            while(true){
-                size_t n = ::write(socket_->getFd(), output_buffer_.peek(), output_buffer_.readableBytes());
+                // 共享数据、流式切片与缓冲区中的数据（如响应头）按顺序一起 writev，不拷贝进缓冲区
+                struct iovec vec[kMaxBatchIov];
+                int count = gatherOutput(vec, static_cast<int>(kMaxBatchIov));
+                ssize_t n = ::writev(socket_->getFd(), vec, count);
                 if(n > 0){
                     updateLastActiveTime();
-                    output_buffer_.retrieve(n);
-                    if(output_buffer_.readableBytes() == 0){
-                        // 数据发送完毕，必须停止监听可写事件，否则会busy-loop
-                        channel_->disableWriting();
-                        // 如果此时有关闭连接的计划，可以在这里执行
-                        if(state_ == kDisconnecting){
-                            socket_->shutdownWrite();
-                        }
-                        break;
-                    }
+                    consumeOutput(static_cast<size_t>(n));
                 }else{
                     if(errno == EAGAIN || errno == EWOULDBLOCK){
                         // 内核缓冲区已满，不可再写
@@ -377,34 +897,23 @@ void Connection::shutdown(){
 
 void Connection::shutdownInLoop() {
     loop_->assertInLoopThread();
+    if (inEarlyData()) {
+        // early data 阶段还不能发送 close_notify，握手完成后再关闭
+        shutdown_after_handshake_ = true;
+        return;
+    }
     if (state_ == kConnected) {
         setState(kDisconnecting);
         if (ssl_) {
             // **HTTPS 关闭流程**
-            if (!channel_->isWriting()) {
-                // SSL_shutdown 可能需要多次I/O才能完成
-                int ret = SSL_shutdown(ssl_.get());
-                if (ret == 1) {
-                    // 立即完成
-                    socket_->shutdownWrite(); // 现在可以安全地关闭TCP写端了
-                } else if (ret == 0) {
-                    // 需要再次调用 SSL_shutdown
-                    channel_->enableWriting(); // 监听写事件以便继续shutdown
-                } else {
-                    int err = SSL_get_error(ssl_.get(), ret);
-                    if (err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE) {
-                        // 出错
-                        ERR_print_errors_fp(stderr);
-                        handleError();
-                    } else {
-                        // 需要更多I/O，监听写事件
-                        channel_->enableWriting();
-                    }
-                }
+            // 输出尚未写完时（正在监听写事件或仍在回调中合并响应），由写完后的路径继续关闭
+            if (!channel_->isWriting() && !in_message_callback_) {
+                sslShutdownStep();
             }
         } else {
-            // **HTTP 关闭流程 (保持不变)**
-            if (!channel_->isWriting()) {
+            // **HTTP 关闭流程**
+            // 回调中暂存的响应还没写出时，由 flushBatch 写完后关闭
+            if (!channel_->isWriting() && !in_message_callback_) {
                 socket_->shutdownWrite();
             }
         }
@@ -453,6 +962,10 @@ void Connection::forceClose() {
 void Connection::forceCloseInLoop() {
     loop_->assertInLoopThread();
     if (state_ == kConnected || state_ == kDisconnecting) {
+        if (ssl_ && ssl_state_ == SslState::kEstablished && !(SSL_get_shutdown(ssl_.get()) & SSL_SENT_SHUTDOWN)) {
+            // 尽力发送 close_notify，保证会话可以被恢复
+            SSL_shutdown(ssl_.get());
+        }
         handleClose(); // 直接进入关闭流程，清理资源
     }
 }
\ No newline at end of file
@@ -215,23 +215,27 @@ void Engine::LoadIndexFromFile(uint32_t file_id, DBFile* file) {
 Status Engine::Put(const std::string& key, const std::string& value) {
     if (key.empty()) return kInvalid;
 
-    std::lock_guard<std::mutex> lock(mutex_); // 写锁，保护整个写入流程
+    {
+        std::lock_guard<std::mutex> lock(mutex_); // 写锁，保护整个写入流程
 
-    // 1.1 构造 LogRecord
-    LogRecord record;
-    record.key = key;
-    record.value = value;
-    record.type = LOG_RECORD_NORMAL;
+        // 1.1 构造 LogRecord
+        LogRecord record;
+        record.key = key;
+        record.value = value;
+        record.type = LOG_RECORD_NORMAL;
 
-    // 1.2 追加写入磁盘
-    LogRecordPos pos;
-    if (!AppendLogRecord(record, &pos)) {
-        return kIOError;
-    }
+        // 1.2 追加写入磁盘
+        LogRecordPos pos;
+        if (!AppendLogRecord(record, &pos)) {
+            return kIOError;
+        }
 
-    // 1.3 更新内存索引
-    indexer_->Put(key, pos);
+        // 1.3 更新内存索引
+        indexer_->Put(key, pos);
+    }
 
+    // 1.4 通知上层（如响应缓存）该 key 已变化
+    if (write_listener_) write_listener_(key);
     return kSuccess;
 }
 
@@ -266,29 +270,33 @@ Status Engine::Get(const std::string& key, std::string* value) {
 Status Engine::Delete(const std::string& key) {
     if (key.empty()) return kInvalid;
 
-    std::lock_guard<std::mutex> lock(mutex_); // 写锁
+    {
+        std::lock_guard<std::mutex> lock(mutex_); // 写锁
 
-    // 3.1 查索引，看 Key 是否存在
-    LogRecordPos dummy_pos;
-    if (!indexer_->Get(key, &dummy_pos)) {
-        return kKeyNotFound; // Key 本就不存在
-    }
+        // 3.1 查索引，看 Key 是否存在
+        LogRecordPos dummy_pos;
+        if (!indexer_->Get(key, &dummy_pos)) {
+            return kKeyNotFound; // Key 本就不存在
+        }
 
-    // 3.2 构造墓碑消息 (Value 为空，Type 为 DELETED)
-    LogRecord record;
-    record.key = key;
-    record.value = ""; 
-    record.type = LOG_RECORD_DELETED;
+        // 3.2 构造墓碑消息 (Value 为空，Type 为 DELETED)
+        LogRecord record;
+        record.key = key;
+        record.value = ""; 
+        record.type = LOG_RECORD_DELETED;
 
-    // 3.3 写入磁盘 (持久化删除标记)
-    LogRecordPos pos;
-    if (!AppendLogRecord(record, &pos)) {
-        return kIOError;
-    }
+        // 3.3 写入磁盘 (持久化删除标记)
+        LogRecordPos pos;
+        if (!AppendLogRecord(record, &pos)) {
+            return kIOError;
+        }
 
-    // 3.4 从内存索引中删除
-    indexer_->Delete(key);
+        // 3.4 从内存索引中删除
+        indexer_->Delete(key);
+    }
 
+    // 3.5 通知上层该 key 已删除
+    if (write_listener_) write_listener_(key);
     return kSuccess;
 }
 
@@ -4,6 +4,7 @@
 #include <vector>
 #include <map>
 #include <mutex>
+#include <functional>
 #include "db_file.h"
 #include "db_common.h"
 #include "db_index.h"
@@ -39,6 +40,11 @@ public:
     // 关闭数据库
     void Close();
 
+    // 写入或删除成功后以该 key 调用（在写入线程中，已释放写锁），供上层的缓存失效
+    // 在打开数据库后、开始读写之前设置
+    using WriteListener = std::function<void(const std::string& key)>;
+    void SetWriteListener(WriteListener listener) { write_listener_ = std::move(listener); }
+
 private:
     // 内部辅助：将 LogRecord 写入活跃文件
     // 返回: 写入位置 pos
@@ -67,5 +73,7 @@ private:
     // 这两个步骤必须是原子的，否则可能出现数据写了但索引没更新的情况。
     // 读操作不需要这把锁，因为 Indexer 本身支持并发读。
     std::mutex mutex_; 
+
+    WriteListener write_listener_;
 };
 }
\ No newline at end of file
@@ -0,0 +1,26 @@
+#include "http/cache_control.h"
+#include "utils/logger.h"
+
+CacheControlPolicy& CacheControlPolicy::instance() {
+    static CacheControlPolicy policy;
+    return policy;
+}
+
+bool CacheControlPolicy::addRule(const std::string& path_pattern, const std::string& directive) {
+    try {
+        rules_.push_back({std::regex(path_pattern), directive});
+        return true;
+    } catch (const std::regex_error& e) {
+        LOG_ERROR << "Invalid cache_control pattern '" << path_pattern << "': " << e.what();
+        return false;
+    }
+}
+
+const std::string* CacheControlPolicy::lookup(const std::string& path) const {
+    for (const Rule& rule : rules_) {
+        if (std::regex_match(path, rule.path_regex)) {
+            return &rule.directive;
+        }
+    }
+    return nullptr;
+}
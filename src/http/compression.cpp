@@ -0,0 +1,179 @@
+#include "http/compression.h"
+#include "buffer.h"
+#include <zlib.h>
+#include <brotli/encode.h>
+#include <cctype>
+#include <cstdlib>
+
+namespace Compression {
+
+namespace {
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (::tolower(static_cast<unsigned char>(a[i])) != ::tolower(static_cast<unsigned char>(b[i]))) return false;
+    }
+    return true;
+}
+
+// 解析 ";q=0.5" 形式的参数，没有 q 参数时为 1
+double parseQuality(std::string_view params) {
+    size_t pos = 0;
+    while (pos < params.size()) {
+        size_t semi = params.find(';', pos);
+        std::string_view item = trim(params.substr(pos, semi == std::string_view::npos ? std::string_view::npos : semi - pos));
+        pos = semi == std::string_view::npos ? params.size() : semi + 1;
+        if (item.size() >= 2 && (item[0] == 'q' || item[0] == 'Q') && item[1] == '=') {
+            std::string value(item.substr(2));
+            return std::strtod(value.c_str(), nullptr);
+        }
+    }
+    return 1.0;
+}
+
+} // namespace
+
+Encoding negotiate(std::string_view accept_encoding) {
+    // -1 表示列表中没有出现
+    double gzip_q = -1, br_q = -1, any_q = -1;
+    size_t pos = 0;
+    while (pos < accept_encoding.size()) {
+        size_t comma = accept_encoding.find(',', pos);
+        std::string_view item = accept_encoding.substr(pos, comma == std::string_view::npos ? std::string_view::npos : comma - pos);
+        pos = comma == std::string_view::npos ? accept_encoding.size() : comma + 1;
+
+        size_t semi = item.find(';');
+        std::string_view coding = trim(item.substr(0, semi));
+        double q = semi == std::string_view::npos ? 1.0 : parseQuality(item.substr(semi + 1));
+        if (equalsIgnoreCase(coding, "gzip") || equalsIgnoreCase(coding, "x-gzip")) {
+            gzip_q = q;
+        } else if (equalsIgnoreCase(coding, "br")) {
+            br_q = q;
+        } else if (coding == "*") {
+            any_q = q;
+        }
+    }
+    // 没有单独列出的编码按 * 的 q 值处理
+    if (gzip_q < 0) gzip_q = any_q;
+    if (br_q < 0) br_q = any_q;
+
+    if (br_q > 0 && br_q >= gzip_q) return kBrotli;
+    if (gzip_q > 0) return kGzip;
+    return kIdentity;
+}
+
+const char* encodingName(Encoding encoding) {
+    switch (encoding) {
+    case kGzip: return "gzip";
+    case kBrotli: return "br";
+    default: return "";
+    }
+}
+
+bool gzip(std::string_view input, std::string* output, int level) {
+    z_stream stream{};
+    // windowBits 加 16 输出 gzip 格式（带 gzip 头和 CRC32），而不是裸 zlib 流
+    if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    output->resize(deflateBound(&stream, input.size()));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&(*output)[0]);
+    stream.avail_out = static_cast<uInt>(output->size());
+    int ret = deflate(&stream, Z_FINISH);
+    output->resize(stream.total_out);
+    deflateEnd(&stream);
+    return ret == Z_STREAM_END;
+}
+
+bool brotli(std::string_view input, std::string* output, int quality) {
+    size_t encoded_size = BrotliEncoderMaxCompressedSize(input.size());
+    if (encoded_size == 0) return false;
+    output->resize(encoded_size);
+    if (!BrotliEncoderCompress(quality, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT, input.size(),
+                               reinterpret_cast<const uint8_t*>(input.data()), &encoded_size,
+                               reinterpret_cast<uint8_t*>(&(*output)[0]))) {
+        return false;
+    }
+    output->resize(encoded_size);
+    return true;
+}
+
+StreamCompressor::StreamCompressor(Encoding encoding, int level)
+    : encoding_(encoding), zstream_(nullptr), brotli_(nullptr) {
+    if (encoding_ == kGzip) {
+        zstream_ = new z_stream{};
+        if (deflateInit2(zstream_, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            delete zstream_;
+            zstream_ = nullptr;
+        }
+    } else if (encoding_ == kBrotli) {
+        brotli_ = BrotliEncoderCreateInstance(nullptr, nullptr, nullptr);
+        if (brotli_) {
+            BrotliEncoderSetParameter(brotli_, BROTLI_PARAM_QUALITY, static_cast<uint32_t>(level));
+            BrotliEncoderSetParameter(brotli_, BROTLI_PARAM_MODE, BROTLI_MODE_TEXT);
+        }
+    }
+}
+
+StreamCompressor::~StreamCompressor() {
+    if (zstream_) {
+        deflateEnd(zstream_);
+        delete zstream_;
+    }
+    if (brotli_) {
+        BrotliEncoderDestroyInstance(brotli_);
+    }
+}
+
+bool StreamCompressor::compress(std::string_view input, bool finish, Buffer* output) {
+    if (zstream_) return compressGzip(input, finish, output);
+    if (brotli_) return compressBrotli(input, finish, output);
+    return false;
+}
+
+bool StreamCompressor::compressGzip(std::string_view input, bool finish, Buffer* output) {
+    zstream_->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    zstream_->avail_in = static_cast<uInt>(input.size());
+    int flush = finish ? Z_FINISH : Z_SYNC_FLUSH;
+    while (true) {
+        output->ensureWritableBytes(deflateBound(zstream_, zstream_->avail_in) + 16);
+        zstream_->next_out = reinterpret_cast<Bytef*>(output->beginWrite());
+        zstream_->avail_out = static_cast<uInt>(output->writableBytes());
+        int ret = deflate(zstream_, flush);
+        output->hasWritten(output->writableBytes() - zstream_->avail_out);
+        if (ret == Z_STREAM_ERROR) return false;
+        if (finish ? ret == Z_STREAM_END : (zstream_->avail_in == 0 && zstream_->avail_out > 0)) {
+            return true;
+        }
+    }
+}
+
+bool StreamCompressor::compressBrotli(std::string_view input, bool finish, Buffer* output) {
+    size_t available_in = input.size();
+    const uint8_t* next_in = reinterpret_cast<const uint8_t*>(input.data());
+    BrotliEncoderOperation op = finish ? BROTLI_OPERATION_FINISH : BROTLI_OPERATION_FLUSH;
+    while (true) {
+        output->ensureWritableBytes(BrotliEncoderMaxCompressedSize(available_in) + 1024);
+        size_t available_out = output->writableBytes();
+        uint8_t* next_out = reinterpret_cast<uint8_t*>(output->beginWrite());
+        if (!BrotliEncoderCompressStream(brotli_, op, &available_in, &next_in, &available_out, &next_out, nullptr)) {
+            return false;
+        }
+        output->hasWritten(output->writableBytes() - available_out);
+        bool done = finish ? BrotliEncoderIsFinished(brotli_) : available_in == 0;
+        if (done && !BrotliEncoderHasMoreOutput(brotli_)) {
+            return true;
+        }
+    }
+}
+
+} // namespace Compression
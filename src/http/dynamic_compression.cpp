@@ -0,0 +1,129 @@
+#include "http/dynamic_compression.h"
+#include "mime_types.h"
+#include <memory>
+#include <ctime>
+
+namespace {
+
+// 空闲时的级别：gzip 6 是 zlib 默认值，brotli 4 之后压缩率提升有限而耗时成倍增加
+const int kGzipLevel = 6;
+const int kBrotliQuality = 4;
+const int kFastLevel = 1;
+
+uint64_t threadCpuNs() {
+    struct timespec ts;
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// 流式正文的压缩状态，由包装后的生产者持有
+struct StreamState {
+    StreamState(Compression::Encoding encoding, int level) : compressor(encoding, level) {}
+    Compression::StreamCompressor compressor;
+    Buffer raw;
+};
+
+} // namespace
+
+DynamicCompression& DynamicCompression::instance() {
+    static DynamicCompression compression;
+    return compression;
+}
+
+int DynamicCompression::chooseLevel(Compression::Encoding encoding, double load) const {
+    if (load >= options_.off_load) return 0;
+    if (load >= options_.fast_load) return kFastLevel;
+    return encoding == Compression::kBrotli ? kBrotliQuality : kGzipLevel;
+}
+
+void DynamicCompression::apply(const HttpRequest& req, HttpResponse* resp, double load) {
+    if (!options_.enabled || req.getMethod() == HttpRequest::HEAD || req.getRoutePattern().empty()) {
+        return;
+    }
+    if (!resp->getHeader(HttpResponse::kContentEncoding).empty() || !resp->getHeader(HttpResponse::kVary).empty()) {
+        return;
+    }
+    if (!MimeTypes::isCompressible(std::string(resp->getHeader(HttpResponse::kContentType)))) {
+        return;
+    }
+    bool streaming = resp->isStreaming();
+    if (!streaming && resp->getBody().size() < options_.min_size) {
+        return;
+    }
+    // 定长的流式正文（文件区间）已声明 Content-Length，压缩后长度会变化
+    if (streaming && !resp->isChunked()) {
+        return;
+    }
+
+    // 响应内容随 Accept-Encoding 变化，即使本次没有压缩也要告知缓存
+    resp->addHeader(HttpResponse::kVary, "Accept-Encoding");
+    Compression::Encoding encoding = Compression::negotiate(req.header(HttpRequest::kAcceptEncoding));
+    if (encoding == Compression::kIdentity) return;
+
+    std::string route(req.getRoutePattern());
+    RouteStats delta;
+    int level = chooseLevel(encoding, load);
+    if (level == 0) {
+        delta.skipped_busy = 1;
+        record(route, delta);
+        return;
+    }
+    delta.compressed = 1;
+    delta.fast = level == kFastLevel ? 1 : 0;
+
+    if (streaming) {
+        // 流式正文逐段压缩，每段的统计在生产者中累计
+        record(route, delta);
+        resp->addHeader(HttpResponse::kContentEncoding, Compression::encodingName(encoding));
+        auto state = std::make_shared<StreamState>(encoding, level);
+        HttpResponse::BodyProducer producer = resp->getBodyProducer();
+        resp->setBodyProducer([this, state, producer, route](Buffer* out) {
+            bool more = producer(&state->raw);
+            RouteStats chunk;
+            chunk.bytes_in = state->raw.readableBytes();
+            size_t before = out->readableBytes();
+            uint64_t start = threadCpuNs();
+            bool ok = state->compressor.compress(std::string_view(state->raw.peek(), state->raw.readableBytes()),
+                                                 !more, out);
+            chunk.cpu_ns = threadCpuNs() - start;
+            chunk.bytes_out = out->readableBytes() - before;
+            state->raw.retrieveAll();
+            record(route, chunk);
+            return ok && more;
+        });
+        return;
+    }
+
+    std::string_view body = resp->getBody();
+    std::string compressed;
+    uint64_t start = threadCpuNs();
+    bool ok = encoding == Compression::kBrotli ? Compression::brotli(body, &compressed, level)
+                                               : Compression::gzip(body, &compressed, level);
+    delta.cpu_ns = threadCpuNs() - start;
+    if (!ok || compressed.size() >= body.size()) {
+        // 压缩失败或没有变小，按原样发送
+        return;
+    }
+    delta.bytes_in = body.size();
+    delta.bytes_out = compressed.size();
+    record(route, delta);
+    resp->addHeader(HttpResponse::kContentEncoding, Compression::encodingName(encoding));
+    resp->setContentLength(static_cast<int>(compressed.size()));
+    resp->setBody(std::move(compressed));
+}
+
+void DynamicCompression::record(const std::string& route, const RouteStats& delta) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    RouteStats& stats = stats_[route];
+    stats.compressed += delta.compressed;
+    stats.fast += delta.fast;
+    stats.skipped_busy += delta.skipped_busy;
+    stats.bytes_in += delta.bytes_in;
+    stats.bytes_out += delta.bytes_out;
+    stats.cpu_ns += delta.cpu_ns;
+}
+
+std::map<std::string, DynamicCompression::RouteStats> DynamicCompression::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
@@ -0,0 +1,65 @@
+#include "http/embedded_assets.h"
+#include "http/cache_control.h"
+#include "http_utils.h"
+#include "mime_types.h"
+
+#ifdef TF_EMBED_WWW
+// 由构建时生成的 embedded_www.cpp 定义
+extern const EmbeddedAsset kEmbeddedAssets[];
+extern const size_t kEmbeddedAssetCount;
+#else
+static const EmbeddedAsset* const kEmbeddedAssets = nullptr;
+static const size_t kEmbeddedAssetCount = 0;
+#endif
+
+namespace {
+
+std::string_view view(const unsigned char* data, size_t size) {
+    return data ? std::string_view(reinterpret_cast<const char*>(data), size) : std::string_view();
+}
+
+// 在强 ETag 的引号内加上编码后缀，与 HttpUtils::makeETag 的格式一致
+std::string variantETag(const std::string& etag, Compression::Encoding encoding) {
+    return etag.substr(0, etag.size() - 1) + "-" + Compression::encodingName(encoding) + "\"";
+}
+
+} // namespace
+
+EmbeddedAssets& EmbeddedAssets::instance() {
+    static EmbeddedAssets assets;
+    return assets;
+}
+
+size_t EmbeddedAssets::count() {
+    return kEmbeddedAssetCount;
+}
+
+EmbeddedAssets::EmbeddedAssets() {
+    for (size_t i = 0; i < kEmbeddedAssetCount; ++i) {
+        const EmbeddedAsset& asset = kEmbeddedAssets[i];
+        auto entry = std::make_shared<StaticFileCache::Entry>();
+        entry->file_path = asset.path;
+        entry->mime_type = asset.mime_type;
+        entry->size = asset.size;
+        entry->mtime = asset.mtime;
+        entry->compressible = MimeTypes::isCompressible(entry->mime_type) &&
+                              entry->size >= PrecompressedCache::kMinCompressSize;
+        entry->etag = asset.etag;
+        entry->gzip_etag = variantETag(entry->etag, Compression::kGzip);
+        entry->br_etag = variantETag(entry->etag, Compression::kBrotli);
+        entry->last_modified = HttpUtils::formatHttpDate(asset.mtime);
+        if (const std::string* cache_control = CacheControlPolicy::instance().lookup(asset.path)) {
+            entry->cache_control = *cache_control;
+        }
+        entry->has_content = true;
+        entry->content = view(asset.data, asset.size);
+        entry->gzip = view(asset.gzip, asset.gzip_size);
+        entry->brotli = view(asset.brotli, asset.brotli_size);
+        entries_[asset.path] = entry;
+    }
+}
+
+std::shared_ptr<const StaticFileCache::Entry> EmbeddedAssets::lookup(const std::string& path) const {
+    auto it = entries_.find(path);
+    return it != entries_.end() ? it->second : nullptr;
+}
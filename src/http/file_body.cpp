@@ -0,0 +1,109 @@
+#include "http/file_body.h"
+#include "utils/disk_io_pool.h"
+#include <algorithm>
+#include <cstring>
+
+std::shared_ptr<FileBody> FileBody::open(const std::string& path) {
+    std::shared_ptr<const MappedFile> file = MappedFile::open(path);
+    if (!file) return nullptr;
+    return std::shared_ptr<FileBody>(new FileBody(std::move(file)));
+}
+
+bool FileBody::addRange(off_t offset, size_t length) {
+    if (offset < 0 || static_cast<size_t>(offset) > file_->size() ||
+        length > file_->size() - static_cast<size_t>(offset)) {
+        return false;
+    }
+    segments_.push_back({offset, length, std::string()});
+    total_length_ += length;
+    file_->willNeed(offset, length);
+    return true;
+}
+
+void FileBody::addText(const std::string& text) {
+    segments_.push_back({0, text.size(), text});
+    total_length_ += text.size();
+}
+
+bool FileBody::readRange(off_t offset, size_t length, std::string* content) const {
+    if (offset < 0 || static_cast<size_t>(offset) > file_->size() ||
+        length > file_->size() - static_cast<size_t>(offset)) {
+        return false;
+    }
+    content->assign(file_->data() + offset, length);
+    return !failed();
+}
+
+std::string_view FileBody::take(size_t limit) {
+    const Segment& segment = segments_[segment_];
+    size_t len = std::min(limit, segment.length - segment_offset_);
+    std::string_view view = segment.text.empty()
+        ? std::string_view(file_->data() + segment.offset + segment_offset_, len)
+        : std::string_view(segment.text.data() + segment_offset_, len);
+    segment_offset_ += len;
+    if (segment_offset_ == segment.length) {
+        ++segment_;
+        segment_offset_ = 0;
+    }
+    return view;
+}
+
+bool FileBody::resident() const {
+    for (const Segment& segment : segments_) {
+        if (segment.text.empty() && !file_->resident(segment.offset, segment.length)) return false;
+    }
+    return true;
+}
+
+bool FileBody::ready(size_t length) {
+    if (!wakeup_) return true;
+    const Segment& segment = segments_[segment_];
+    off_t offset = segment.offset + static_cast<off_t>(segment_offset_);
+    length = std::min(length, segment.length - segment_offset_);
+    if (prefetching_) {
+        if (!prefetch_done_->load(std::memory_order_acquire)) return false;
+        // 刚读入的区间直接使用，mincore 在没有文件写权限时可能报告不在内存中
+        prefetching_ = false;
+        return true;
+    }
+    if (file_->resident(offset, length)) return true;
+    prefetching_ = true;
+    prefetch_done_ = std::make_shared<std::atomic<bool>>(false);
+    DiskIoPool::instance().submit([file = file_, offset, length, done = prefetch_done_, wakeup = wakeup_]() {
+        file->prefault(offset, length);
+        done->store(true, std::memory_order_release);
+        wakeup();
+    });
+    return false;
+}
+
+bool FileBody::produce(Buffer* buf) {
+    if (failed()) return false;
+    size_t start = buf->readableBytes();
+    size_t budget = kChunkSize;
+    while (budget > 0 && segment_ < segments_.size()) {
+        // 数据不在页缓存中时先不产生，读入后由 wakeup 通知发送方再次调用
+        if (segments_[segment_].text.empty() && !ready(budget)) break;
+        std::string_view view = take(budget);
+        buf->append(view.data(), view.size());
+        budget -= view.size();
+    }
+    if (failed()) {
+        // 这次拷贝中途遇到截断，截断处之后是填充的 0，不能发出去
+        buf->unwrite(buf->readableBytes() - start);
+        return false;
+    }
+    return segment_ < segments_.size();
+}
+
+bool FileBody::nextSlice(std::string_view* slice) {
+    if (segment_ >= segments_.size() || failed()) return false;
+    const Segment& segment = segments_[segment_];
+    if (!segment.text.empty()) {
+        *slice = take(segment.length);
+        return true;
+    }
+    // 空切片表示暂时没有数据，读入后由 wakeup 通知
+    *slice = ready(kSliceSize) ? take(kSliceSize) : std::string_view();
+    return true;
+}
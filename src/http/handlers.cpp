@@ -4,9 +4,22 @@
 #include "http_utils.h" // For getSafeFilePath
 #include "utils/logger.h"
 #include "mime_types.h"
+#include "http/compression.h"
+#include "http/precompressed_cache.h"
+#include "http/cache_control.h"
+#include "http/file_body.h"
+#include "http/static_file_cache.h"
+#include "http/embedded_assets.h"
+#include "utils/disk_io_pool.h"
 #include <filesystem>
 #include <fstream>
 #include <sstream>
+#include <random>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
 
 // 外部变量，由 main.cpp 初始化
 extern std::string base_path;
@@ -24,6 +37,15 @@ HandlerRegistrar::HandlerRegistrar(const std::string& name, HttpHandler handler)
     getHandlerRegistry()[name] = handler;
 }
 
+BodyReaderRegistry& getBodyReaderRegistry() {
+    static BodyReaderRegistry registry;
+    return registry;
+}
+
+BodyReaderRegistrar::BodyReaderRegistrar(const std::string& name, BodyReaderFactory factory) {
+    getBodyReaderRegistry()[name] = factory;
+}
+
 // ------------------------- 具体的 Handler 实现 -----------------------------
 
 // 处理登录请求 (POST /login)
@@ -54,7 +76,7 @@ void handleGetUserById(const HttpRequest& req, HttpResponse* resp) {
         resp->setBody("Missing user ID");
         return;
     }
-    std::string user_id = params[0]; // 第一个捕获组
+    std::string user_id(params[0]); // 第一个捕获组
     LOG_INFO << "Get user info for ID: " << user_id;
     
     resp->setStatusCode(HttpResponse::k200Ok);
@@ -67,7 +89,7 @@ REGISTER_HANDLER("getUserById", handleGetUserById);
 void handleGetProductByName(const HttpRequest& req, HttpResponse* resp) {
     const auto& params = req.getRouteParams();
     if (params.empty()) { /* ... */ return; }
-    std::string product_name = params[0];
+    std::string product_name(params[0]);
     LOG_INFO << "Get product info for name: " << product_name;
 
     resp->setStatusCode(HttpResponse::k200Ok);
@@ -77,6 +99,332 @@ void handleGetProductByName(const HttpRequest& req, HttpResponse* resp) {
 }
 REGISTER_HANDLER("getProductByName", handleGetProductByName);
 
+// 读取整个文件内容
+static bool readFile(const std::string& file_path, std::string* content) {
+    std::ifstream file(file_path, std::ios::in | std::ios::binary);
+    if (!file) return false;
+    // 使用stringstream读取整个文件内容
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    *content = buffer.str();
+    return true;
+}
+
+// 读取大小为 size 的文件到 content；nowait 时只读页缓存中已有的数据（preadv2 RWF_NOWAIT），
+// 需要读盘时置 *would_block 并返回 false，由调用方改走不阻塞的路径
+static bool readCachedFile(const std::string& file_path, size_t size, std::string* content, bool nowait,
+                           bool* would_block) {
+    int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    content->resize(size);
+    size_t done = 0;
+    bool ok = true;
+    while (done < size) {
+        struct iovec iov = {&(*content)[done], size - done};
+        ssize_t n = ::preadv2(fd, &iov, 1, static_cast<off_t>(done), nowait ? RWF_NOWAIT : 0);
+        if (n > 0) {
+            done += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && nowait && errno == EAGAIN) {
+            *would_block = true;
+            ok = false;
+            break;
+        } else if (n < 0 && nowait && errno == EOPNOTSUPP) {
+            nowait = false; // 文件系统不支持 RWF_NOWAIT，退回普通读取
+        } else {
+            ok = false;     // 读错误，或文件在 stat 之后被截断
+            break;
+        }
+    }
+    ::close(fd);
+    return ok;
+}
+
+static void sendInternalError(HttpResponse* resp) {
+    resp->setStatusCode(HttpResponse::k500InternalServerError);
+    resp->setStatusMessage("Internal Server Error");
+    resp->setContentType("text/html; charset=utf-8"); // 简化处理
+    resp->setBody("<html><body><h1>500 Internal Server Error</h1></body></html>");
+    resp->setContentLength(resp->getBody().length());
+}
+
+static void sendFileBody(const std::shared_ptr<FileBody>& body, HttpResponse* resp) {
+    // 不在页缓存中的文件以流式正文发送，由磁盘线程读入后再继续，I/O 线程不因缺页阻塞
+    bool async = DiskIoPool::instance().enabled() && !body->resident();
+    if (body->totalLength() > FileBody::kChunkSize || async) {
+        // HTTP/1.1 直接发送映射的切片，HTTP/2 仍由生产者逐段拷贝进 DATA 帧
+        resp->setSizedBodyProducer([body](Buffer* buf) { return body->produce(buf); }, body->totalLength());
+        resp->setSliceProducer([body](std::string_view* slice) { return body->nextSlice(slice); });
+        if (async) {
+            resp->setWakeupReceiver([body](const HttpResponse::Wakeup& wakeup) { body->enableAsync(wakeup); });
+        }
+        resp->setFailureCheck([body]() { return body->failed(); });
+        return;
+    }
+    // 较小的正文直接拼成普通正文发送
+    Buffer buf;
+    while (body->produce(&buf)) {}
+    if (body->failed()) {
+        sendInternalError(resp);
+        return;
+    }
+    resp->setBody(buf.retrieveAllAsString());
+    resp->setContentLength(resp->getBody().length());
+}
+
+// If-Range 为实体标签时要求强比较相等，为日期时要求与 Last-Modified 完全相同
+static bool ifRangeMatches(std::string_view if_range, const std::string& etag, time_t mtime) {
+    if (if_range.empty()) return true;
+    if (if_range.front() == '"' || if_range.substr(0, 2) == "W/") {
+        return if_range == etag;
+    }
+    return HttpUtils::parseHttpDate(if_range) == mtime;
+}
+
+static std::string contentRange(const HttpUtils::ByteRange& range, size_t file_size) {
+    return "bytes " + std::to_string(range.offset) + "-" + std::to_string(range.offset + range.length - 1) +
+           "/" + std::to_string(file_size);
+}
+
+// 206 响应：单个区间直接作为正文，多个区间组成 multipart/byteranges
+// 内容已缓存时直接从内存截取，否则从文件中按区间读出
+static void sendRanges(const StaticFileCache::Entry& entry, const std::vector<HttpUtils::ByteRange>& ranges,
+                       HttpResponse* resp) {
+    std::shared_ptr<FileBody> body;
+    std::string buffered;
+    if (!entry.has_content) {
+        body = FileBody::open(entry.file_path);
+        // 区间按条目记录的大小解析，文件此后被截断时无法兑现
+        if (!body || body->fileSize() < entry.size) {
+            sendInternalError(resp);
+            return;
+        }
+    }
+    auto addText = [&](const std::string& text) {
+        if (body) body->addText(text);
+        else buffered += text;
+    };
+    auto addRange = [&](const HttpUtils::ByteRange& range) {
+        if (body) body->addRange(range.offset, range.length);
+        else buffered.append(entry.content.data() + range.offset, range.length);
+    };
+
+    resp->setStatusCode(HttpResponse::k206PartialContent);
+    if (ranges.size() == 1) {
+        resp->setContentType(entry.mime_type);
+        resp->addHeader(HttpResponse::kContentRange, contentRange(ranges[0], entry.size));
+        addRange(ranges[0]);
+    } else {
+        static thread_local std::mt19937_64 rng(std::random_device{}());
+        char boundary[24];
+        snprintf(boundary, sizeof(boundary), "%016llx", static_cast<unsigned long long>(rng()));
+        resp->setContentType(std::string("multipart/byteranges; boundary=") + boundary);
+        for (const auto& range : ranges) {
+            addText(std::string("\r\n--") + boundary + "\r\nContent-Type: " + entry.mime_type +
+                    "\r\nContent-Range: " + contentRange(range, entry.size) + "\r\n\r\n");
+            addRange(range);
+        }
+        addText(std::string("\r\n--") + boundary + "--\r\n");
+    }
+    if (body) {
+        sendFileBody(body, resp);
+        return;
+    }
+    resp->setBody(buffered);
+    resp->setContentLength(resp->getBody().length());
+}
+
+// 从磁盘读出的文件内容及其压缩变体，缓存条目的视图指向这里
+struct StaticStorage {
+    std::string content;
+    std::shared_ptr<const PrecompressedCache::Variants> variants;
+
+    void attach(StaticFileCache::Entry* entry) const {
+        entry->has_content = true;
+        entry->content = content;
+        if (variants) {
+            entry->gzip = variants->gzip;
+            entry->brotli = variants->brotli;
+        }
+    }
+};
+
+// 解析请求路径对应的文件，生成其缓存条目
+// 内容只从页缓存读取；需要读盘时条目不带内容，*cacheable 置为 false，由发送路径交给磁盘线程
+// @return: 文件不存在或不允许访问时返回 nullptr；stat 或读文件失败时同时置 *io_error
+static std::shared_ptr<StaticFileCache::Entry> loadStaticEntry(const std::string& path, bool* io_error,
+                                                               bool* cacheable) {
+    auto safe_path_opt = HttpUtils::getSafeFilePath(base_path, path);
+    if (!safe_path_opt) return nullptr;
+
+    struct stat st;
+    if (::stat(safe_path_opt->c_str(), &st) != 0) {
+        *io_error = true;
+        return nullptr;
+    }
+    auto entry = std::make_shared<StaticFileCache::Entry>();
+    entry->file_path = *safe_path_opt;
+    // 使用MimeType类设置正确的Content-Type
+    entry->mime_type = MimeTypes::getMimeType(std::filesystem::path(entry->file_path).extension().string());
+    entry->size = st.st_size;
+    entry->mtime = st.st_mtime;
+    entry->compressible = MimeTypes::isCompressible(entry->mime_type) &&
+                          entry->size >= PrecompressedCache::kMinCompressSize;
+    // 验证器：强 ETag 由文件身份和修改时间生成，不需要读文件内容
+    entry->etag = HttpUtils::makeETag(st.st_ino, st.st_size, st.st_mtim, "");
+    entry->gzip_etag = HttpUtils::makeETag(st.st_ino, st.st_size, st.st_mtim, Compression::encodingName(Compression::kGzip));
+    entry->br_etag = HttpUtils::makeETag(st.st_ino, st.st_size, st.st_mtim, Compression::encodingName(Compression::kBrotli));
+    entry->last_modified = HttpUtils::formatHttpDate(st.st_mtime);
+    if (const std::string* cache_control = CacheControlPolicy::instance().lookup(path)) {
+        entry->cache_control = *cache_control;
+    }
+
+    const StaticFileCache& cache = StaticFileCache::instance();
+    if (cache.enabled() && entry->size <= cache.options().max_file_size) {
+        auto storage = std::make_shared<StaticStorage>();
+        bool would_block = false;
+        if (!readCachedFile(entry->file_path, entry->size, &storage->content, DiskIoPool::instance().enabled(),
+                            &would_block)) {
+            if (would_block) {
+                *cacheable = false;
+                return entry;
+            }
+            *io_error = true;
+            return nullptr;
+        }
+        if (entry->compressible) {
+            storage->variants = PrecompressedCache::instance().get(entry->file_path, entry->mtime, entry->size,
+                                                                   &storage->content);
+        }
+        storage->attach(entry.get());
+        entry->holder = storage;
+    }
+    return entry;
+}
+
+// 按条目发送静态文件，处理内容协商、条件请求和 Range
+static void sendStaticEntry(const HttpRequest& req, const StaticFileCache::Entry& entry, HttpResponse* resp) {
+    // 可压缩的资源按 Accept-Encoding 选择预压缩变体，响应随该头部变化，必须带 Vary
+    Compression::Encoding encoding = Compression::kIdentity;
+    if (entry.compressible) {
+        resp->addHeader(HttpResponse::kVary, "Accept-Encoding");
+        // Range 只作用于原文表示，带 Range 的请求不选择压缩变体
+        if (req.header(HttpRequest::kRange).empty()) {
+            encoding = Compression::negotiate(req.header(HttpRequest::kAcceptEncoding));
+        }
+    }
+
+    // 先确定要发送的表示（原文或某个压缩变体），ETag 与表示一一对应
+    // 内容未缓存时，变体已缓存则不必读源文件；第一次请求时读出源文件生成变体，
+    // 有磁盘线程时改为在后台生成，本次先发送原文
+    // 正文引用数据的持有者发送，不拷贝：缓存条目的 holder（编译进程序的资源为空），或本次读出的内容
+    StaticStorage loaded;
+    bool has_content = entry.has_content;
+    std::shared_ptr<const void> content_owner = entry.holder;
+    std::string_view content = entry.content;
+    std::shared_ptr<const void> variant_owner = entry.holder;
+    std::string_view variant;
+    if (encoding != Compression::kIdentity) {
+        if (has_content) {
+            variant = entry.variant(encoding);
+        } else {
+            loaded.variants = PrecompressedCache::instance().get(entry.file_path, entry.mtime, entry.size, nullptr);
+            if (!loaded.variants && DiskIoPool::instance().enabled()) {
+                PrecompressedCache::instance().buildAsync(entry.file_path, entry.mtime, entry.size);
+            } else if (!loaded.variants) {
+                if (!readFile(entry.file_path, &loaded.content)) {
+                    sendInternalError(resp);
+                    return;
+                }
+                loaded.variants = PrecompressedCache::instance().get(entry.file_path, entry.mtime, entry.size,
+                                                                     &loaded.content);
+                auto owned = std::make_shared<const std::string>(std::move(loaded.content));
+                has_content = true;
+                content = *owned;
+                content_owner = std::move(owned);
+            }
+            const std::string* found = loaded.variants ? loaded.variants->get(encoding) : nullptr;
+            if (found) {
+                variant = *found;
+                variant_owner = loaded.variants;
+            }
+        }
+    }
+    if (variant.empty()) encoding = Compression::kIdentity;
+
+    const std::string& etag = entry.etagFor(encoding);
+    resp->addHeader(HttpResponse::kETag, etag);
+    resp->addHeader(HttpResponse::kLastModified, entry.last_modified);
+    resp->addHeader(HttpResponse::kAcceptRanges, "bytes");
+    if (!entry.cache_control.empty()) {
+        resp->addHeader(HttpResponse::kCacheControl, entry.cache_control);
+    }
+
+    // RFC 9110 13.2.2：If-None-Match 存在时忽略 If-Modified-Since
+    std::string_view if_none_match = req.header(HttpRequest::kIfNoneMatch);
+    bool not_modified = false;
+    if (!if_none_match.empty()) {
+        not_modified = HttpUtils::etagMatches(if_none_match, etag);
+    } else if (!req.header(HttpRequest::kIfModifiedSince).empty()) {
+        time_t since = HttpUtils::parseHttpDate(req.header(HttpRequest::kIfModifiedSince));
+        not_modified = since != -1 && entry.mtime <= since;
+    }
+    if (not_modified) {
+        // 304 不带正文，只返回验证器和缓存相关的头部
+        resp->setStatusCode(HttpResponse::k304NotModified);
+        return;
+    }
+
+    // If-Range 不匹配时忽略 Range，返回完整的新内容
+    std::string_view range = req.header(HttpRequest::kRange);
+    if (variant.empty() && !range.empty() && ifRangeMatches(req.header(HttpRequest::kIfRange), etag, entry.mtime)) {
+        std::vector<HttpUtils::ByteRange> ranges;
+        switch (HttpUtils::parseRange(range, entry.size, &ranges)) {
+        case HttpUtils::kRangeSatisfiable:
+            sendRanges(entry, ranges, resp);
+            return;
+        case HttpUtils::kRangeUnsatisfiable:
+            resp->setStatusCode(HttpResponse::k416RangeNotSatisfiable);
+            resp->addHeader(HttpResponse::kContentRange, "bytes */" + std::to_string(entry.size));
+            resp->setContentLength(0);
+            return;
+        case HttpUtils::kRangeIgnored:
+            break;
+        }
+    }
+
+    if (!variant.empty()) {
+        resp->setStatusCode(HttpResponse::k200Ok);
+        resp->setContentType(entry.mime_type);
+        resp->addHeader(HttpResponse::kContentEncoding, Compression::encodingName(encoding));
+        resp->setBody(SharedBuffer(variant_owner, variant));
+        resp->setContentLength(variant.size());
+        return;
+    }
+    if (!has_content) {
+        // 文件按需从映射中取出，不整体读入内存；未缓存的部分由磁盘线程读入
+        std::shared_ptr<FileBody> body = FileBody::open(entry.file_path);
+        if (!body) {
+            sendInternalError(resp);
+            return;
+        }
+        if (!body->addRange(0, entry.size)) {
+            sendInternalError(resp);
+            return;
+        }
+        resp->setStatusCode(HttpResponse::k200Ok);
+        resp->setContentType(entry.mime_type);
+        sendFileBody(body, resp);
+        return;
+    }
+    resp->setStatusCode(HttpResponse::k200Ok);
+    resp->setStatusMessage("OK");
+    resp->setContentType(entry.mime_type);
+    resp->setBody(SharedBuffer(content_owner, content));
+    resp->setContentLength(content.size());
+}
+
 // 处理静态文件请求 (通配)
 void handleStaticFile(const HttpRequest& req, HttpResponse* resp) {
     std::string path = req.getPath();
@@ -84,9 +432,30 @@ void handleStaticFile(const HttpRequest& req, HttpResponse* resp) {
         path = "/index.html";
     }
 
-    auto safe_path_opt = HttpUtils::getSafeFilePath(base_path, path);
+    // 编译进程序的资源优先，未打包的路径仍从磁盘查找
+    if (std::shared_ptr<const StaticFileCache::Entry> asset = EmbeddedAssets::instance().lookup(path)) {
+        sendStaticEntry(req, *asset, resp);
+        return;
+    }
 
-    if (!safe_path_opt) {
+    StaticFileCache& cache = StaticFileCache::instance();
+    if (cache.enabled()) {
+        if (std::shared_ptr<const StaticFileCache::Entry> entry = cache.lookup(path)) {
+            sendStaticEntry(req, *entry, resp);
+            return;
+        }
+    }
+
+    // 在解析文件之前取得代数，解析期间文件发生变化时本次结果不进入缓存
+    uint64_t generation = cache.generation();
+    bool io_error = false;
+    bool cacheable = true;
+    std::shared_ptr<StaticFileCache::Entry> entry = loadStaticEntry(path, &io_error, &cacheable);
+    if (io_error) {
+        sendInternalError(resp);
+        return;
+    }
+    if (!entry) {
         // 如果静态文件找不到，我们也可以调用 handleNotFound
         // 但这里为了清晰，直接构建404响应
         resp->setStatusCode(HttpResponse::k404NotFound);
@@ -95,30 +464,10 @@ void handleStaticFile(const HttpRequest& req, HttpResponse* resp) {
         resp->setContentLength(resp->getBody().length());
         return;
     }
-    
-    std::string file_path = *safe_path_opt;
-
-    std::ifstream file(file_path, std::ios::in | std::ios::binary);
-    if(file){
-        // 使用stringstream读取整个文件内容
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        file.close();
-        resp->setStatusCode(HttpResponse::k200Ok);
-        resp->setStatusMessage("OK");
-        // 使用MimeType类设置正确的Content-Type
-        std::filesystem::path fs_path(file_path);
-        resp->setContentType(MimeTypes::getMimeType(fs_path.extension().string()));
-        resp->setBody(buffer.str());
-        resp->setContentLength(resp->getBody().length());
-    }else{
-        // 文件存在但是存在读取错误
-        resp->setStatusCode(HttpResponse::k500InternalServerError);
-        resp->setStatusMessage("Internal Server Error");
-        resp->setContentType("text/html; charset=utf-8"); // 简化处理
-        resp->setBody("<html><body><h1>500 Internal Server Error</h1></body></html>");
-        resp->setContentLength(resp->getBody().length());
+    if (cache.enabled() && cacheable) {
+        cache.insert(path, entry, generation);
     }
+    sendStaticEntry(req, *entry, resp);
 }
 REGISTER_HANDLER("static", handleStaticFile); // 自动注册
 } // namespace Handlers
\ No newline at end of file
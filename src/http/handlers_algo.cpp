@@ -1,6 +1,11 @@
 #include "http/handlers.h"
+#include "http/multipart_parser.h"
+#include "http/dynamic_compression.h"
+#include "http/overload_controller.h"
+#include "http/websocket.h"
 #include "http_utils.h"
 #include "http_request.h"
+#include "net/event_loop.h"
 #include "utils/logger.h"
 #include "utils/json.hpp" // 引入 json 库
 #include "db_engine.h" // 引入数据库引擎
@@ -18,23 +23,23 @@ std::mutex data_mutex; // 简单的文件读写锁
 
 namespace Handlers {
 
-// 辅助函数：解析查询字符串为 map
-std::map<std::string, std::string> parseQueryString(const std::string& query) {
-    std::map<std::string, std::string> params;
-    std::string key, value;
-    size_t start = 0, end;
-    while (start < query.length()) {
-        end = query.find('=', start);
-        if (end == std::string::npos) break;
-        key = HttpRequest::urlDecode(query.substr(start, end - start));
-        start = end + 1;
-        end = query.find('&', start);
-        if (end == std::string::npos) end = query.length();
-        value = HttpRequest::urlDecode(query.substr(start, end - start));
-        params[key] = value;
-        start = end + 1;
-    }
-    return params;
+// 题目列表变化的推送主题，消息为 JSON：
+// {"type": "added" | "updated", "problem": {列表项字段}}、{"type": "deleted", "id": N}、{"type": "reload"}（批量变化）
+const char kProblemTopic[] = "problems";
+
+// 列表页需要的字段，与 GET /api/problems 的列表项一致（收藏状态因人而异，不推送）
+json problemSummary(const json& p) {
+    return {
+        {"id", p.value("id", 0)},
+        {"title", p.value("title", "无标题")},
+        {"difficulty", p.value("difficulty", "Easy")},
+        {"algorithm", p.value("algorithm", "")},
+        {"tags", p.value("tags", json::array())}
+    };
+}
+
+void publishProblemEvent(const json& event) {
+    WebSocketHub::instance().publish(kProblemTopic, event.dump());
 }
 
 // 辅助函数：去除字符串首尾空白
@@ -47,7 +52,7 @@ std::string trimString(const std::string& str) {
 }
 
 // 分割函数：支持英文逗号 ',' 和中文逗号 "，"
-std::vector<std::string> splitAndTrim(const std::string& str) {
+std::vector<std::string> splitAndTrim(std::string_view str) {
     std::vector<std::string> tokens;
     std::string current_token;
     
@@ -102,15 +107,15 @@ void handleGetProblems(const HttpRequest& req, HttpResponse* resp) {
     }
 
     // 2. 解析查询参数
-    auto queryParams = parseQueryString(req.getQuery());
-    std::string search_term = queryParams["search"];
-    std::string tag_filter = queryParams["tag"];
+    const UrlParams& query = req.queryParams();
+    std::string_view search_term = query.get("search");
+    std::string_view tag_filter = query.get("tag");
     int filter_fav_id = -1;
-    if (queryParams.count("fav_id") && !queryParams["fav_id"].empty()) {
-        filter_fav_id = std::stoi(queryParams["fav_id"]);
+    if (!query.get("fav_id").empty()) {
+        filter_fav_id = std::stoi(std::string(query.get("fav_id")));
     }
-    int limit = queryParams.count("limit") ? std::stoi(queryParams["limit"]) : 20;
-    int offset = queryParams.count("offset") ? std::stoi(queryParams["offset"]) : 0;
+    int limit = query.has("limit") ? std::stoi(std::string(query.get("limit"))) : 20;
+    int offset = query.has("offset") ? std::stoi(std::string(query.get("offset"))) : 0;
 
     // 3. 准备收藏夹过滤数据
     std::set<int> fav_problem_ids;
@@ -147,13 +152,19 @@ void handleGetProblems(const HttpRequest& req, HttpResponse* resp) {
     
     // 搜索 ID 逻辑
     bool is_id_search = !search_term.empty() && std::all_of(search_term.begin(), search_term.end(), ::isdigit);
-    int search_id = is_id_search ? std::stoi(search_term) : -1;
+    int search_id = is_id_search ? std::stoi(std::string(search_term)) : -1;
 
     // 注意：id_list 中的顺序可能不是有序的（取决于插入顺序），如果需要排序可以在这里 sort
     // std::sort(id_list.begin(), id_list.end()); 
 
+    size_t scanned = 0;
     for (auto& id_val : id_list) {
         int pid = id_val.get<int>();
+        // 逐条查库较慢，超过路由的处理期限时客户端多半已经放弃，不再继续（每 64 条检查一次时间）
+        if ((++scanned & 63) == 0 && req.deadlineExceeded()) {
+            OverloadController::instance().reject(resp);
+            return;
+        }
         
         // 5.1 收藏夹 ID 过滤 (快速过滤，无需查 DB)
         if (filter_fav_id != -1) {
@@ -289,7 +300,7 @@ void handleGetFavorites(const HttpRequest& req, HttpResponse* resp) {
 // 创建收藏夹
 // POST /api/favorites/create (name=xxx)
 void handleCreateFavorite(const HttpRequest& req, HttpResponse* resp) {
-    std::string name = req.getPostValue("name");
+    std::string_view name = req.formParams().get("name");
     if (name.empty()) {
         resp->setStatusCode(HttpResponse::k400BadRequest);
         resp->setBody("{\"error\": \"Name is required\"}");
@@ -332,8 +343,9 @@ void handleCreateFavorite(const HttpRequest& req, HttpResponse* resp) {
 // 添加题目到收藏夹
 // POST /api/favorites/add (fav_id=1&problem_id=5)
 void handleAddToFavorite(const HttpRequest& req, HttpResponse* resp) {
-    std::string fav_id_str = req.getPostValue("fav_id");
-    std::string prob_id_str = req.getPostValue("problem_id");
+    const UrlParams& form = req.formParams();
+    std::string_view fav_id_str = form.get("fav_id");
+    std::string_view prob_id_str = form.get("problem_id");
 
     if (fav_id_str.empty() || prob_id_str.empty()) {
         resp->setStatusCode(HttpResponse::k400BadRequest);
@@ -341,9 +353,9 @@ void handleAddToFavorite(const HttpRequest& req, HttpResponse* resp) {
         return;
     }
 
-    int fav_id = std::stoi(fav_id_str);
-    int prob_id = std::stoi(prob_id_str);
-    std::string key = "fav:" + fav_id_str;
+    int fav_id = std::stoi(std::string(fav_id_str));
+    int prob_id = std::stoi(std::string(prob_id_str));
+    std::string key = "fav:" + std::string(fav_id_str);
 
     // 加锁，保护读-改-写过程
     std::lock_guard<std::mutex> lock(data_mutex);
@@ -396,15 +408,16 @@ void handleAddToFavorite(const HttpRequest& req, HttpResponse* resp) {
 // POST /api/favorites/remove
 // 参数: problem_id (必填), fav_id (选填，不填或-1表示全部移除)
 void handleRemoveFromFavorite(const HttpRequest& req, HttpResponse* resp) {
-    std::string prob_id_str = req.getPostValue("problem_id");
+    const UrlParams& form = req.formParams();
+    std::string_view prob_id_str = form.get("problem_id");
     if (prob_id_str.empty()) {
         resp->setStatusCode(HttpResponse::k400BadRequest);
         return;
     }
-    int prob_id = std::stoi(prob_id_str);
+    int prob_id = std::stoi(std::string(prob_id_str));
 
-    std::string fav_id_str = req.getPostValue("fav_id");
-    int target_fav_id = fav_id_str.empty() ? -1 : std::stoi(fav_id_str);
+    std::string_view fav_id_str = form.get("fav_id");
+    int target_fav_id = fav_id_str.empty() ? -1 : std::stoi(std::string(fav_id_str));
 
     std::lock_guard<std::mutex> lock(data_mutex);
 
@@ -492,7 +505,7 @@ void handleGetProblemDetail(const HttpRequest& req, HttpResponse* resp) {
         LOG_ERROR << "No route params found for detail request";
         resp->setStatusCode(HttpResponse::k400BadRequest); return;
     }
-    std::string id_str = params[0];
+    std::string id_str(params[0]);
     
     // 构造 Key
     std::string key = "problem:" + id_str;
@@ -520,15 +533,16 @@ void handleGetProblemDetail(const HttpRequest& req, HttpResponse* resp) {
 void handleAddProblem(const HttpRequest& req, HttpResponse* resp) {
     LOG_INFO << "Handling Add Problem...";
     
-    // 获取 POST 参数
-    std::string title = req.getPostValue("title");
-    std::string difficulty = req.getPostValue("difficulty");
-    std::string desc = req.getPostValue("description");
-    std::string algo = req.getPostValue("algorithm");
-    std::string idea = req.getPostValue("solution_idea");
-    std::string time = req.getPostValue("time_complexity");
-    std::string space = req.getPostValue("space_complexity");
-    std::string code = req.getPostValue("code");
+    // 获取 POST 参数，视图指向请求正文，写入数据库时才拷贝
+    const UrlParams& form = req.formParams();
+    std::string_view title = form.get("title");
+    std::string_view difficulty = form.get("difficulty");
+    std::string_view desc = form.get("description");
+    std::string_view algo = form.get("algorithm");
+    std::string_view idea = form.get("solution_idea");
+    std::string_view time = form.get("time_complexity");
+    std::string_view space = form.get("space_complexity");
+    std::string_view code = form.get("code");
 
     if (title.empty()) {
         resp->setStatusCode(HttpResponse::k400BadRequest);
@@ -546,6 +560,7 @@ void handleAddProblem(const HttpRequest& req, HttpResponse* resp) {
         }
     }
 
+    json added;
     {
         std::lock_guard<std::mutex> lock(data_mutex); // 加锁
 
@@ -572,6 +587,7 @@ void handleAddProblem(const HttpRequest& req, HttpResponse* resp) {
             {"tags", tags} 
         };
         g_db->Put("problem:" + std::to_string(new_id), new_problem.dump());
+        added = problemSummary(new_problem);
 
         // 4. 更新 ID 索引列表
         std::string ids_str;
@@ -586,6 +602,7 @@ void handleAddProblem(const HttpRequest& req, HttpResponse* resp) {
         
         LOG_INFO << "Added problem ID: " << new_id;
     } // 解锁
+    publishProblemEvent({{"type", "added"}, {"problem", added}});
 
     // 返回 302 重定向
     resp->setStatusCode(HttpResponse::k302Found);
@@ -595,8 +612,8 @@ void handleAddProblem(const HttpRequest& req, HttpResponse* resp) {
 
 // 前端可以通过 AJAX POST 发送一个 ID 来删除
 void handleDeleteProblem(const HttpRequest& req, HttpResponse* resp) {
-    std::string id_str = req.getPostValue("id");
-    int id = std::stoi(id_str);
+    std::string_view id_str = req.formParams().get("id");
+    int id = std::stoi(std::string(id_str));
     if (id_str.empty()) {
         resp->setStatusCode(HttpResponse::k400BadRequest);
         return;
@@ -604,7 +621,7 @@ void handleDeleteProblem(const HttpRequest& req, HttpResponse* resp) {
     std::lock_guard<std::mutex> lock(data_mutex);
         
     // 1. 删除题目数据
-    if (g_db->Delete("problem:" + id_str) == TFDB::kSuccess) {
+    if (g_db->Delete("problem:" + std::string(id_str)) == TFDB::kSuccess) {
         // 2. 从 ID 列表中移除
         std::string ids_str;
         if (g_db->Get("sys:problem_ids", &ids_str) == TFDB::kSuccess) {
@@ -658,6 +675,7 @@ void handleDeleteProblem(const HttpRequest& req, HttpResponse* resp) {
         }
 
         LOG_INFO << "Deleted problem ID: " << id;
+        publishProblemEvent({{"type", "deleted"}, {"id", id}});
         resp->setStatusCode(HttpResponse::k200Ok);
         resp->setBody("{\"status\": \"deleted\"}");
     } else {
@@ -683,8 +701,9 @@ void handleAddQuestion(const HttpRequest& req, HttpResponse* resp) {
 // API: 修改题目
 // POST /api/problems/update
 void handleUpdateProblem(const HttpRequest& req, HttpResponse* resp) {
-    std::string id_str = req.getPostValue("id");
-    std::string new_algo = req.getPostValue("algorithm");
+    const UrlParams& form = req.formParams();
+    std::string id_str(form.get("id")); // 还用于拼接数据库 key 和重定向地址
+    std::string_view new_algo = form.get("algorithm");
     if (id_str.empty()) {
         resp->setStatusCode(HttpResponse::k400BadRequest);
         return;
@@ -692,14 +711,13 @@ void handleUpdateProblem(const HttpRequest& req, HttpResponse* resp) {
     int id = std::stoi(id_str);
 
     // 获取其他字段
-    std::string title = req.getPostValue("title");
-    std::string difficulty = req.getPostValue("difficulty");
-    std::string desc = req.getPostValue("description");
-    std::string algo = req.getPostValue("algorithm");
-    std::string idea = req.getPostValue("solution_idea");
-    std::string time = req.getPostValue("time_complexity");
-    std::string space = req.getPostValue("space_complexity");
-    std::string code = req.getPostValue("code");
+    std::string_view title = form.get("title");
+    std::string_view difficulty = form.get("difficulty");
+    std::string_view desc = form.get("description");
+    std::string_view idea = form.get("solution_idea");
+    std::string_view time = form.get("time_complexity");
+    std::string_view space = form.get("space_complexity");
+    std::string_view code = form.get("code");
 
     std::string key = "problem:" + id_str;
     std::string val;
@@ -764,6 +782,7 @@ void handleUpdateProblem(const HttpRequest& req, HttpResponse* resp) {
         // 3. 写回数据库
         g_db->Put(key, p.dump());
         LOG_INFO << "Updated problem ID: " << id;
+        publishProblemEvent({{"type", "updated"}, {"problem", problemSummary(p)}});
 
         // 重定向回详情页
         resp->setStatusCode(HttpResponse::k302Found);
@@ -776,6 +795,269 @@ void handleUpdateProblem(const HttpRequest& req, HttpResponse* resp) {
     }
 }
 
+// API: 批量导入题目
+// POST /api/problems/import
+// 请求体为 NDJSON（每行一个题目对象，字段与添加题目的表单相同），可以直接上传，
+// 也可以作为 multipart/form-data 的文件字段上传；按行边接收边写入数据库，不缓存整个上传内容
+class ProblemImportReader : public BodyReader {
+public:
+    explicit ProblemImportReader(const HttpRequest& req) {
+        std::string boundary = MultipartParser::boundaryFromContentType(req.header(HttpRequest::kContentType));
+        if (boundary.empty()) return;
+        multipart_ = std::make_unique<MultipartParser>(boundary);
+        multipart_->setPartBeginCallback([this](const MultipartParser::Part& part) {
+            in_file_part_ = !part.filename.empty() || part.name == "file";
+            return true;
+        });
+        multipart_->setPartDataCallback([this](const char* data, size_t len) {
+            return !in_file_part_ || consume(data, len);
+        });
+        multipart_->setPartEndCallback([this]() {
+            return !in_file_part_ || importLine();
+        });
+    }
+
+    // 上传中途断开时，已写入的题目也要进入索引
+    ~ProblemImportReader() override { commitIds(); }
+
+    bool onBody(const char* data, size_t len) override {
+        if (!multipart_) return consume(data, len);
+        if (!multipart_->feed(data, len)) {
+            return error_.empty() ? fail(HttpResponse::k400BadRequest, "Malformed multipart body") : false;
+        }
+        return true;
+    }
+
+    void onComplete(const HttpRequest&, HttpResponse* resp) override {
+        if (error_.empty()) {
+            if (multipart_ && !multipart_->finished()) {
+                fail(HttpResponse::k400BadRequest, "Malformed multipart body");
+            } else if (!multipart_) {
+                importLine(); // 最后一行可能没有换行符
+            }
+        }
+        commitIds();
+
+        json result = {{"imported", imported_}};
+        if (!error_.empty()) {
+            result["error"] = error_;
+            resp->setStatusCode(error_status_);
+        } else {
+            resp->setStatusCode(HttpResponse::k200Ok);
+        }
+        resp->setContentType("application/json; charset=utf-8");
+        resp->setBody(result.dump());
+        resp->setContentLength(resp->getBody().length());
+    }
+
+private:
+    // 单行的长度上限，也就是导入时为一个请求缓存的最大数据量
+    static const size_t kMaxLineSize = 64 * 1024;
+
+    bool fail(HttpResponse::HttpStatusCode status, const std::string& message) {
+        error_status_ = status;
+        error_ = message;
+        LOG_WARN << "Problem import aborted at line " << line_no_ << ": " << message;
+        return false;
+    }
+
+    bool consume(const char* data, size_t len) {
+        const char* end = data + len;
+        while (data < end) {
+            const char* eol = std::find(data, end, '\n');
+            if (line_.size() + (eol - data) > kMaxLineSize) {
+                return fail(HttpResponse::k413PayloadTooLarge, "Line too long");
+            }
+            line_.append(data, eol);
+            if (eol == end) break;
+            if (!importLine()) return false;
+            data = eol + 1;
+        }
+        return true;
+    }
+
+    bool importLine() {
+        ++line_no_;
+        std::string line = trimString(line_);
+        line_.clear();
+        if (line.empty()) return true;
+
+        json item = json::parse(line, nullptr, false);
+        if (item.is_discarded() || !item.is_object()) {
+            return fail(HttpResponse::k400BadRequest, "Invalid JSON at line " + std::to_string(line_no_));
+        }
+        std::string title = item.value("title", "");
+        if (title.empty()) {
+            return fail(HttpResponse::k400BadRequest, "Title cannot be empty at line " + std::to_string(line_no_));
+        }
+        std::string algo = item.value("algorithm", "");
+        json tags = json::array();
+        tags.push_back("New"); // 默认标签
+        for (const auto& a : splitAndTrim(algo)) {
+            tags.push_back(a);
+        }
+
+        std::lock_guard<std::mutex> lock(data_mutex);
+        std::string max_id_str;
+        int new_id = 1;
+        if (g_db->Get("sys:next_problem_id", &max_id_str) == TFDB::kSuccess) {
+            new_id = std::stoi(max_id_str) + 1;
+        }
+        g_db->Put("sys:next_problem_id", std::to_string(new_id));
+
+        json new_problem = {
+            {"id", new_id},
+            {"title", title},
+            {"difficulty", item.value("difficulty", "")},
+            {"description", item.value("description", "")},
+            {"algorithm", algo},
+            {"solution_idea", item.value("solution_idea", "")},
+            {"time_complexity", item.value("time_complexity", "")},
+            {"space_complexity", item.value("space_complexity", "")},
+            {"code", item.value("code", "")},
+            {"tags", tags}
+        };
+        g_db->Put("problem:" + std::to_string(new_id), new_problem.dump());
+        pending_ids_.push_back(new_id);
+        ++imported_;
+        return true;
+    }
+
+    // ID 索引列表整体读写，攒到最后一次性更新
+    void commitIds() {
+        if (pending_ids_.empty()) return;
+        std::lock_guard<std::mutex> lock(data_mutex);
+        std::string ids_str;
+        json id_list = json::array();
+        if (g_db->Get("sys:problem_ids", &ids_str) == TFDB::kSuccess) {
+            id_list = json::parse(ids_str);
+        }
+        for (int id : pending_ids_) {
+            id_list.push_back(id);
+        }
+        g_db->Put("sys:problem_ids", id_list.dump());
+        LOG_INFO << "Imported " << pending_ids_.size() << " problems";
+        pending_ids_.clear();
+        publishProblemEvent({{"type", "reload"}});
+    }
+
+    std::unique_ptr<MultipartParser> multipart_;
+    bool in_file_part_ = false;
+    std::string line_;
+    int line_no_ = 0;
+    int imported_ = 0;
+    std::vector<int> pending_ids_;
+    std::string error_;
+    HttpResponse::HttpStatusCode error_status_ = HttpResponse::k400BadRequest;
+};
+
+std::unique_ptr<BodyReader> createProblemImportReader(const HttpRequest& req) {
+    return std::make_unique<ProblemImportReader>(req);
+}
+
+// API: 导出全部题目
+// GET /api/problems/export
+// 响应为 NDJSON（每行一个题目对象），格式与批量导入相同；按批从数据库读出并流式发送，不在内存中拼出整个正文
+void handleExportProblems(const HttpRequest&, HttpResponse* resp) {
+    // 只对导出开始时的 ID 列表做快照，导出期间新增的题目不包含在内
+    auto ids = std::make_shared<std::vector<int>>();
+    {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        std::string ids_str;
+        if (g_db->Get("sys:problem_ids", &ids_str) == TFDB::kSuccess) {
+            json id_list = json::parse(ids_str, nullptr, false);
+            if (id_list.is_array()) {
+                for (const auto& id : id_list) ids->push_back(id.get<int>());
+            }
+        }
+    }
+
+    resp->setStatusCode(HttpResponse::k200Ok);
+    resp->setContentType("application/x-ndjson; charset=utf-8");
+    resp->addHeader("Content-Disposition", "attachment; filename=\"problems.ndjson\"");
+
+    // 每次调用写出一批题目，约 16KB 后让出，由连接按输出缓冲区的余量再次调用
+    const size_t kBatchBytes = 16 * 1024;
+    size_t next = 0;
+    resp->setBodyProducer([ids, next](Buffer* buf) mutable {
+        size_t written = 0;
+        std::string value;
+        while (next < ids->size() && written < kBatchBytes) {
+            TFDB::Status s;
+            {
+                std::lock_guard<std::mutex> lock(data_mutex);
+                s = g_db->Get("problem:" + std::to_string((*ids)[next]), &value);
+            }
+            ++next;
+            if (s != TFDB::kSuccess) continue; // 导出期间被删除的题目
+            buf->append(value);
+            buf->append("\n", 1);
+            written += value.size() + 1;
+        }
+        return next < ids->size();
+    });
+}
+
+// GET /api/compression/stats
+// 各路由动态压缩的压缩率和 CPU 耗时，用于调整 [compression] 中的阈值
+void handleCompressionStats(const HttpRequest&, HttpResponse* resp) {
+    json routes = json::array();
+    for (const auto& pair : DynamicCompression::instance().snapshot()) {
+        const DynamicCompression::RouteStats& stats = pair.second;
+        routes.push_back({
+            {"route", pair.first},
+            {"compressed", stats.compressed},
+            {"fast", stats.fast},
+            {"skipped_busy", stats.skipped_busy},
+            {"bytes_in", stats.bytes_in},
+            {"bytes_out", stats.bytes_out},
+            {"ratio", stats.bytes_in ? static_cast<double>(stats.bytes_out) / stats.bytes_in : 0.0},
+            {"cpu_ms", stats.cpu_ns / 1e6},
+            // 每 MB 输入消耗的 CPU 毫秒数
+            {"cpu_ms_per_mb", stats.bytes_in ? stats.cpu_ns / 1e6 / (stats.bytes_in / 1048576.0) : 0.0}
+        });
+    }
+    const DynamicCompression::Options& options = DynamicCompression::instance().options();
+    json response_data = {
+        {"enabled", options.enabled},
+        {"min_size", options.min_size},
+        {"fast_load", options.fast_load},
+        {"off_load", options.off_load},
+        {"routes", routes}
+    };
+
+    resp->setStatusCode(HttpResponse::k200Ok);
+    resp->setContentType("application/json; charset=utf-8");
+    resp->setBody(response_data.dump());
+    resp->setContentLength(resp->getBody().length());
+}
+
+// GET /api/overload/stats
+// 过载保护拒绝的请求数，以及处理本请求的 I/O 线程当前的事件延迟，用于调整 [overload] 中的阈值
+void handleOverloadStats(const HttpRequest&, HttpResponse* resp) {
+    const OverloadController& controller = OverloadController::instance();
+    EventLoop* loop = EventLoop::getEventLoopOfCurrentThread();
+    json response_data = {
+        {"enabled", controller.options().enabled},
+        {"max_lag_ms", controller.options().max_lag * 1000},
+        {"lag_ms", loop ? loop->eventLag() * 1000 : 0.0},
+        {"expired", controller.expiredCount()},
+        {"shed", controller.shedCount()}
+    };
+
+    resp->setStatusCode(HttpResponse::k200Ok);
+    resp->setContentType("application/json; charset=utf-8");
+    resp->setBody(response_data.dump());
+    resp->setContentLength(resp->getBody().length());
+}
+
+// GET /ws/problems (WebSocket)
+// 题目被添加、修改、删除或批量导入时推送变化（格式见 kProblemTopic），列表页据此就地更新，不必重新拉取整个列表
+// 客户端发来的消息忽略
+void handleProblemFeed(const HttpRequest& req, HttpResponse* resp) {
+    WebSocketSession::accept(req, resp, kProblemTopic);
+}
+
 } // namespace Handlers
 
 // 注册路由
@@ -790,4 +1072,9 @@ REGISTER_HANDLER("api_get_all_tags", handleGetAllTags);
 REGISTER_HANDLER("api_get_favorites", handleGetFavorites);
 REGISTER_HANDLER("api_create_favorite", handleCreateFavorite);
 REGISTER_HANDLER("api_add_to_favorite", handleAddToFavorite);
-REGISTER_HANDLER("api_remove_from_favorite", handleRemoveFromFavorite);
\ No newline at end of file
+REGISTER_HANDLER("api_remove_from_favorite", handleRemoveFromFavorite);
+REGISTER_HANDLER("api_export_problems", handleExportProblems);
+REGISTER_HANDLER("api_compression_stats", handleCompressionStats);
+REGISTER_HANDLER("api_overload_stats", handleOverloadStats);
+REGISTER_HANDLER("ws_problems", handleProblemFeed);
+REGISTER_BODY_READER("api_import_problems", createProblemImportReader);
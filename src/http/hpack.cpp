@@ -0,0 +1,359 @@
+#include "http/hpack.h"
+#include <unordered_map>
+#include <memory>
+
+namespace {
+
+struct StaticEntry {
+    const char* name;
+    const char* value;
+};
+
+struct HuffmanCode {
+    uint32_t code;
+    uint8_t bits;
+};
+
+const size_t kStaticTableSize = 61;
+// 每个动态表条目的额外开销（RFC 7541 4.1）
+const size_t kEntryOverhead = 32;
+
+// RFC 7541 附录 A：静态表（索引从 1 开始）
+const StaticEntry kStaticTable[kStaticTableSize] = {
+    {":authority", ""},
+    {":method", "GET"},
+    {":method", "POST"},
+    {":path", "/"},
+    {":path", "/index.html"},
+    {":scheme", "http"},
+    {":scheme", "https"},
+    {":status", "200"},
+    {":status", "204"},
+    {":status", "206"},
+    {":status", "304"},
+    {":status", "400"},
+    {":status", "404"},
+    {":status", "500"},
+    {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""},
+    {"accept-ranges", ""},
+    {"accept", ""},
+    {"access-control-allow-origin", ""},
+    {"age", ""},
+    {"allow", ""},
+    {"authorization", ""},
+    {"cache-control", ""},
+    {"content-disposition", ""},
+    {"content-encoding", ""},
+    {"content-language", ""},
+    {"content-length", ""},
+    {"content-location", ""},
+    {"content-range", ""},
+    {"content-type", ""},
+    {"cookie", ""},
+    {"date", ""},
+    {"etag", ""},
+    {"expect", ""},
+    {"expires", ""},
+    {"from", ""},
+    {"host", ""},
+    {"if-match", ""},
+    {"if-modified-since", ""},
+    {"if-none-match", ""},
+    {"if-range", ""},
+    {"if-unmodified-since", ""},
+    {"last-modified", ""},
+    {"link", ""},
+    {"location", ""},
+    {"max-forwards", ""},
+    {"proxy-authenticate", ""},
+    {"proxy-authorization", ""},
+    {"range", ""},
+    {"referer", ""},
+    {"refresh", ""},
+    {"retry-after", ""},
+    {"server", ""},
+    {"set-cookie", ""},
+    {"strict-transport-security", ""},
+    {"transfer-encoding", ""},
+    {"user-agent", ""},
+    {"vary", ""},
+    {"via", ""},
+    {"www-authenticate", ""},
+};
+
+// RFC 7541 附录 B：Huffman 编码表 {码字, 位数}，下标为符号，256 为 EOS
+const HuffmanCode kHuffmanTable[257] = {
+    {0x1ff8, 13}, {0x7fffd8, 23}, {0xfffffe2, 28}, {0xfffffe3, 28}, {0xfffffe4, 28},
+    {0xfffffe5, 28}, {0xfffffe6, 28}, {0xfffffe7, 28}, {0xfffffe8, 28}, {0xffffea, 24},
+    {0x3ffffffc, 30}, {0xfffffe9, 28}, {0xfffffea, 28}, {0x3ffffffd, 30}, {0xfffffeb, 28},
+    {0xfffffec, 28}, {0xfffffed, 28}, {0xfffffee, 28}, {0xfffffef, 28}, {0xffffff0, 28},
+    {0xffffff1, 28}, {0xffffff2, 28}, {0x3ffffffe, 30}, {0xffffff3, 28}, {0xffffff4, 28},
+    {0xffffff5, 28}, {0xffffff6, 28}, {0xffffff7, 28}, {0xffffff8, 28}, {0xffffff9, 28},
+    {0xffffffa, 28}, {0xffffffb, 28}, {0x14, 6}, {0x3f8, 10}, {0x3f9, 10}, {0xffa, 12},
+    {0x1ff9, 13}, {0x15, 6}, {0xf8, 8}, {0x7fa, 11}, {0x3fa, 10}, {0x3fb, 10}, {0xf9, 8},
+    {0x7fb, 11}, {0xfa, 8}, {0x16, 6}, {0x17, 6}, {0x18, 6}, {0x0, 5}, {0x1, 5}, {0x2, 5},
+    {0x19, 6}, {0x1a, 6}, {0x1b, 6}, {0x1c, 6}, {0x1d, 6}, {0x1e, 6}, {0x1f, 6}, {0x5c, 7},
+    {0xfb, 8}, {0x7ffc, 15}, {0x20, 6}, {0xffb, 12}, {0x3fc, 10}, {0x1ffa, 13}, {0x21, 6},
+    {0x5d, 7}, {0x5e, 7}, {0x5f, 7}, {0x60, 7}, {0x61, 7}, {0x62, 7}, {0x63, 7}, {0x64, 7},
+    {0x65, 7}, {0x66, 7}, {0x67, 7}, {0x68, 7}, {0x69, 7}, {0x6a, 7}, {0x6b, 7}, {0x6c, 7},
+    {0x6d, 7}, {0x6e, 7}, {0x6f, 7}, {0x70, 7}, {0x71, 7}, {0x72, 7}, {0xfc, 8}, {0x73, 7},
+    {0xfd, 8}, {0x1ffb, 13}, {0x7fff0, 19}, {0x1ffc, 13}, {0x3ffc, 14}, {0x22, 6}, {0x7ffd, 15},
+    {0x3, 5}, {0x23, 6}, {0x4, 5}, {0x24, 6}, {0x5, 5}, {0x25, 6}, {0x26, 6}, {0x27, 6}, {0x6, 5},
+    {0x74, 7}, {0x75, 7}, {0x28, 6}, {0x29, 6}, {0x2a, 6}, {0x7, 5}, {0x2b, 6}, {0x76, 7},
+    {0x2c, 6}, {0x8, 5}, {0x9, 5}, {0x2d, 6}, {0x77, 7}, {0x78, 7}, {0x79, 7}, {0x7a, 7}, {0x7b, 7},
+    {0x7ffe, 15}, {0x7fc, 11}, {0x3ffd, 14}, {0x1ffd, 13}, {0xffffffc, 28}, {0xfffe6, 20},
+    {0x3fffd2, 22}, {0xfffe7, 20}, {0xfffe8, 20}, {0x3fffd3, 22}, {0x3fffd4, 22}, {0x3fffd5, 22},
+    {0x7fffd9, 23}, {0x3fffd6, 22}, {0x7fffda, 23}, {0x7fffdb, 23}, {0x7fffdc, 23}, {0x7fffdd, 23},
+    {0x7fffde, 23}, {0xffffeb, 24}, {0x7fffdf, 23}, {0xffffec, 24}, {0xffffed, 24}, {0x3fffd7, 22},
+    {0x7fffe0, 23}, {0xffffee, 24}, {0x7fffe1, 23}, {0x7fffe2, 23}, {0x7fffe3, 23}, {0x7fffe4, 23},
+    {0x1fffdc, 21}, {0x3fffd8, 22}, {0x7fffe5, 23}, {0x3fffd9, 22}, {0x7fffe6, 23}, {0x7fffe7, 23},
+    {0xffffef, 24}, {0x3fffda, 22}, {0x1fffdd, 21}, {0xfffe9, 20}, {0x3fffdb, 22}, {0x3fffdc, 22},
+    {0x7fffe8, 23}, {0x7fffe9, 23}, {0x1fffde, 21}, {0x7fffea, 23}, {0x3fffdd, 22}, {0x3fffde, 22},
+    {0xfffff0, 24}, {0x1fffdf, 21}, {0x3fffdf, 22}, {0x7fffeb, 23}, {0x7fffec, 23}, {0x1fffe0, 21},
+    {0x1fffe1, 21}, {0x3fffe0, 22}, {0x1fffe2, 21}, {0x7fffed, 23}, {0x3fffe1, 22}, {0x7fffee, 23},
+    {0x7fffef, 23}, {0xfffea, 20}, {0x3fffe2, 22}, {0x3fffe3, 22}, {0x3fffe4, 22}, {0x7ffff0, 23},
+    {0x3fffe5, 22}, {0x3fffe6, 22}, {0x7ffff1, 23}, {0x3ffffe0, 26}, {0x3ffffe1, 26}, {0xfffeb, 20},
+    {0x7fff1, 19}, {0x3fffe7, 22}, {0x7ffff2, 23}, {0x3fffe8, 22}, {0x1ffffec, 25}, {0x3ffffe2, 26},
+    {0x3ffffe3, 26}, {0x3ffffe4, 26}, {0x7ffffde, 27}, {0x7ffffdf, 27}, {0x3ffffe5, 26},
+    {0xfffff1, 24}, {0x1ffffed, 25}, {0x7fff2, 19}, {0x1fffe3, 21}, {0x3ffffe6, 26},
+    {0x7ffffe0, 27}, {0x7ffffe1, 27}, {0x3ffffe7, 26}, {0x7ffffe2, 27}, {0xfffff2, 24},
+    {0x1fffe4, 21}, {0x1fffe5, 21}, {0x3ffffe8, 26}, {0x3ffffe9, 26}, {0xffffffd, 28},
+    {0x7ffffe3, 27}, {0x7ffffe4, 27}, {0x7ffffe5, 27}, {0xfffec, 20}, {0xfffff3, 24}, {0xfffed, 20},
+    {0x1fffe6, 21}, {0x3fffe9, 22}, {0x1fffe7, 21}, {0x1fffe8, 21}, {0x7ffff3, 23}, {0x3fffea, 22},
+    {0x3fffeb, 22}, {0x1ffffee, 25}, {0x1ffffef, 25}, {0xfffff4, 24}, {0xfffff5, 24},
+    {0x3ffffea, 26}, {0x7ffff4, 23}, {0x3ffffeb, 26}, {0x7ffffe6, 27}, {0x3ffffec, 26},
+    {0x3ffffed, 26}, {0x7ffffe7, 27}, {0x7ffffe8, 27}, {0x7ffffe9, 27}, {0x7ffffea, 27},
+    {0x7ffffeb, 27}, {0xffffffe, 28}, {0x7ffffec, 27}, {0x7ffffed, 27}, {0x7ffffee, 27},
+    {0x7ffffef, 27}, {0x7fffff0, 27}, {0x3ffffee, 26}, {0x3fffffff, 30},
+};
+
+// Huffman 解码树，由编码表在首次使用时构建
+struct HuffmanTree {
+    struct Node {
+        int child[2] = {-1, -1};
+        int symbol = -1;
+    };
+    std::vector<Node> nodes;
+
+    HuffmanTree() : nodes(1) {
+        for (int sym = 0; sym < 257; ++sym) {
+            const HuffmanCode& hc = kHuffmanTable[sym];
+            int cur = 0;
+            for (int i = hc.bits - 1; i >= 0; --i) {
+                int bit = (hc.code >> i) & 1;
+                if (nodes[cur].child[bit] < 0) {
+                    nodes[cur].child[bit] = static_cast<int>(nodes.size());
+                    nodes.emplace_back();
+                }
+                cur = nodes[cur].child[bit];
+            }
+            nodes[cur].symbol = sym;
+        }
+    }
+};
+
+const HuffmanTree& huffmanTree() {
+    static const HuffmanTree tree;
+    return tree;
+}
+
+// 解码带前缀的整数（RFC 7541 5.1）
+bool decodeInteger(const uint8_t*& p, const uint8_t* end, int prefix_bits, uint64_t* value) {
+    if (p >= end) return false;
+    uint64_t max_prefix = (1u << prefix_bits) - 1;
+    uint64_t v = *p++ & max_prefix;
+    if (v < max_prefix) {
+        *value = v;
+        return true;
+    }
+    int shift = 0;
+    while (p < end) {
+        uint8_t b = *p++;
+        v += static_cast<uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            *value = v;
+            return true;
+        }
+        shift += 7;
+        if (shift > 28) return false; // 超出合理范围，防止溢出
+    }
+    return false;
+}
+
+bool decodeString(const uint8_t*& p, const uint8_t* end, std::string* out) {
+    if (p >= end) return false;
+    bool huffman = (*p & 0x80) != 0;
+    uint64_t len = 0;
+    if (!decodeInteger(p, end, 7, &len)) return false;
+    if (len > static_cast<uint64_t>(end - p)) return false;
+    bool ok = true;
+    if (huffman) {
+        out->clear();
+        ok = Hpack::huffmanDecode(p, len, out);
+    } else {
+        out->assign(reinterpret_cast<const char*>(p), len);
+    }
+    p += len;
+    return ok;
+}
+
+void encodeInteger(uint64_t value, int prefix_bits, uint8_t first_byte, std::string* out) {
+    uint64_t max_prefix = (1u << prefix_bits) - 1;
+    if (value < max_prefix) {
+        out->push_back(static_cast<char>(first_byte | value));
+        return;
+    }
+    out->push_back(static_cast<char>(first_byte | max_prefix));
+    value -= max_prefix;
+    while (value >= 128) {
+        out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out->push_back(static_cast<char>(value));
+}
+
+void encodeString(const std::string& str, std::string* out) {
+    encodeInteger(str.size(), 7, 0x00, out);
+    out->append(str);
+}
+
+} // namespace
+
+namespace Hpack {
+
+bool huffmanDecode(const uint8_t* data, size_t len, std::string* out) {
+    const HuffmanTree& tree = huffmanTree();
+    int cur = 0;
+    int pad_bits = 0;       // 自上一个完整符号以来消耗的位数
+    bool pad_all_ones = true;
+    for (size_t i = 0; i < len; ++i) {
+        for (int shift = 7; shift >= 0; --shift) {
+            int bit = (data[i] >> shift) & 1;
+            cur = tree.nodes[cur].child[bit];
+            if (cur < 0) return false;
+            ++pad_bits;
+            pad_all_ones = pad_all_ones && bit == 1;
+            int symbol = tree.nodes[cur].symbol;
+            if (symbol >= 0) {
+                if (symbol == 256) return false; // EOS 不允许出现在数据中
+                out->push_back(static_cast<char>(symbol));
+                cur = 0;
+                pad_bits = 0;
+                pad_all_ones = true;
+            }
+        }
+    }
+    // 末尾填充必须是 EOS 码字的前缀（全 1）且不超过 7 位
+    return pad_bits <= 7 && pad_all_ones;
+}
+
+} // namespace Hpack
+
+HpackDecoder::HpackDecoder(size_t max_table_size)
+    : table_size_(0),
+      max_table_size_(max_table_size),
+      settings_max_size_(max_table_size) {}
+
+bool HpackDecoder::lookup(uint64_t index, HpackHeader* header) const {
+    if (index == 0) return false;
+    if (index <= kStaticTableSize) {
+        header->name = kStaticTable[index - 1].name;
+        header->value = kStaticTable[index - 1].value;
+        return true;
+    }
+    uint64_t dyn_index = index - kStaticTableSize - 1;
+    if (dyn_index >= dynamic_table_.size()) return false;
+    *header = dynamic_table_[dyn_index];
+    return true;
+}
+
+void HpackDecoder::evictTo(size_t size) {
+    while (table_size_ > size && !dynamic_table_.empty()) {
+        const HpackHeader& last = dynamic_table_.back();
+        table_size_ -= last.name.size() + last.value.size() + kEntryOverhead;
+        dynamic_table_.pop_back();
+    }
+}
+
+void HpackDecoder::insert(const HpackHeader& header) {
+    size_t entry_size = header.name.size() + header.value.size() + kEntryOverhead;
+    if (entry_size > max_table_size_) {
+        // 条目比整个表还大：清空表，且不插入（RFC 7541 4.4）
+        evictTo(0);
+        return;
+    }
+    evictTo(max_table_size_ - entry_size);
+    dynamic_table_.push_front(header);
+    table_size_ += entry_size;
+}
+
+bool HpackDecoder::decode(const uint8_t* data, size_t len, std::vector<HpackHeader>* headers) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + len;
+    bool header_seen = false;
+    while (p < end) {
+        uint8_t b = *p;
+        if (b & 0x80) {
+            // 6.1 索引头部字段
+            uint64_t index = 0;
+            HpackHeader header;
+            if (!decodeInteger(p, end, 7, &index) || !lookup(index, &header)) return false;
+            headers->push_back(std::move(header));
+            header_seen = true;
+        } else if ((b & 0xe0) == 0x20) {
+            // 6.3 动态表大小更新，只能出现在头部块开头
+            uint64_t size = 0;
+            if (header_seen || !decodeInteger(p, end, 5, &size) || size > settings_max_size_) return false;
+            max_table_size_ = size;
+            evictTo(max_table_size_);
+        } else {
+            // 6.2 字面量：带增量索引(01)、不索引(0000)、永不索引(0001)
+            bool incremental = (b & 0xc0) == 0x40;
+            int prefix_bits = incremental ? 6 : 4;
+            uint64_t name_index = 0;
+            if (!decodeInteger(p, end, prefix_bits, &name_index)) return false;
+            HpackHeader header;
+            if (name_index > 0) {
+                if (!lookup(name_index, &header)) return false;
+            } else if (!decodeString(p, end, &header.name)) {
+                return false;
+            }
+            if (!decodeString(p, end, &header.value)) return false;
+            if (incremental) insert(header);
+            headers->push_back(std::move(header));
+            header_seen = true;
+        }
+    }
+    return true;
+}
+
+void HpackEncoder::encodeHeader(const std::string& name, const std::string& value, std::string* out) {
+    // 静态表的反向索引：name -> 首个索引，name + '\0' + value -> 索引
+    static const auto index_maps = [] {
+        auto maps = std::make_unique<std::pair<std::unordered_map<std::string, size_t>,
+                                               std::unordered_map<std::string, size_t>>>();
+        for (size_t i = 0; i < kStaticTableSize; ++i) {
+            std::string n = kStaticTable[i].name;
+            maps->first.emplace(n, i + 1);
+            maps->second.emplace(n + '\0' + kStaticTable[i].value, i + 1);
+        }
+        return maps;
+    }();
+
+    auto full_it = index_maps->second.find(name + '\0' + value);
+    if (full_it != index_maps->second.end()) {
+        encodeInteger(full_it->second, 7, 0x80, out);
+        return;
+    }
+    // 6.2.2 不索引的字面量，名字尽量引用静态表
+    auto name_it = index_maps->first.find(name);
+    if (name_it != index_maps->first.end()) {
+        encodeInteger(name_it->second, 4, 0x00, out);
+    } else {
+        out->push_back(0x00);
+        encodeString(name, out);
+    }
+    encodeString(value, out);
+}
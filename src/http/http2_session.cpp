@@ -0,0 +1,502 @@
+#include "http/http2_session.h"
+#include "utils/logger.h"
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+
+namespace {
+
+const char kClientPreface[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+const size_t kClientPrefaceLength = sizeof(kClientPreface) - 1;
+const size_t kFrameHeaderLength = 9;
+
+// 帧标志
+const uint8_t kFlagEndStream = 0x1;
+const uint8_t kFlagAck = 0x1;
+const uint8_t kFlagEndHeaders = 0x4;
+const uint8_t kFlagPadded = 0x8;
+const uint8_t kFlagPriority = 0x20;
+
+// SETTINGS 参数
+const uint16_t kSettingsHeaderTableSize = 0x1;
+const uint16_t kSettingsMaxConcurrentStreams = 0x3;
+const uint16_t kSettingsInitialWindowSize = 0x4;
+const uint16_t kSettingsMaxFrameSize = 0x5;
+
+const uint32_t kDefaultWindowSize = 65535;
+const uint32_t kDefaultMaxFrameSize = 16384;
+const int64_t kMaxWindowSize = 0x7fffffff;
+const uint32_t kMaxConcurrentStreams = 100;
+// 单个头部块的大小上限，防止 CONTINUATION 无限累积
+const size_t kMaxHeaderBlockSize = 64 * 1024;
+// 输出缓冲区超过该值时不再向流式响应的生产者要数据，等连接写出后再继续
+const size_t kStreamOutputWindow = 64 * 1024;
+
+uint32_t readUint32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+void appendUint32(Buffer* output, uint32_t v) {
+    char b[4] = {static_cast<char>(v >> 24), static_cast<char>(v >> 16),
+                 static_cast<char>(v >> 8), static_cast<char>(v)};
+    output->append(b, 4);
+}
+
+// HTTP/2 禁止的连接级头部（RFC 7540 8.1.2.2）
+bool isConnectionSpecificHeader(const std::string& lower_name) {
+    return lower_name == "connection" || lower_name == "keep-alive" || lower_name == "transfer-encoding" ||
+           lower_name == "upgrade" || lower_name == "proxy-connection";
+}
+
+} // namespace
+
+Http2Session::PrefaceMatch Http2Session::matchPreface(const Buffer* buf) {
+    size_t n = std::min(buf->readableBytes(), kClientPrefaceLength);
+    if (std::memcmp(buf->peek(), kClientPreface, n) != 0) {
+        return kPrefaceMismatch;
+    }
+    return n == kClientPrefaceLength ? kPrefaceMatch : kPrefacePartial;
+}
+
+Http2Session::Http2Session(RequestHandler handler)
+    : handler_(std::move(handler)),
+      preface_received_(false),
+      going_away_(false),
+      last_stream_id_(0),
+      continuation_stream_(0),
+      peer_max_frame_size_(kDefaultMaxFrameSize),
+      peer_initial_window_(kDefaultWindowSize),
+      conn_send_window_(kDefaultWindowSize) {}
+
+void Http2Session::writeFrameHeader(Buffer* output, uint32_t length, uint8_t type, uint8_t flags, uint32_t stream_id) {
+    char h[kFrameHeaderLength] = {
+        static_cast<char>(length >> 16), static_cast<char>(length >> 8), static_cast<char>(length),
+        static_cast<char>(type), static_cast<char>(flags),
+        static_cast<char>((stream_id >> 24) & 0x7f), static_cast<char>(stream_id >> 16),
+        static_cast<char>(stream_id >> 8), static_cast<char>(stream_id)};
+    output->append(h, kFrameHeaderLength);
+}
+
+void Http2Session::writeWindowUpdate(Buffer* output, uint32_t stream_id, uint32_t increment) {
+    writeFrameHeader(output, 4, kWindowUpdate, 0, stream_id);
+    appendUint32(output, increment);
+}
+
+bool Http2Session::connectionError(ErrorCode code, Buffer* output) {
+    LOG_WARN << "HTTP/2 connection error " << code << ", last stream " << last_stream_id_;
+    writeFrameHeader(output, 8, kGoAway, 0, 0);
+    appendUint32(output, last_stream_id_);
+    appendUint32(output, code);
+    return false;
+}
+
+void Http2Session::resetStream(uint32_t stream_id, ErrorCode code, Buffer* output) {
+    writeFrameHeader(output, 4, kRstStream, 0, stream_id);
+    appendUint32(output, code);
+    streams_.erase(stream_id);
+}
+
+bool Http2Session::onData(Buffer* input, Buffer* output) {
+    if (!preface_received_) {
+        PrefaceMatch match = matchPreface(input);
+        if (match == kPrefacePartial) return true;
+        if (match == kPrefaceMismatch) return connectionError(kProtocolError, output);
+        input->retrieve(kClientPrefaceLength);
+        preface_received_ = true;
+
+        // 服务端连接前言：SETTINGS
+        writeFrameHeader(output, 6, kSettings, 0, 0);
+        char setting[6] = {0, static_cast<char>(kSettingsMaxConcurrentStreams), 0, 0, 0,
+                           static_cast<char>(kMaxConcurrentStreams)};
+        output->append(setting, sizeof(setting));
+    }
+
+    while (input->readableBytes() >= kFrameHeaderLength) {
+        const uint8_t* h = reinterpret_cast<const uint8_t*>(input->peek());
+        uint32_t length = (static_cast<uint32_t>(h[0]) << 16) | (static_cast<uint32_t>(h[1]) << 8) | h[2];
+        uint8_t type = h[3];
+        uint8_t flags = h[4];
+        uint32_t stream_id = readUint32(h + 5) & 0x7fffffff;
+
+        // 我们没有调整 SETTINGS_MAX_FRAME_SIZE，对端必须使用默认值
+        if (length > kDefaultMaxFrameSize) {
+            return connectionError(kFrameSizeError, output);
+        }
+        if (input->readableBytes() < kFrameHeaderLength + length) {
+            break; // 帧不完整，等待更多数据
+        }
+        bool ok = handleFrame(type, flags, stream_id, h + kFrameHeaderLength, length, output);
+        input->retrieve(kFrameHeaderLength + length);
+        if (!ok) return false;
+    }
+
+    flushPending(output);
+    // 对端已 GOAWAY 且所有流都已完成，可以关闭连接
+    return !(going_away_ && streams_.empty());
+}
+
+bool Http2Session::handleFrame(uint8_t type, uint8_t flags, uint32_t stream_id,
+                               const uint8_t* payload, size_t len, Buffer* output) {
+    // 头部块必须连续：CONTINUATION 期间不允许出现其他帧
+    if (continuation_stream_ != 0 && (type != kContinuation || stream_id != continuation_stream_)) {
+        return connectionError(kProtocolError, output);
+    }
+
+    switch (type) {
+    case kData:
+        return handleData(flags, stream_id, payload, len, output);
+    case kHeaders:
+        return handleHeaders(flags, stream_id, payload, len, output);
+    case kContinuation:
+        return handleContinuation(flags, stream_id, payload, len, output);
+    case kSettings:
+        return handleSettings(flags, stream_id, payload, len, output);
+    case kWindowUpdate:
+        return handleWindowUpdate(stream_id, payload, len, output);
+    case kPriority:
+        // 不实现优先级调度
+        if (stream_id == 0 || len != 5) return connectionError(kProtocolError, output);
+        return true;
+    case kRstStream:
+        if (stream_id == 0 || len != 4) return connectionError(kProtocolError, output);
+        streams_.erase(stream_id);
+        return true;
+    case kPing:
+        if (stream_id != 0 || len != 8) return connectionError(kProtocolError, output);
+        if (!(flags & kFlagAck)) {
+            writeFrameHeader(output, 8, kPing, kFlagAck, 0);
+            output->append(reinterpret_cast<const char*>(payload), 8);
+        }
+        return true;
+    case kGoAway:
+        if (stream_id != 0 || len < 8) return connectionError(kProtocolError, output);
+        going_away_ = true;
+        return true;
+    case kPushPromise:
+        // 客户端不能发送 PUSH_PROMISE
+        return connectionError(kProtocolError, output);
+    default:
+        // 未知类型的帧必须忽略
+        return true;
+    }
+}
+
+bool Http2Session::handleHeaders(uint8_t flags, uint32_t stream_id, const uint8_t* payload, size_t len, Buffer* output) {
+    // 客户端发起的流必须是奇数且单调递增
+    if (stream_id == 0 || (stream_id & 1) == 0) {
+        return connectionError(kProtocolError, output);
+    }
+    auto it = streams_.find(stream_id);
+    if (it == streams_.end()) {
+        if (stream_id <= last_stream_id_) {
+            return connectionError(kStreamClosed, output);
+        }
+        last_stream_id_ = stream_id;
+        it = streams_.emplace(stream_id, Stream()).first;
+        it->second.send_window = peer_initial_window_;
+    } else if (!it->second.headers.empty() || it->second.end_stream) {
+        // 不支持 trailer，在同一个流上再次收到 HEADERS
+        resetStream(stream_id, kProtocolError, output);
+        return true;
+    }
+
+    size_t pad = 0;
+    if (flags & kFlagPadded) {
+        if (len < 1) return connectionError(kProtocolError, output);
+        pad = payload[0];
+        payload += 1;
+        len -= 1;
+    }
+    if (flags & kFlagPriority) {
+        if (len < 5) return connectionError(kProtocolError, output);
+        payload += 5;
+        len -= 5;
+    }
+    if (pad > len) return connectionError(kProtocolError, output);
+    len -= pad;
+
+    Stream& stream = it->second;
+    stream.header_block.assign(reinterpret_cast<const char*>(payload), len);
+    stream.end_stream = (flags & kFlagEndStream) != 0;
+    if (!(flags & kFlagEndHeaders)) {
+        continuation_stream_ = stream_id;
+        return true;
+    }
+    return finishHeaderBlock(stream_id, output);
+}
+
+bool Http2Session::handleContinuation(uint8_t flags, uint32_t stream_id, const uint8_t* payload, size_t len, Buffer* output) {
+    if (continuation_stream_ == 0 || stream_id != continuation_stream_) {
+        return connectionError(kProtocolError, output);
+    }
+    auto it = streams_.find(stream_id);
+    if (it == streams_.end()) return connectionError(kProtocolError, output);
+    it->second.header_block.append(reinterpret_cast<const char*>(payload), len);
+    if (it->second.header_block.size() > kMaxHeaderBlockSize) {
+        return connectionError(kProtocolError, output);
+    }
+    if (!(flags & kFlagEndHeaders)) return true;
+    continuation_stream_ = 0;
+    return finishHeaderBlock(stream_id, output);
+}
+
+bool Http2Session::finishHeaderBlock(uint32_t stream_id, Buffer* output) {
+    Stream& stream = streams_[stream_id];
+    const uint8_t* block = reinterpret_cast<const uint8_t*>(stream.header_block.data());
+    if (!decoder_.decode(block, stream.header_block.size(), &stream.headers)) {
+        return connectionError(kCompressionError, output);
+    }
+    stream.header_block.clear();
+    stream.header_block.shrink_to_fit();
+    // 头部块必须先解码以保持 HPACK 动态表同步，然后才能拒绝超出并发上限的流
+    if (going_away_ || streams_.size() > kMaxConcurrentStreams) {
+        resetStream(stream_id, kRefusedStream, output);
+        return true;
+    }
+    if (stream.end_stream) {
+        dispatch(stream_id, stream, output);
+    }
+    return true;
+}
+
+bool Http2Session::handleData(uint8_t flags, uint32_t stream_id, const uint8_t* payload, size_t len, Buffer* output) {
+    if (stream_id == 0) return connectionError(kProtocolError, output);
+
+    // 整个帧长度（含填充）都计入流量控制，立即归还连接级窗口
+    const uint32_t frame_len = static_cast<uint32_t>(len);
+    if (frame_len > 0) writeWindowUpdate(output, 0, frame_len);
+
+    auto it = streams_.find(stream_id);
+    if (it == streams_.end() || it->second.end_stream || it->second.headers.empty()) {
+        if (stream_id > last_stream_id_) return connectionError(kProtocolError, output);
+        resetStream(stream_id, kStreamClosed, output);
+        return true;
+    }
+
+    size_t pad = 0;
+    if (flags & kFlagPadded) {
+        if (len < 1) return connectionError(kProtocolError, output);
+        pad = payload[0];
+        payload += 1;
+        len -= 1;
+        if (pad > len) return connectionError(kProtocolError, output);
+    }
+
+    Stream& stream = it->second;
+    // 请求体整体缓存在内存中，与 HTTP/1.1 使用同一上限（HttpRequest::Limits::max_body_size）；
+    // 超出时重置流并丢弃已收到的部分，不再归还流级窗口
+    if (stream.body.size() + (len - pad) > HttpRequest::limits().max_body_size) {
+        LOG_WARN << "HTTP/2 stream " << stream_id << " request body exceeds " << HttpRequest::limits().max_body_size
+                 << " bytes, resetting";
+        resetStream(stream_id, kCancel, output);
+        return true;
+    }
+    stream.body.append(reinterpret_cast<const char*>(payload), len - pad);
+    if (flags & kFlagEndStream) {
+        stream.end_stream = true;
+        dispatch(stream_id, stream, output);
+    } else if (frame_len > 0) {
+        writeWindowUpdate(output, stream_id, frame_len);
+    }
+    return true;
+}
+
+bool Http2Session::handleSettings(uint8_t flags, uint32_t stream_id, const uint8_t* payload, size_t len, Buffer* output) {
+    if (stream_id != 0) return connectionError(kProtocolError, output);
+    if (flags & kFlagAck) {
+        if (len != 0) return connectionError(kFrameSizeError, output);
+        return true;
+    }
+    if (len % 6 != 0) return connectionError(kFrameSizeError, output);
+
+    for (size_t i = 0; i < len; i += 6) {
+        uint16_t id = static_cast<uint16_t>((payload[i] << 8) | payload[i + 1]);
+        uint32_t value = readUint32(payload + i + 2);
+        if (id == kSettingsInitialWindowSize) {
+            if (value > kMaxWindowSize) return connectionError(kFlowControlError, output);
+            // 新的初始窗口按差值作用于所有已打开的流（RFC 7540 6.9.2）
+            int64_t delta = static_cast<int64_t>(value) - peer_initial_window_;
+            peer_initial_window_ = value;
+            for (auto& pair : streams_) {
+                pair.second.send_window += delta;
+            }
+        } else if (id == kSettingsMaxFrameSize) {
+            if (value < kDefaultMaxFrameSize || value > 0xffffff) return connectionError(kProtocolError, output);
+            peer_max_frame_size_ = value;
+        } else if (id == kSettingsHeaderTableSize) {
+            // 编码器不使用动态表，无需处理
+        }
+    }
+    writeFrameHeader(output, 0, kSettings, kFlagAck, 0);
+    return true;
+}
+
+bool Http2Session::handleWindowUpdate(uint32_t stream_id, const uint8_t* payload, size_t len, Buffer* output) {
+    if (len != 4) return connectionError(kFrameSizeError, output);
+    uint32_t increment = readUint32(payload) & 0x7fffffff;
+    if (stream_id == 0) {
+        if (increment == 0) return connectionError(kProtocolError, output);
+        conn_send_window_ += increment;
+        if (conn_send_window_ > kMaxWindowSize) return connectionError(kFlowControlError, output);
+        return true;
+    }
+    auto it = streams_.find(stream_id);
+    if (it == streams_.end()) return true; // 流已关闭，忽略
+    if (increment == 0) {
+        resetStream(stream_id, kProtocolError, output);
+        return true;
+    }
+    it->second.send_window += increment;
+    if (it->second.send_window > kMaxWindowSize) {
+        resetStream(stream_id, kFlowControlError, output);
+    }
+    return true;
+}
+
+void Http2Session::dispatch(uint32_t stream_id, Stream& stream, Buffer* output) {
+    std::string method, path, authority;
+    HttpRequest request;
+    std::vector<std::pair<std::string, std::string>> regular_headers;
+    for (const auto& header : stream.headers) {
+        if (header.name == ":method") method = header.value;
+        else if (header.name == ":path") path = header.value;
+        else if (header.name == ":authority") authority = header.value;
+        else if (!header.name.empty() && header.name[0] != ':') {
+            regular_headers.emplace_back(header.name, header.value);
+        }
+    }
+
+    bool valid = !method.empty() && !path.empty() && request.setRequestLine(method, path, "HTTP/2");
+    for (size_t i = 0; valid && i < regular_headers.size(); ++i) {
+        valid = request.addHeader(regular_headers[i].first, regular_headers[i].second);
+    }
+    if (valid && !authority.empty() && request.header(HttpRequest::kHost).empty()) {
+        valid = request.addHeader("host", authority);
+    }
+
+    HttpResponse response;
+    if (!valid) {
+        response.setStatusCode(HttpResponse::k400BadRequest);
+        response.setContentLength(0);
+    } else {
+        request.setBody(stream.body);
+        handler_(request, &response);
+    }
+    stream.headers.clear();
+    stream.body.clear();
+    stream.responded = true;
+
+    // HEADERS：:status 必须在最前
+    std::string block;
+    HpackEncoder::encodeHeader(":status", std::to_string(static_cast<int>(response.getStatusCode())), &block);
+    HpackEncoder::encodeHeader("date", std::string(HttpResponse::cachedDate()), &block);
+    for (const auto& header : response.getHeaders()) {
+        std::string name(HttpResponse::headerName(header));
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(::tolower(c)); });
+        if (isConnectionSpecificHeader(name)) continue;
+        HpackEncoder::encodeHeader(name, std::string(header.value), &block);
+    }
+
+    bool has_body = (!response.getBody().empty() || response.isStreaming()) &&
+                    request.getMethod() != HttpRequest::HEAD;
+    // 头部块超过对端帧大小时拆分为 HEADERS + CONTINUATION
+    size_t offset = 0;
+    bool first = true;
+    do {
+        size_t chunk = std::min<size_t>(block.size() - offset, peer_max_frame_size_);
+        bool last = offset + chunk == block.size();
+        uint8_t frame_flags = (last ? kFlagEndHeaders : 0);
+        if (first && !has_body) frame_flags |= kFlagEndStream;
+        writeFrameHeader(output, static_cast<uint32_t>(chunk), first ? kHeaders : kContinuation, frame_flags, stream_id);
+        output->append(block.data() + offset, chunk);
+        offset += chunk;
+        first = false;
+    } while (offset < block.size());
+
+    if (has_body) {
+        if (response.getWakeupReceiver() && wakeup_) {
+            // 生产者可以暂时不产生数据，flushPending 跳过该流，数据就绪后由 wakeup 驱动连接再次调用 produce
+            response.getWakeupReceiver()(wakeup_);
+        }
+        stream.pending = response.getSharedBody();
+        stream.pending_offset = 0;
+        stream.producer = response.getBodyProducer();
+        stream.failed = response.getFailureCheck();
+    } else {
+        streams_.erase(stream_id);
+    }
+}
+
+void Http2Session::flushPending(Buffer* output) {
+    // 按流 ID 顺序轮流发送，每个流每轮最多一帧，避免单个大响应饿死其他流
+    bool progress = true;
+    while (progress && conn_send_window_ > 0) {
+        progress = false;
+        for (auto it = streams_.begin(); it != streams_.end() && conn_send_window_ > 0; ) {
+            Stream& stream = it->second;
+            if (!stream.responded || stream.send_window <= 0) {
+                ++it;
+                continue;
+            }
+            // 流式响应只在流量控制窗口和输出缓冲区都有余量时才产生下一段
+            if (stream.pending_offset == stream.pending.size() && stream.producer) {
+                if (output->readableBytes() >= kStreamOutputWindow) {
+                    ++it;
+                    continue;
+                }
+                Buffer chunk_buf;
+                if (!stream.producer(&chunk_buf)) {
+                    stream.producer = nullptr;
+                    if (stream.failed && stream.failed()) {
+                        // 正文无法完整产生，不能以 END_STREAM 结束，让客户端知道响应不完整
+                        uint32_t stream_id = it->first;
+                        ++it;
+                        resetStream(stream_id, kInternalError, output);
+                        continue;
+                    }
+                }
+                stream.pending = SharedBuffer(chunk_buf.retrieveAllAsString());
+                stream.pending_offset = 0;
+                if (stream.pending.empty() && stream.producer) {
+                    ++it;
+                    continue;
+                }
+            }
+            size_t remaining = stream.pending.size() - stream.pending_offset;
+            size_t chunk = std::min<size_t>({remaining, peer_max_frame_size_,
+                                             static_cast<size_t>(stream.send_window),
+                                             static_cast<size_t>(conn_send_window_)});
+            bool last = chunk == remaining && !stream.producer;
+            writeFrameHeader(output, static_cast<uint32_t>(chunk), kData, last ? kFlagEndStream : 0, it->first);
+            output->append(stream.pending.data() + stream.pending_offset, chunk);
+            stream.pending_offset += chunk;
+            stream.send_window -= chunk;
+            conn_send_window_ -= chunk;
+            progress = true;
+            if (last) {
+                it = streams_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+bool Http2Session::hasWritableData() const {
+    if (conn_send_window_ <= 0) return false;
+    for (const auto& pair : streams_) {
+        const Stream& stream = pair.second;
+        if (stream.responded && stream.send_window > 0 &&
+            (stream.producer || stream.pending_offset < stream.pending.size())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Http2Session::produce(Buffer* output) {
+    flushPending(output);
+    return hasWritableData();
+}
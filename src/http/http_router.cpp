@@ -1,62 +1,437 @@
 #include "http/http_router.h"
 #include "utils/logger.h" // 用于日志
+#include <array>
+#include <algorithm>
+#include <cstring>
 
-bool HttpRouter::addRoute(HttpRequest::Method method, const std::string& path_pattern, HttpHandler handler) {
-    // 简单的判断：如果路径中没有特殊字符，认为是静态路由
-    if (path_pattern.find_first_of("*+?()[]{}|^$") == std::string::npos) {
-        static_routes_[path_pattern][method] = handler;
-        LOG_INFO << "Adding regex route: " << path_pattern; // **添加这行日志**
+namespace {
+
+const size_t kMethodCount = HttpRequest::INVALID;
+
+enum ParamType { kParamInt, kParamSlug, kParamStr }; // 同时也是尝试顺序
+
+bool parseParamType(std::string_view name, ParamType* type) {
+    if (name.empty() || name == "str") *type = kParamStr;
+    else if (name == "int") *type = kParamInt;
+    else if (name == "slug") *type = kParamSlug;
+    else return false;
+    return true;
+}
+
+bool matchesType(std::string_view segment, ParamType type) {
+    for (char c : segment) {
+        bool ok = true;
+        if (type == kParamInt) {
+            ok = c >= '0' && c <= '9';
+        } else if (type == kParamSlug) {
+            ok = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '-';
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+bool isNameChar(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+// 路径模式拆分后的片段
+struct Token {
+    enum Kind { kLiteral, kParam, kWildcard } kind;
+    std::string text;   // 字面量；通配的后缀
+    std::string name;   // 参数名，不捕获的通配为空
+    ParamType type;
+};
+
+bool tokenize(const std::string& pattern, std::vector<Token>* tokens) {
+    size_t i = 0;
+    std::string literal;
+    auto flushLiteral = [&]() {
+        if (!literal.empty()) tokens->push_back({Token::kLiteral, literal, "", kParamStr});
+        literal.clear();
+    };
+    while (i < pattern.size()) {
+        char c = pattern[i];
+        if (c == ':' || c == '{') {
+            // 参数必须占据完整的路径段
+            if (i > 0 && pattern[i - 1] != '/') return false;
+            flushLiteral();
+            Token token{Token::kParam, "", "", kParamStr};
+            if (c == ':') {
+                size_t end = i + 1;
+                while (end < pattern.size() && isNameChar(pattern[end])) ++end;
+                token.name = pattern.substr(i + 1, end - i - 1);
+                i = end;
+            } else {
+                size_t close = pattern.find('}', i);
+                if (close == std::string::npos) return false;
+                std::string body = pattern.substr(i + 1, close - i - 1);
+                size_t colon = body.find(':');
+                token.name = body.substr(0, colon);
+                if (colon != std::string::npos && !parseParamType(std::string_view(body).substr(colon + 1), &token.type)) {
+                    return false;
+                }
+                i = close + 1;
+            }
+            if (token.name.empty() || (i < pattern.size() && pattern[i] != '/')) return false;
+            tokens->push_back(token);
+        } else if (c == '*') {
+            flushLiteral();
+            size_t end = i + 1;
+            while (end < pattern.size() && isNameChar(pattern[end])) ++end;
+            std::string suffix = pattern.substr(end);
+            // 通配只能出现在最后，后面只允许字面量后缀
+            if (suffix.find_first_of(":{*") != std::string::npos) return false;
+            tokens->push_back({Token::kWildcard, suffix, pattern.substr(i + 1, end - i - 1), kParamStr});
+            return true;
+        } else {
+            literal += c;
+            ++i;
+        }
+    }
+    flushLiteral();
+    return true;
+}
+
+} // namespace
+
+// 前缀树节点：prefix 为从父节点到本节点的静态边
+struct HttpRouter::Node {
+    struct ParamChild {
+        ParamType type;
+        std::unique_ptr<Node> node;
+    };
+    struct Wildcard {
+        std::string suffix;
+        bool capture;
+        std::array<std::unique_ptr<RouteTarget>, kMethodCount> targets;
+    };
+
+    std::string prefix;
+    std::vector<std::unique_ptr<Node>> children; // 静态子节点，首字符互不相同
+    std::vector<ParamChild> params;              // 按 ParamType 排序
+    std::vector<Wildcard> wildcards;             // 后缀长的在前
+    std::array<std::unique_ptr<RouteTarget>, kMethodCount> targets;
+
+    Node* staticChild(char c) const {
+        for (const auto& child : children) {
+            if (child->prefix[0] == c) return child.get();
+        }
+        return nullptr;
+    }
+
+    // 插入静态路径，必要时分裂已有的边，返回路径末端的节点
+    Node* insertLiteral(std::string_view text) {
+        Node* node = this;
+        while (!text.empty()) {
+            Node* child = node->staticChild(text[0]);
+            if (!child) {
+                node->children.push_back(std::make_unique<Node>());
+                node->children.back()->prefix = std::string(text);
+                return node->children.back().get();
+            }
+            size_t common = 0;
+            while (common < child->prefix.size() && common < text.size() && child->prefix[common] == text[common]) {
+                ++common;
+            }
+            if (common < child->prefix.size()) {
+                // 分裂：公共部分成为新的中间节点
+                auto mid = std::make_unique<Node>();
+                mid->prefix = child->prefix.substr(0, common);
+                for (auto& slot : node->children) {
+                    if (slot.get() == child) {
+                        slot->prefix.erase(0, common);
+                        mid->children.push_back(std::move(slot));
+                        slot = std::move(mid);
+                        child = slot.get();
+                        break;
+                    }
+                }
+            }
+            node = child;
+            text.remove_prefix(common);
+        }
+        return node;
+    }
+
+    Node* insertParam(ParamType type) {
+        for (auto& param : params) {
+            if (param.type == type) return param.node.get();
+        }
+        params.push_back({type, std::make_unique<Node>()});
+        std::stable_sort(params.begin(), params.end(),
+                         [](const ParamChild& a, const ParamChild& b) { return a.type < b.type; });
+        for (auto& param : params) {
+            if (param.type == type) return param.node.get();
+        }
+        return nullptr;
+    }
+
+    Wildcard* insertWildcard(const std::string& suffix, bool capture) {
+        for (auto& wildcard : wildcards) {
+            if (wildcard.suffix == suffix && wildcard.capture == capture) return &wildcard;
+        }
+        wildcards.push_back({suffix, capture, {}});
+        std::stable_sort(wildcards.begin(), wildcards.end(),
+                         [](const Wildcard& a, const Wildcard& b) { return a.suffix.size() > b.suffix.size(); });
+        for (auto& wildcard : wildcards) {
+            if (wildcard.suffix == suffix && wildcard.capture == capture) return &wildcard;
+        }
+        return nullptr;
+    }
+
+    // rest 为消耗本节点前缀之后剩余的路径
+    const RouteTarget* match(std::string_view rest, size_t method, RouteParams* params_out) const {
+        if (rest.empty() && targets[method]) {
+            return targets[method].get();
+        }
+        if (!rest.empty()) {
+            Node* child = staticChild(rest[0]);
+            if (child && rest.compare(0, child->prefix.size(), child->prefix) == 0) {
+                if (const RouteTarget* target = child->match(rest.substr(child->prefix.size()), method, params_out)) {
+                    return target;
+                }
+            }
+            std::string_view segment = rest.substr(0, rest.find('/'));
+            if (!segment.empty()) {
+                for (const auto& param : params) {
+                    if (!matchesType(segment, param.type)) continue;
+                    if (params_out) params_out->emplace_back(segment);
+                    if (const RouteTarget* target = param.node->match(rest.substr(segment.size()), method, params_out)) {
+                        return target;
+                    }
+                    if (params_out) params_out->pop_back();
+                }
+            }
+        }
+        for (const auto& wildcard : wildcards) {
+            if (!wildcard.targets[method] || rest.size() < wildcard.suffix.size() ||
+                rest.compare(rest.size() - wildcard.suffix.size(), wildcard.suffix.size(), wildcard.suffix) != 0) {
+                continue;
+            }
+            if (params_out && wildcard.capture) {
+                params_out->emplace_back(rest.substr(0, rest.size() - wildcard.suffix.size()));
+            }
+            return wildcard.targets[method].get();
+        }
+        return nullptr;
+    }
+};
+
+HttpRouter::HttpRouter() : root_(std::make_unique<Node>()) {}
+
+HttpRouter::~HttpRouter() = default;
+
+bool HttpRouter::addRoute(HttpRequest::Method method, const std::string& path_pattern, HttpHandler handler,
+                          const RouteOptions& options) {
+    return addTarget(method, path_pattern, {handler, nullptr, options, path_pattern, {}});
+}
+
+bool HttpRouter::addStreamRoute(HttpRequest::Method method, const std::string& path_pattern, BodyReaderFactory factory,
+                                const RouteOptions& options) {
+    return addTarget(method, path_pattern, {nullptr, factory, options, path_pattern, {}});
+}
+
+bool HttpRouter::addTarget(HttpRequest::Method method, const std::string& path_pattern, RouteTarget target) {
+    if (method >= HttpRequest::INVALID) return false;
+    // 含正则元字符的模式先尝试翻译为前缀树语法
+    if (path_pattern.find_first_of("()[]|^$+?\\") == std::string::npos &&
+        path_pattern.find(".*") == std::string::npos) {
+        if (insert(method, path_pattern, target)) {
+            LOG_INFO << "Adding route: " << path_pattern;
+            return true;
+        }
+        LOG_ERROR << "Invalid route pattern '" << path_pattern << "'";
+        return false;
+    }
+    std::string translated;
+    if (translateRegex(path_pattern, &translated) && insert(method, translated, target)) {
+        LOG_INFO << "Adding route: " << path_pattern << " (as " << translated << ")";
         return true;
-    } else {
-        try {
-            regex_routes_.push_back({method, std::regex(path_pattern), handler});
+    }
+    try {
+        regex_routes_.push_back({method, std::regex(path_pattern), target});
+        LOG_WARN << "Route '" << path_pattern << "' cannot be expressed in the radix tree, matched as regex";
+        return true;
+    } catch (const std::regex_error& e) {
+        LOG_ERROR << "Invalid regex pattern '" << path_pattern << "': " << e.what();
+        return false;
+    }
+}
+
+bool HttpRouter::insert(HttpRequest::Method method, const std::string& pattern, RouteTarget target) {
+    std::vector<Token> tokens;
+    if (!tokenize(pattern, &tokens)) return false;
+    Node* node = root_.get();
+    for (const Token& token : tokens) {
+        if (token.kind == Token::kLiteral) {
+            node = node->insertLiteral(token.text);
+        } else if (token.kind == Token::kParam) {
+            target.param_names.push_back(token.name);
+            node = node->insertParam(token.type);
+        } else {
+            if (!token.name.empty()) target.param_names.push_back(token.name);
+            Node::Wildcard* wildcard = node->insertWildcard(token.text, !token.name.empty());
+            wildcard->targets[method] = std::make_unique<RouteTarget>(std::move(target));
             return true;
-        } catch (const std::regex_error& e) {
-            LOG_ERROR << "Invalid regex pattern '" << path_pattern << "': " << e.what();
-            return false;
         }
     }
+    node->targets[method] = std::make_unique<RouteTarget>(std::move(target));
+    return true;
 }
 
-void HttpRouter::route(HttpRequest& req, HttpResponse* resp) const {
-    // 1. 优先尝试精确匹配，性能更高
-    auto path_it = static_routes_.find(req.getPath());
-    if (path_it != static_routes_.end()) {
-        auto method_it = path_it->second.find(req.getMethod());
-        if (method_it != path_it->second.end()) {
-            method_it->second(req, resp);
-            return;
+bool HttpRouter::translateRegex(const std::string& regex, std::string* pattern) {
+    // 常见的捕获组写法与参数类型的对应
+    static const std::pair<const char*, const char*> kGroups[] = {
+        {"(\\d+)", "int"}, {"([0-9]+)", "int"},
+        {"([a-zA-Z0-9_-]+)", "slug"}, {"([A-Za-z0-9_-]+)", "slug"}, {"([\\w-]+)", "slug"},
+        {"([^/]+)", "str"},
+    };
+    pattern->clear();
+    int param_index = 0;
+    size_t i = 0;
+    while (i < regex.size()) {
+        char c = regex[i];
+        if (c == '\\') {
+            // 转义的字面量
+            if (i + 1 >= regex.size() || std::string_view("./-_").find(regex[i + 1]) == std::string_view::npos) {
+                return false;
+            }
+            *pattern += regex[i + 1];
+            i += 2;
+            continue;
+        }
+        if (regex.compare(i, 2, ".*") == 0 || regex.compare(i, 4, "(.*)") == 0) {
+            // 通配：其后只允许字面量
+            bool capture = regex[i] == '(';
+            *pattern += capture ? "*p" + std::to_string(++param_index) : "*";
+            i += capture ? 4 : 2;
+            while (i < regex.size()) {
+                if (regex[i] == '\\' && i + 1 < regex.size() &&
+                    std::string_view("./-_").find(regex[i + 1]) != std::string_view::npos) {
+                    *pattern += regex[i + 1];
+                    i += 2;
+                } else if (std::string_view("()[]{}|^$+?*.:\\").find(regex[i]) == std::string_view::npos) {
+                    *pattern += regex[i++];
+                } else {
+                    return false;
+                }
+            }
+            return true;
+        }
+        if (c == '(') {
+            bool matched = false;
+            for (const auto& group : kGroups) {
+                size_t len = strlen(group.first);
+                if (regex.compare(i, len, group.first) == 0) {
+                    if (!pattern->empty() && pattern->back() != '/') return false;
+                    *pattern += "{p" + std::to_string(++param_index) + ":" + group.second + "}";
+                    i += len;
+                    matched = true;
+                    break;
+                }
+            }
+            if (!matched || (i < regex.size() && regex[i] != '/')) return false;
+            continue;
+        }
+        if (std::string_view("()[]{}|^$+?*.:").find(c) != std::string_view::npos) {
+            return false;
         }
+        *pattern += c;
+        ++i;
+    }
+    return true;
+}
+
+const HttpRouter::RouteTarget* HttpRouter::findRoute(const HttpRequest& req, RouteParams* params) const {
+    if (req.getMethod() >= HttpRequest::INVALID) return nullptr;
+    if (params) params->clear();
+    // 1. 前缀树匹配，耗时只与路径长度有关
+    const std::string& path = req.getPath();
+    if (const RouteTarget* target = root_->match(path, req.getMethod(), params)) {
+        return target;
     }
 
-    // 2. 如果精确匹配失败，再尝试正则表达式匹配
+    // 2. 无法翻译的正则路由逐条尝试
     std::smatch match;
     for (const auto& route : regex_routes_) {
-        if (req.getMethod() == route.method && std::regex_match(req.getPath(), match, route.path_regex)) {
-            // 匹配成功
-            RouteParams params;
+        if (req.getMethod() == route.method && std::regex_match(path, match, route.path_regex)) {
             // match[0] 是整个匹配的字符串，我们从 match[1] 开始提取捕获组
-            for (size_t i = 1; i < match.size(); ++i) {
-                params.push_back(match[i].str());
+            if (params) {
+                params->clear();
+                for (size_t i = 1; i < match.size(); ++i) {
+                    params->emplace_back(match[i].first, match[i].second);
+                }
             }
-            // 将捕获的参数存入 HttpRequest 对象
-            req.setRouteParams(params);
-            
-            route.handler(req, resp);
-            return;
+            return &route.target;
         }
     }
+    return nullptr;
+}
+
+void HttpRouter::route(HttpRequest& req, HttpResponse* resp) const {
+    RouteParams params(req.arena());
+    const RouteTarget* target = findRoute(req, &params);
+    if (!target) {
+        // 3. 所有匹配都失败，返回 404
+        handleNotFound(req, resp);
+        return;
+    }
+    // 将捕获的参数存入 HttpRequest 对象
+    req.setRouteParams(std::move(params));
+    req.setRoutePattern(target->pattern);
+    req.setRouteParamNames(&target->param_names);
+    if (target->options.deadline > 0) {
+        req.setDeadline(addTime(req.receiveTime(), target->options.deadline));
+    }
+    // 流式请求体已经交给 BodyReader 处理过，此时拒绝没有意义
+    bool body_consumed = !target->handler && req.getBodyReader();
+    if (guard_ && !body_consumed && !guard_(req, target->options, resp)) {
+        return;
+    }
 
-    // 3. 所有匹配都失败，返回 404
-    handleNotFound(req, resp);
+    if (target->handler) {
+        target->handler(req, resp);
+        return;
+    }
+    BodyReader* reader = req.getBodyReader();
+    std::unique_ptr<BodyReader> local_reader;
+    if (!reader) {
+        // 请求体已整体到达（如 HTTP/2），补走一遍流式接口
+        local_reader = target->reader_factory(req);
+        reader = local_reader.get();
+        if (!req.getBody().empty()) {
+            reader->onBody(req.getBody().data(), req.getBody().size());
+        }
+    }
+    reader->onComplete(req, resp);
+}
+
+void HttpRouter::prepareBody(HttpRequest& req) const {
+    RouteParams params(req.arena());
+    const RouteTarget* target = findRoute(req, &params);
+    if (target && target->reader_factory) {
+        req.setRouteParams(std::move(params));
+        req.setRouteParamNames(&target->param_names);
+        req.setBodyReader(target->reader_factory(req));
+    } else {
+        req.setBodyReader(nullptr);
+    }
+}
+
+const RouteOptions* HttpRouter::findOptions(const HttpRequest& req, std::string_view* pattern) const {
+    const RouteTarget* target = findRoute(req, nullptr);
+    if (!target) return nullptr;
+    if (pattern) *pattern = target->pattern;
+    return &target->options;
 }
 
 void HttpRouter::handleNotFound(const HttpRequest& req, HttpResponse* resp) const {
-    LOG_WARN << "No route found for " << (req.getMethod() == HttpRequest::GET ? "GET" : "POST") 
+    LOG_WARN << "No route found for " << (req.getMethod() == HttpRequest::GET ? "GET" : "POST")
              << " " << req.getPath();
-    
+
     resp->setStatusCode(HttpResponse::k404NotFound);
     resp->setContentType("text/html; charset=utf-8");
     resp->setBody("<html><body><h1>404 Not Found</h1></body></html>");
     resp->setContentLength(resp->getBody().length());
-}
\ No newline at end of file
+}
@@ -0,0 +1,211 @@
+#include "http/mapped_file.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+// 预读提示的上限，更远的部分交给 MADV_SEQUENTIAL 触发的内核预读
+const size_t kWillNeedLimit = 2 * 1024 * 1024;
+
+// 路径 -> 正在使用的映射，只持有弱引用，不延长映射的生命周期
+struct Registry {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<const MappedFile>> files;
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+// 正在使用的映射的地址范围，供 SIGBUS 处理函数查找出错地址属于哪个映射
+// 处理函数中不能加锁或分配内存，因此用固定大小的表和原子变量；begin 为 0 表示该项未生效
+struct GuardSlot {
+    std::atomic<bool> used{false};
+    std::atomic<uintptr_t> begin{0};
+    std::atomic<uintptr_t> end{0};
+    std::atomic<bool> truncated{false};
+};
+
+const int kMaxGuarded = 4096;
+GuardSlot g_guards[kMaxGuarded];
+size_t g_page_size = 0;
+
+void onSigbus(int sig, siginfo_t* info, void*) {
+    int saved_errno = errno;
+    uintptr_t addr = reinterpret_cast<uintptr_t>(info->si_addr);
+    for (GuardSlot& slot : g_guards) {
+        uintptr_t begin = slot.begin.load(std::memory_order_acquire);
+        if (begin == 0 || addr < begin || addr >= slot.end.load(std::memory_order_relaxed)) continue;
+        // 文件在映射之后被截断：用全零的匿名页替换出错页，返回后重新执行的访问读到 0
+        slot.truncated.store(true, std::memory_order_release);
+        void* page = reinterpret_cast<void*>(addr & ~(g_page_size - 1));
+        if (::mmap(page, g_page_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED) {
+            errno = saved_errno;
+            return;
+        }
+        break;
+    }
+    // 不是文件映射引起的（或无法修复）：恢复默认处理，返回后重新执行的访问按默认方式终止进程
+    ::signal(sig, SIG_DFL);
+    errno = saved_errno;
+}
+
+void installSigbusHandler() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        g_page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_sigaction = onSigbus;
+        sa.sa_flags = SA_SIGINFO;
+        sigemptyset(&sa.sa_mask);
+        if (::sigaction(SIGBUS, &sa, nullptr) != 0) {
+            LOG_ERROR << "sigaction SIGBUS failed: " << strerror(errno);
+        }
+    });
+}
+
+// 登记映射的地址范围，表满时返回 -1
+int guardMapping(const char* data, size_t size) {
+    for (int i = 0; i < kMaxGuarded; ++i) {
+        bool expected = false;
+        if (!g_guards[i].used.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) continue;
+        uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+        g_guards[i].truncated.store(false, std::memory_order_relaxed);
+        g_guards[i].end.store(begin + size, std::memory_order_relaxed);
+        g_guards[i].begin.store(begin, std::memory_order_release);
+        return i;
+    }
+    return -1;
+}
+
+void unguardMapping(int slot) {
+    g_guards[slot].begin.store(0, std::memory_order_release);
+    g_guards[slot].end.store(0, std::memory_order_relaxed);
+    g_guards[slot].used.store(false, std::memory_order_release);
+}
+
+} // namespace
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::string& path) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return nullptr;
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    auto it = r.files.find(path);
+    if (it != r.files.end()) {
+        std::shared_ptr<const MappedFile> shared = it->second.lock();
+        if (shared && shared->sameFile(st.st_ino, st.st_size, st.st_mtim)) {
+            return shared;
+        }
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    // 以打开的文件为准，stat 之后文件可能已被替换
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    const char* data = nullptr;
+    size_t size = static_cast<size_t>(st.st_size);
+    int slot = -1;
+    if (size > 0) {
+        installSigbusHandler();
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            LOG_ERROR << "mmap " << path << " failed: " << strerror(errno);
+            ::close(fd);
+            return nullptr;
+        }
+        // 整个文件通常顺序发送一次，让内核加大预读并尽早回收已发送的页
+        ::madvise(addr, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(addr);
+        slot = guardMapping(data, size);
+        if (slot < 0) {
+            // 没有保护的映射在文件被截断时会让进程收到 SIGBUS 而退出，宁可让这个请求失败
+            LOG_ERROR << "mmap " << path << " failed: too many mapped files";
+            ::munmap(addr, size);
+            ::close(fd);
+            return nullptr;
+        }
+    }
+    ::close(fd); // 映射建立后不再需要文件描述符
+
+    std::shared_ptr<const MappedFile> mapped(new MappedFile(data, size, slot, st.st_ino, st.st_mtim));
+    // 顺带清理已经没有使用者的记录
+    for (auto i = r.files.begin(); i != r.files.end();) {
+        if (i->second.expired()) i = r.files.erase(i);
+        else ++i;
+    }
+    r.files[path] = mapped;
+    return mapped;
+}
+
+MappedFile::~MappedFile() {
+    if (!data_) return;
+    // 先撤销登记再解除映射，之后这段地址可能被其他映射复用
+    unguardMapping(slot_);
+    ::munmap(const_cast<char*>(data_), size_);
+}
+
+bool MappedFile::truncated() const {
+    return slot_ >= 0 && g_guards[slot_].truncated.load(std::memory_order_acquire);
+}
+
+void MappedFile::willNeed(off_t offset, size_t length) const {
+    if (!data_ || static_cast<size_t>(offset) >= size_) return;
+    // madvise 要求起始地址按页对齐
+    size_t begin = static_cast<size_t>(offset) / pageSize() * pageSize();
+    size_t end = std::min(size_, static_cast<size_t>(offset) + std::min(length, kWillNeedLimit));
+    ::madvise(const_cast<char*>(data_) + begin, end - begin, MADV_WILLNEED);
+}
+
+bool MappedFile::resident(off_t offset, size_t length) const {
+    if (!data_ || length == 0) return true;
+    size_t begin = static_cast<size_t>(offset) / pageSize() * pageSize();
+    size_t end = std::min(size_, static_cast<size_t>(offset) + length);
+    size_t pages = (end - begin + pageSize() - 1) / pageSize();
+    static thread_local std::vector<unsigned char> vec;
+    vec.resize(pages);
+    if (::mincore(const_cast<char*>(data_) + begin, end - begin, vec.data()) != 0) {
+        return true; // 无法判断时按已缓存处理，最坏情况是同步缺页
+    }
+    for (unsigned char v : vec) {
+        if (!(v & 1)) return false;
+    }
+    return true;
+}
+
+void MappedFile::prefault(off_t offset, size_t length) const {
+    if (!data_) return;
+    size_t end = std::min(size_, static_cast<size_t>(offset) + length);
+    volatile char sink = 0;
+    for (size_t pos = static_cast<size_t>(offset); pos < end; pos += pageSize()) {
+        sink = sink + data_[pos];
+    }
+    (void)sink;
+}
+
+size_t MappedFile::pageSize() {
+    static const size_t kPageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return kPageSize;
+}
+
+bool MappedFile::sameFile(ino_t ino, size_t size, const struct timespec& mtime) const {
+    return ino_ == ino && size_ == size && mtime_.tv_sec == mtime.tv_sec && mtime_.tv_nsec == mtime.tv_nsec;
+}
@@ -0,0 +1,164 @@
+#include "http/multipart_parser.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+// 单个 part 头部的大小上限
+const size_t kMaxPartHeaderSize = 8 * 1024;
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+bool startsWithIgnoreCase(std::string_view s, std::string_view prefix) {
+    if (s.size() < prefix.size()) return false;
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        if (::tolower(static_cast<unsigned char>(s[i])) != ::tolower(static_cast<unsigned char>(prefix[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 从 "a=1; b=\"x\"" 形式的参数列表中取出参数值
+std::string headerParam(std::string_view params, std::string_view key) {
+    size_t pos = 0;
+    while (pos < params.size()) {
+        size_t semi = params.find(';', pos);
+        std::string_view item = trim(params.substr(pos, semi == std::string_view::npos ? std::string_view::npos : semi - pos));
+        pos = semi == std::string_view::npos ? params.size() : semi + 1;
+
+        size_t eq = item.find('=');
+        if (eq == std::string_view::npos) continue;
+        std::string_view name = trim(item.substr(0, eq));
+        if (name.size() != key.size() || !startsWithIgnoreCase(name, key)) continue;
+        std::string_view value = trim(item.substr(eq + 1));
+        if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+            value = value.substr(1, value.size() - 2);
+        }
+        return std::string(value);
+    }
+    return "";
+}
+
+} // namespace
+
+MultipartParser::MultipartParser(const std::string& boundary)
+    : delimiter_("\r\n--" + boundary),
+      pending_("\r\n"),
+      state_(kPreamble) {}
+
+std::string MultipartParser::boundaryFromContentType(std::string_view content_type) {
+    if (!startsWithIgnoreCase(content_type, "multipart/form-data")) {
+        return "";
+    }
+    size_t semi = content_type.find(';');
+    if (semi == std::string_view::npos) return "";
+    std::string boundary = headerParam(content_type.substr(semi + 1), "boundary");
+    // RFC 2046：boundary 长度为 1~70
+    return boundary.size() <= 70 ? boundary : "";
+}
+
+bool MultipartParser::feed(const char* data, size_t len) {
+    if (state_ == kError) return false;
+    if (state_ == kDone) return true; // 结束分隔符之后的 epilogue 直接丢弃
+    pending_.append(data, len);
+    if (!process()) {
+        state_ = kError;
+        return false;
+    }
+    return true;
+}
+
+bool MultipartParser::process() {
+    while (true) {
+        switch (state_) {
+        case kPreamble:
+        case kPartData: {
+            size_t pos = pending_.find(delimiter_);
+            if (pos == std::string::npos) {
+                // 保留可能是分隔符前缀的尾部，其余数据可以确定不属于分隔符
+                size_t keep = std::min(pending_.size(), delimiter_.size() - 1);
+                size_t emit = pending_.size() - keep;
+                if (state_ == kPartData && emit > 0 && part_data_callback_ &&
+                    !part_data_callback_(pending_.data(), emit)) {
+                    return false;
+                }
+                pending_.erase(0, emit);
+                return true;
+            }
+            if (state_ == kPartData) {
+                if (pos > 0 && part_data_callback_ && !part_data_callback_(pending_.data(), pos)) {
+                    return false;
+                }
+                if (part_end_callback_ && !part_end_callback_()) {
+                    return false;
+                }
+            }
+            pending_.erase(0, pos + delimiter_.size());
+            state_ = kAfterBoundary;
+            break;
+        }
+        case kAfterBoundary:
+            if (pending_.size() < 2) return true;
+            if (pending_.compare(0, 2, "--") == 0) {
+                state_ = kDone;
+                pending_.clear();
+                return true;
+            }
+            if (pending_.compare(0, 2, "\r\n") != 0) return false;
+            pending_.erase(0, 2);
+            state_ = kPartHeaders;
+            break;
+        case kPartHeaders: {
+            // part 可以没有头部，此时紧跟一个空行
+            size_t end = pending_.compare(0, 2, "\r\n") == 0 ? 0 : pending_.find("\r\n\r\n");
+            if (end == std::string::npos) {
+                return pending_.size() <= kMaxPartHeaderSize;
+            }
+            Part part;
+            if (!parsePartHeaders(std::string_view(pending_).substr(0, end), &part)) {
+                return false;
+            }
+            pending_.erase(0, end == 0 ? 2 : end + 4);
+            if (part_begin_callback_ && !part_begin_callback_(part)) {
+                return false;
+            }
+            state_ = kPartData;
+            break;
+        }
+        case kDone:
+            return true;
+        case kError:
+            return false;
+        }
+    }
+}
+
+bool MultipartParser::parsePartHeaders(std::string_view block, Part* part) const {
+    size_t pos = 0;
+    while (pos < block.size()) {
+        size_t eol = block.find("\r\n", pos);
+        std::string_view line = block.substr(pos, eol == std::string_view::npos ? std::string_view::npos : eol - pos);
+        pos = eol == std::string_view::npos ? block.size() : eol + 2;
+
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos) return false;
+        std::string_view name = trim(line.substr(0, colon));
+        std::string_view value = trim(line.substr(colon + 1));
+        if (name.size() == 19 && startsWithIgnoreCase(name, "Content-Disposition")) {
+            // form-data; name="file"; filename="a.txt"
+            size_t semi = value.find(';');
+            if (semi == std::string_view::npos) continue;
+            std::string_view params = value.substr(semi + 1);
+            part->name = headerParam(params, "name");
+            part->filename = headerParam(params, "filename");
+        } else if (name.size() == 12 && startsWithIgnoreCase(name, "Content-Type")) {
+            part->content_type = std::string(value);
+        }
+    }
+    return true;
+}
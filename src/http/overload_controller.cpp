@@ -0,0 +1,30 @@
+#include "http/overload_controller.h"
+#include <string>
+
+OverloadController& OverloadController::instance() {
+    static OverloadController controller;
+    return controller;
+}
+
+bool OverloadController::admit(const HttpRequest& req, const RouteOptions& route, double lag, HttpResponse* resp) {
+    if (!options_.enabled) {
+        return true;
+    }
+    if (req.deadlineExceeded()) {
+        expired_.fetch_add(1, std::memory_order_relaxed);
+        reject(resp);
+        return false;
+    }
+    if (route.low_priority && lag > options_.max_lag) {
+        shed_.fetch_add(1, std::memory_order_relaxed);
+        reject(resp);
+        return false;
+    }
+    return true;
+}
+
+void OverloadController::reject(HttpResponse* resp) const {
+    resp->setStatusCode(HttpResponse::k503ServiceUnavailable);
+    resp->addHeader(HttpResponse::kRetryAfter, std::to_string(options_.retry_after));
+    resp->setContentLength(0);
+}
@@ -0,0 +1,126 @@
+#include "http/precompressed_cache.h"
+#include "mime_types.h"
+#include "utils/logger.h"
+#include "utils/disk_io_pool.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+namespace {
+
+// 压缩只做一次，直接使用最高压缩级别
+const int kGzipLevel = 9;
+const int kBrotliQuality = 11;
+
+bool readFile(const std::string& path, std::string* content) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file) return false;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    *content = buffer.str();
+    return true;
+}
+
+// 不旧于源文件的 .gz / .br 同名文件
+bool readSibling(const std::string& path, time_t mtime, std::string* content) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode) || st.st_mtime < mtime) {
+        return false;
+    }
+    return readFile(path, content);
+}
+
+} // namespace
+
+const std::string* PrecompressedCache::Variants::get(Compression::Encoding encoding) const {
+    const std::string* variant = nullptr;
+    if (encoding == Compression::kGzip) variant = &gzip;
+    if (encoding == Compression::kBrotli) variant = &brotli;
+    return variant && !variant->empty() ? variant : nullptr;
+}
+
+PrecompressedCache& PrecompressedCache::instance() {
+    static PrecompressedCache cache;
+    return cache;
+}
+
+std::shared_ptr<const PrecompressedCache::Variants> PrecompressedCache::get(const std::string& path, time_t mtime,
+                                                                            size_t size, const std::string* content) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(path);
+        if (it != entries_.end() && it->second->mtime == mtime && it->second->size == size) {
+            return it->second;
+        }
+    }
+    if (!content) return nullptr;
+
+    // 压缩在锁外进行，同一文件被并发首次请求时可能重复压缩，结果相同
+    std::shared_ptr<const Variants> variants = build(path, mtime, size, *content);
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_[path] = variants;
+    return variants;
+}
+
+std::shared_ptr<const PrecompressedCache::Variants> PrecompressedCache::build(const std::string& path, time_t mtime,
+                                                                              size_t size, const std::string& content) const {
+    auto variants = std::make_shared<Variants>();
+    variants->mtime = mtime;
+    variants->size = size;
+    if (!readSibling(path + ".gz", mtime, &variants->gzip) &&
+        !Compression::gzip(content, &variants->gzip, kGzipLevel)) {
+        variants->gzip.clear();
+    }
+    if (!readSibling(path + ".br", mtime, &variants->brotli) &&
+        !Compression::brotli(content, &variants->brotli, kBrotliQuality)) {
+        variants->brotli.clear();
+    }
+    // 没有变小的变体不值得发送
+    if (variants->gzip.size() >= content.size()) variants->gzip.clear();
+    if (variants->brotli.size() >= content.size()) variants->brotli.clear();
+    LOG_DEBUG << "Precompressed " << path << ": " << content.size() << " -> gzip " << variants->gzip.size()
+              << ", br " << variants->brotli.size();
+    return variants;
+}
+
+void PrecompressedCache::buildAsync(const std::string& path, time_t mtime, size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!building_.insert(path).second) return;
+    }
+    DiskIoPool::instance().submit([this, path, mtime, size]() {
+        // 读出的内容须与请求时的文件一致，文件已变化时放弃，由之后的请求重新触发
+        struct stat st;
+        std::string content;
+        if (::stat(path.c_str(), &st) == 0 && st.st_mtime == mtime && static_cast<size_t>(st.st_size) == size &&
+            readFile(path, &content) && content.size() == size) {
+            get(path, mtime, size, &content);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        building_.erase(path);
+    });
+}
+
+void PrecompressedCache::warmUp(const std::string& root) {
+    std::error_code ec;
+    size_t count = 0;
+    for (auto it = std::filesystem::recursive_directory_iterator(root, ec);
+         !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file(ec)) continue;
+        // 与静态文件处理器使用的规范化路径保持一致，缓存才能命中
+        std::string path = std::filesystem::weakly_canonical(it->path(), ec).string();
+        if (ec) continue;
+        if (!MimeTypes::isCompressible(MimeTypes::getMimeType(it->path().extension().string()))) continue;
+
+        struct stat st;
+        std::string content;
+        if (::stat(path.c_str(), &st) != 0 || static_cast<size_t>(st.st_size) < kMinCompressSize ||
+            !readFile(path, &content)) {
+            continue;
+        }
+        get(path, st.st_mtime, content.size(), &content);
+        ++count;
+    }
+    LOG_INFO << "Precompressed " << count << " static files under " << root;
+}
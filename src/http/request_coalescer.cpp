@@ -0,0 +1,78 @@
+#include "http/request_coalescer.h"
+#include "utils/logger.h"
+
+RequestCoalescer& RequestCoalescer::instance() {
+    static RequestCoalescer coalescer;
+    return coalescer;
+}
+
+std::string RequestCoalescer::key(const HttpRequest& req) {
+    if (req.getMethod() != HttpRequest::GET) return std::string();
+    std::string key;
+    key.reserve(4 + req.getPath().size() + 1 + req.getQuery().size());
+    key.append("GET ").append(req.getPath());
+    if (!req.getQuery().empty()) key.append("?").append(req.getQuery());
+    return key;
+}
+
+bool RequestCoalescer::join(const std::string& key, const Waiter& waiter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = flights_.find(key);
+    if (it == flights_.end()) {
+        flights_.emplace(key, std::vector<Waiter>());
+        return false;
+    }
+    it->second.push_back(waiter);
+    return true;
+}
+
+void RequestCoalescer::lead(const std::string& key, const Handler& handler, HttpResponse* resp) {
+    // 处理函数抛出异常时也要结束这次执行，否则等待者永远得不到结果，之后的相同请求也都会排在它后面
+    struct Finish {
+        RequestCoalescer* self;
+        const std::string& key;
+        const HttpResponse* resp; // 处理函数没有正常返回时为 nullptr
+        ~Finish() { self->finish(key, resp); }
+    } finish{this, key, nullptr};
+    handler(resp);
+    finish.resp = resp;
+}
+
+void RequestCoalescer::finish(const std::string& key, const HttpResponse* resp) {
+    std::vector<Waiter> waiters;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = flights_.find(key);
+        if (it != flights_.end()) {
+            waiters.swap(it->second);
+            flights_.erase(it);
+        }
+    }
+    if (waiters.empty()) return;
+
+    // 没有可共享的结果时等待者各自执行处理函数
+    Result result;
+    if (resp && !resp->isStreaming() && !resp->getUpgradeHandler()) {
+        result = std::make_shared<const HttpResponse>(*resp);
+    }
+    LOG_DEBUG << "Coalesced " << waiters.size() << " requests for " << key;
+    for (const auto& waiter : waiters) {
+        waiter(result);
+    }
+}
+
+void RequestCoalescer::run(const std::string& key, const Handler& handler, HttpResponse* resp) {
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        first = flights_.emplace(key, std::vector<Waiter>()).second;
+    }
+    if (!first) {
+        handler(resp);
+        return;
+    }
+    // 在独立的响应中执行，结果不带本会话已设置的头部，可以原样交给其他连接
+    HttpResponse fresh;
+    lead(key, handler, &fresh);
+    resp->assignFrom(fresh);
+}
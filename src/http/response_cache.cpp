@@ -0,0 +1,121 @@
+#include "http/response_cache.h"
+#include "http/dynamic_compression.h"
+#include "utils/logger.h"
+
+ResponseCache& ResponseCache::instance() {
+    static ResponseCache cache;
+    return cache;
+}
+
+void ResponseCache::addTags(const std::vector<std::string>& tags) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& tag : tags) {
+        tags_.emplace(tag, 0);
+    }
+}
+
+void ResponseCache::invalidate(const std::string& db_key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& tag : tags_) {
+        if (db_key.compare(0, tag.first.size(), tag.first) == 0) {
+            ++tag.second;
+        }
+    }
+}
+
+bool ResponseCache::tagsUnchanged(const RouteOptions& route, const std::vector<uint64_t>& generations) const {
+    for (size_t i = 0; i < route.cache_tags.size(); ++i) {
+        auto it = tags_.find(route.cache_tags[i]);
+        if (it == tags_.end() || it->second != generations[i]) return false;
+    }
+    return true;
+}
+
+bool ResponseCache::lookup(const std::string& key, const RouteOptions& route, const HttpRequest& req,
+                           HttpResponse* resp, double load, Ticket* ticket) {
+    if (!options_.enabled) return false;
+    Compression::Encoding encoding = Compression::negotiate(req.header(HttpRequest::kAcceptEncoding));
+    std::shared_ptr<const HttpResponse> response;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ticket->generations.clear();
+        for (const auto& tag : route.cache_tags) {
+            auto it = tags_.find(tag);
+            ticket->generations.push_back(it == tags_.end() ? 0 : it->second);
+        }
+        auto it = entries_.find(key);
+        if (it == entries_.end()) return false;
+        Entry& entry = it->second;
+        Timestamp now = Timestamp::now();
+        if (!tagsUnchanged(route, entry.generations) || entry.stale_until < now) {
+            entries_.erase(it);
+            return false;
+        }
+        if (entry.expires < now && !entry.refreshing) {
+            // 过期但仍可使用：本请求重新生成，其余请求在此期间继续得到旧响应
+            entry.refreshing = true;
+            return false;
+        }
+        if (encoding != Compression::kIdentity && entry.encoded[encoding]) {
+            resp->assignFrom(*entry.encoded[encoding]);
+            return true;
+        }
+        response = entry.response;
+    }
+
+    if (encoding == Compression::kIdentity) {
+        resp->assignFrom(*response);
+        return true;
+    }
+    // 第一次以该编码命中：在独立的响应中压缩，不带本连接的头部，保存后供之后的命中直接使用
+    HttpResponse variant;
+    variant.assignFrom(*response);
+    DynamicCompression::instance().apply(req, &variant, load);
+    resp->assignFrom(variant);
+    if (variant.getHeader(HttpResponse::kContentEncoding) == Compression::encodingName(encoding)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        // 条目可能已在压缩期间被替换
+        if (it != entries_.end() && it->second.response == response) {
+            it->second.encoded[encoding] = std::make_shared<const HttpResponse>(std::move(variant));
+        }
+    }
+    return true;
+}
+
+void ResponseCache::store(const std::string& key, const RouteOptions& route, const Ticket& ticket,
+                          const HttpResponse& resp) {
+    if (!options_.enabled) return;
+    bool cacheable = resp.getStatusCode() == HttpResponse::k200Ok && !resp.isStreaming() &&
+                     !resp.getUpgradeHandler() && resp.getBody().size() <= options_.max_body_size &&
+                     ticket.generations.size() == route.cache_tags.size();
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (!cacheable || !tagsUnchanged(route, ticket.generations)) {
+        // 不能缓存或执行期间数据已变化：放弃这次结果，让下一个请求重新生成
+        if (it != entries_.end()) it->second.refreshing = false;
+        return;
+    }
+    Timestamp now = Timestamp::now();
+    if (it == entries_.end()) {
+        if (entries_.size() >= options_.max_entries) evict(now);
+        it = entries_.emplace(key, Entry()).first;
+    }
+    Entry& entry = it->second;
+    entry.response = std::make_shared<const HttpResponse>(resp);
+    entry.encoded.fill(nullptr);
+    entry.expires = addTime(now, route.cache_ttl);
+    entry.stale_until = addTime(entry.expires, route.cache_stale);
+    entry.generations = ticket.generations;
+    entry.refreshing = false;
+}
+
+void ResponseCache::evict(Timestamp now) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.stale_until < now) it = entries_.erase(it);
+        else ++it;
+    }
+    if (entries_.size() >= options_.max_entries && !entries_.empty()) {
+        entries_.erase(entries_.begin());
+    }
+}
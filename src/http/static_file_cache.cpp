@@ -0,0 +1,192 @@
+#include "http/static_file_cache.h"
+#include "net/event_loop.h"
+#include "net/channel.h"
+#include "utils/logger.h"
+#include <filesystem>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+const uint32_t kWatchMask = IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE |
+                            IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+bool endsWith(const std::string& s, const char* suffix) {
+    size_t n = ::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+} // namespace
+
+const std::string& StaticFileCache::Entry::etagFor(Compression::Encoding encoding) const {
+    if (encoding == Compression::kGzip) return gzip_etag;
+    if (encoding == Compression::kBrotli) return br_etag;
+    return etag;
+}
+
+std::string_view StaticFileCache::Entry::variant(Compression::Encoding encoding) const {
+    if (encoding == Compression::kGzip) return gzip;
+    if (encoding == Compression::kBrotli) return brotli;
+    return std::string_view();
+}
+
+size_t StaticFileCache::Entry::charge() const {
+    return file_path.size() + mime_type.size() + 256 + content.size() + gzip.size() + brotli.size();
+}
+
+StaticFileCache& StaticFileCache::instance() {
+    static StaticFileCache cache;
+    return cache;
+}
+
+void StaticFileCache::setOptions(const Options& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_ = options;
+    while (charged_ > options_.budget && !lru_.empty()) {
+        eraseLocked(entries_.find(lru_.back()));
+    }
+}
+
+std::shared_ptr<const StaticFileCache::Entry> StaticFileCache::lookup(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(path);
+    if (it == entries_.end()) return nullptr;
+    lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+    return it->second.entry;
+}
+
+uint64_t StaticFileCache::generation() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+}
+
+void StaticFileCache::insert(const std::string& path, std::shared_ptr<const Entry> entry, uint64_t generation) {
+    size_t charge = entry->charge();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation != generation_ || charge > options_.budget) return;
+    auto it = entries_.find(path);
+    if (it != entries_.end()) eraseLocked(it);
+    while (charged_ + charge > options_.budget && !lru_.empty()) {
+        eraseLocked(entries_.find(lru_.back()));
+    }
+    lru_.push_front(path);
+    entries_[path] = Slot{std::move(entry), lru_.begin()};
+    charged_ += charge;
+}
+
+void StaticFileCache::invalidateFile(const std::string& file_path) {
+    // 修改 .gz / .br 同名文件会改变源文件的压缩变体
+    std::string source = file_path;
+    if (endsWith(source, ".gz")) source.resize(source.size() - 3);
+    else if (endsWith(source, ".br")) source.resize(source.size() - 3);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    // 一个文件可能对应多个请求路径（如 / 与 /index.html），变化不频繁，直接遍历
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        auto next = std::next(it);
+        const std::string& cached = it->second.entry->file_path;
+        if (cached == file_path || cached == source) eraseLocked(it);
+        it = next;
+    }
+}
+
+void StaticFileCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    entries_.clear();
+    lru_.clear();
+    charged_ = 0;
+}
+
+void StaticFileCache::eraseLocked(std::unordered_map<std::string, Slot>::iterator it) {
+    charged_ -= it->second.entry->charge();
+    lru_.erase(it->second.lru_it);
+    entries_.erase(it);
+}
+
+StaticFileWatcher::StaticFileWatcher(EventLoop* loop, const std::string& root)
+    : loop_(loop),
+      inotify_fd_(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {
+    if (inotify_fd_ < 0) {
+        LOG_ERROR << "inotify_init1 failed: " << strerror(errno);
+        return;
+    }
+    std::error_code ec;
+    std::string canonical = std::filesystem::weakly_canonical(root, ec).string();
+    addWatches(ec ? root : canonical);
+    channel_ = std::make_unique<Channel>(loop_, inotify_fd_);
+    channel_->setReadCallback(std::bind(&StaticFileWatcher::handleRead, this));
+    channel_->enableReading();
+    LOG_INFO << "Watching " << watch_dirs_.size() << " directories under " << root << " for static file changes";
+}
+
+StaticFileWatcher::~StaticFileWatcher() {
+    if (channel_) {
+        loop_->assertInLoopThread();
+        channel_->disableAll();
+        channel_->remove();
+    }
+    if (inotify_fd_ >= 0) ::close(inotify_fd_);
+}
+
+void StaticFileWatcher::addWatches(const std::string& dir) {
+    int wd = ::inotify_add_watch(inotify_fd_, dir.c_str(), kWatchMask);
+    if (wd < 0) {
+        LOG_WARN << "inotify_add_watch " << dir << " failed: " << strerror(errno);
+        return;
+    }
+    watch_dirs_[wd] = dir;
+    std::error_code ec;
+    for (auto it = std::filesystem::directory_iterator(dir, ec);
+         !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        if (it->is_directory(ec) && !it->is_symlink(ec)) {
+            addWatches(it->path().string());
+        }
+    }
+}
+
+void StaticFileWatcher::handleRead() {
+    // inotify 事件按 struct inotify_event 对齐
+    alignas(struct inotify_event) char buf[16 * 1024];
+    while (true) {
+        ssize_t n = ::read(inotify_fd_, buf, sizeof(buf));
+        if (n <= 0) {
+            if (n < 0 && errno != EAGAIN && errno != EINTR) {
+                LOG_ERROR << "read inotify failed: " << strerror(errno);
+            }
+            if (n < 0 && errno == EINTR) continue;
+            return;  // 边缘触发，读到 EAGAIN 为止
+        }
+        for (char* p = buf; p < buf + n;) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                // 事件丢失，无法知道哪些文件变了
+                LOG_WARN << "inotify queue overflow, dropping static file cache";
+                StaticFileCache::instance().clear();
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                watch_dirs_.erase(event->wd);
+                continue;
+            }
+            auto it = watch_dirs_.find(event->wd);
+            if (it == watch_dirs_.end()) continue;
+            if ((event->mask & IN_ISDIR) || (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF))) {
+                // 目录的增删和改名影响其下所有路径，新目录需要补上监视
+                if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && event->len > 0) {
+                    addWatches(it->second + "/" + event->name);
+                }
+                StaticFileCache::instance().clear();
+                continue;
+            }
+            if (event->len > 0) {
+                StaticFileCache::instance().invalidateFile(it->second + "/" + event->name);
+            }
+        }
+    }
+}
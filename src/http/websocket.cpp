@@ -0,0 +1,371 @@
+#include "http/websocket.h"
+#include "connection.h"
+#include "net/event_loop.h"
+#include "utils/logger.h"
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#include <cstring>
+
+namespace {
+
+// RFC 6455 1.3：Sec-WebSocket-Accept = base64(SHA-1(key + GUID))
+const char kHandshakeGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (::tolower(static_cast<unsigned char>(a[i])) != ::tolower(static_cast<unsigned char>(b[i]))) return false;
+    }
+    return true;
+}
+
+// 逗号分隔的头部值（如 Connection: keep-alive, Upgrade）中是否含有 token
+bool hasToken(std::string_view value, std::string_view token) {
+    while (!value.empty()) {
+        size_t comma = value.find(',');
+        std::string_view item = value.substr(0, comma);
+        while (!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+        while (!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+        if (equalsIgnoreCase(item, token)) return true;
+        if (comma == std::string_view::npos) break;
+        value.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+std::string acceptKey(std::string_view key) {
+    std::string input(key);
+    input += kHandshakeGuid;
+    unsigned char digest[SHA_DIGEST_LENGTH];
+    SHA1(reinterpret_cast<const unsigned char*>(input.data()), input.size(), digest);
+    unsigned char encoded[4 * ((SHA_DIGEST_LENGTH + 2) / 3) + 1];
+    int len = EVP_EncodeBlock(encoded, digest, SHA_DIGEST_LENGTH);
+    return std::string(reinterpret_cast<const char*>(encoded), len);
+}
+
+// 客户端帧的掩码按 8 字节一组异或，掩码键重复两次拼成一个字
+void unmask(char* data, size_t len, const unsigned char key[4]) {
+    unsigned char key8[8];
+    memcpy(key8, key, 4);
+    memcpy(key8 + 4, key, 4);
+    uint64_t word_key;
+    memcpy(&word_key, key8, 8);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        word ^= word_key;
+        memcpy(data + i, &word, 8);
+    }
+    for (; i < len; ++i) {
+        data[i] ^= key[i & 3];
+    }
+}
+
+// 文本消息必须是合法的 UTF-8（RFC 6455 8.1），拒绝过长编码和代理区码点
+bool isValidUtf8(std::string_view s) {
+    static const uint32_t kMinCodePoint[] = {0, 0, 0x80, 0x800, 0x10000};
+    size_t i = 0;
+    const size_t n = s.size();
+    while (i < n) {
+        // ASCII 部分一次检查 8 字节
+        if (i + 8 <= n) {
+            uint64_t word;
+            memcpy(&word, s.data() + i, 8);
+            if ((word & 0x8080808080808080ULL) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c < 0x80) {
+            ++i;
+            continue;
+        }
+        size_t len;
+        uint32_t cp;
+        if ((c & 0xE0) == 0xC0) { len = 2; cp = c & 0x1F; }
+        else if ((c & 0xF0) == 0xE0) { len = 3; cp = c & 0x0F; }
+        else if ((c & 0xF8) == 0xF0) { len = 4; cp = c & 0x07; }
+        else return false;
+        if (len > n - i) return false;
+        for (size_t k = 1; k < len; ++k) {
+            unsigned char cc = static_cast<unsigned char>(s[i + k]);
+            if ((cc & 0xC0) != 0x80) return false;
+            cp = (cp << 6) | (cc & 0x3F);
+        }
+        if (cp < kMinCodePoint[len] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return false;
+        i += len;
+    }
+    return true;
+}
+
+void reject(HttpResponse* resp, int status, const char* message) {
+    resp->setStatusCode(static_cast<HttpResponse::HttpStatusCode>(status));
+    resp->setContentType("text/plain; charset=utf-8");
+    resp->setBody(message);
+    resp->setContentLength(resp->getBody().length());
+}
+
+} // namespace
+
+bool WebSocketSession::accept(const HttpRequest& req, HttpResponse* resp, const std::string& topic,
+                              MessageHandler handler) {
+    // HTTP/2 上的 WebSocket（RFC 8441）不支持，这类请求没有 Upgrade 头部，按普通请求拒绝
+    if (req.getMethod() != HttpRequest::GET || req.getVersion() != "HTTP/1.1" ||
+        !hasToken(req.header(HttpRequest::kConnection), "upgrade") ||
+        !equalsIgnoreCase(req.header(HttpRequest::kUpgrade), "websocket")) {
+        resp->addHeader("Upgrade", "websocket");
+        reject(resp, HttpResponse::k426UpgradeRequired, "WebSocket upgrade required");
+        return false;
+    }
+    if (req.getHeader("Sec-WebSocket-Version") != "13") {
+        resp->addHeader("Sec-WebSocket-Version", "13");
+        reject(resp, HttpResponse::k426UpgradeRequired, "Unsupported WebSocket version");
+        return false;
+    }
+    // 客户端的 key 是 16 字节随机数的 base64
+    std::string key = req.getHeader("Sec-WebSocket-Key");
+    if (key.size() != 24 || key.compare(22, 2, "==") != 0) {
+        reject(resp, HttpResponse::k400BadRequest, "Invalid Sec-WebSocket-Key");
+        return false;
+    }
+
+    resp->setStatusCode(HttpResponse::k101SwitchingProtocols);
+    resp->addHeader("Upgrade", "websocket");
+    resp->addHeader("Sec-WebSocket-Accept", acceptKey(key));
+    size_t max_message_size = WebSocketHub::instance().options().max_message_size;
+    resp->setUpgradeHandler([topic, handler, max_message_size](const std::shared_ptr<Connection>& conn) {
+        conn->setContext(std::make_shared<WebSocketSession>(handler, max_message_size));
+        if (!topic.empty()) {
+            WebSocketHub::instance().subscribe(conn, topic);
+        }
+    });
+    return true;
+}
+
+void WebSocketSession::appendFrame(Opcode opcode, std::string_view payload, Buffer* output) {
+    unsigned char header[10];
+    size_t header_len = 2;
+    size_t len = payload.size();
+    header[0] = 0x80 | opcode; // 服务端不分片，FIN 总是置位
+    if (len < 126) {
+        header[1] = static_cast<unsigned char>(len);
+    } else if (len <= 0xFFFF) {
+        header[1] = 126;
+        header[2] = static_cast<unsigned char>(len >> 8);
+        header[3] = static_cast<unsigned char>(len);
+        header_len = 4;
+    } else {
+        header[1] = 127;
+        for (int i = 0; i < 8; ++i) {
+            header[2 + i] = static_cast<unsigned char>(static_cast<uint64_t>(len) >> (56 - 8 * i));
+        }
+        header_len = 10;
+    }
+    output->ensureWritableBytes(header_len + len);
+    output->append(reinterpret_cast<const char*>(header), header_len);
+    output->append(payload.data(), len);
+}
+
+void WebSocketSession::appendClose(CloseCode code, Buffer* output) {
+    char payload[2] = {static_cast<char>(code >> 8), static_cast<char>(code & 0xFF)};
+    appendFrame(kClose, std::string_view(payload, 2), output);
+}
+
+WebSocketSession* WebSocketSession::get(const std::shared_ptr<Connection>& conn) {
+    auto* session = std::any_cast<std::shared_ptr<WebSocketSession>>(conn->getMutableContext());
+    return session ? session->get() : nullptr;
+}
+
+WebSocketSession::WebSocketSession(MessageHandler handler, size_t max_message_size)
+    : handler_(std::move(handler)),
+      max_message_size_(max_message_size),
+      message_opcode_(kContinuation),
+      closing_(false),
+      last_received_(Timestamp::now()),
+      ping_outstanding_(false) {}
+
+bool WebSocketSession::onData(Buffer* input, Buffer* output) {
+    if (closing_) {
+        input->retrieveAll();
+        return false;
+    }
+    while (input->readableBytes() >= 2) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(input->peek());
+        size_t available = input->readableBytes();
+        bool fin = p[0] & 0x80;
+        bool rsv = p[0] & 0x70;
+        Opcode opcode = static_cast<Opcode>(p[0] & 0x0F);
+        bool masked = p[1] & 0x80;
+        uint64_t len = p[1] & 0x7F;
+        size_t header_len = 2;
+        if (len == 126) {
+            header_len = 4;
+            if (available < header_len) break;
+            len = (static_cast<uint64_t>(p[2]) << 8) | p[3];
+        } else if (len == 127) {
+            header_len = 10;
+            if (available < header_len) break;
+            len = 0;
+            for (int i = 0; i < 8; ++i) len = (len << 8) | p[2 + i];
+        }
+
+        // 没有协商扩展，RSV 位必须为 0；客户端发出的帧必须加掩码
+        if (rsv || !masked) return fail(kProtocolError, output);
+        bool control = opcode & 0x8;
+        if (control) {
+            if (!fin || len > 125 || (opcode != kClose && opcode != kPing && opcode != kPong)) {
+                return fail(kProtocolError, output);
+            }
+        } else if (opcode > kBinary) {
+            return fail(kProtocolError, output);
+        } else if ((opcode == kContinuation) != (message_opcode_ != kContinuation)) {
+            // 续帧必须接在未完成的消息后，新消息不能插在分片之间
+            return fail(kProtocolError, output);
+        } else if (len > max_message_size_ - message_.size()) {
+            // 在载荷到齐之前判断，不为超长的消息缓存数据
+            return fail(kMessageTooBig, output);
+        }
+
+        header_len += 4; // 掩码键
+        if (available < header_len || available - header_len < len) break;
+        const unsigned char* key = p + header_len - 4;
+        const char* data = input->peek() + header_len;
+        if (control) {
+            control_payload_.assign(data, len);
+            unmask(&control_payload_[0], len, key);
+        } else {
+            size_t offset = message_.size();
+            message_.append(data, len);
+            unmask(&message_[offset], len, key);
+        }
+        input->retrieve(header_len + len);
+
+        last_received_ = Timestamp::now();
+        ping_outstanding_ = false;
+        if (!handleFrame(opcode, fin, output)) return false;
+    }
+    return true;
+}
+
+bool WebSocketSession::handleFrame(Opcode opcode, bool fin, Buffer* output) {
+    switch (opcode) {
+    case kPing:
+        appendFrame(kPong, control_payload_, output);
+        return true;
+    case kPong:
+        return true;
+    case kClose:
+        return handleClose(control_payload_, output);
+    default:
+        break;
+    }
+    if (opcode != kContinuation) message_opcode_ = opcode;
+    if (!fin) return true;
+    Opcode type = message_opcode_;
+    message_opcode_ = kContinuation;
+    if (type == kText && !isValidUtf8(message_)) {
+        return fail(kInvalidPayload, output);
+    }
+    if (handler_) {
+        handler_(type, message_, output);
+    }
+    message_.clear();
+    return true;
+}
+
+bool WebSocketSession::handleClose(std::string_view payload, Buffer* output) {
+    closing_ = true;
+    if (payload.empty()) {
+        appendFrame(kClose, std::string_view(), output);
+        return false;
+    }
+    if (payload.size() < 2) return fail(kProtocolError, output);
+    uint16_t code = static_cast<uint16_t>((static_cast<unsigned char>(payload[0]) << 8) |
+                                          static_cast<unsigned char>(payload[1]));
+    // 1004~1006、1015 等保留码不能出现在 Close 帧中
+    bool valid = (code >= 1000 && code <= 1003) || (code >= 1007 && code <= 1011) || (code >= 3000 && code <= 4999);
+    if (!valid) return fail(kProtocolError, output);
+    if (!isValidUtf8(payload.substr(2))) return fail(kInvalidPayload, output);
+    // 回应对端的状态码，完成关闭握手
+    appendFrame(kClose, payload.substr(0, 2), output);
+    return false;
+}
+
+bool WebSocketSession::fail(CloseCode code, Buffer* output) {
+    LOG_INFO << "WebSocket closing with code " << code;
+    appendClose(code, output);
+    closing_ = true;
+    message_.clear();
+    return false;
+}
+
+bool WebSocketSession::heartbeat(double interval, Buffer* output) {
+    if (closing_) return true;
+    if (ping_outstanding_) return false;
+    if (timeDifference(Timestamp::now(), last_received_) >= interval) {
+        appendFrame(kPing, std::string_view(), output);
+        ping_outstanding_ = true;
+    }
+    return true;
+}
+
+WebSocketHub& WebSocketHub::instance() {
+    static WebSocketHub hub;
+    return hub;
+}
+
+void WebSocketHub::subscribe(const std::shared_ptr<Connection>& conn, const std::string& topic) {
+    EventLoop* loop = conn->getLoop();
+    loop->assertInLoopThread();
+    std::shared_ptr<Subscribers> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::shared_ptr<Subscribers>& slot = loops_[loop];
+        if (!slot) slot = std::make_shared<Subscribers>();
+        subscribers = slot;
+    }
+    (*subscribers)[topic].push_back(conn);
+}
+
+void WebSocketHub::publish(const std::string& topic, std::string_view payload, WebSocketSession::Opcode opcode) {
+    Buffer buf;
+    WebSocketSession::appendFrame(opcode, payload, &buf);
+    SharedBuffer frame(buf.retrieveAllAsString());
+
+    std::vector<std::pair<EventLoop*, std::shared_ptr<Subscribers>>> targets;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        targets.assign(loops_.begin(), loops_.end());
+    }
+    size_t max_pending_output = options_.max_pending_output;
+    for (auto& target : targets) {
+        // 总是排队执行：发布者可能正处于某个连接的消息回调中，此时写出会混入该连接暂存的响应批次
+        target.first->queueInLoop([subscribers = target.second, topic, frame, max_pending_output]() {
+            deliver(subscribers.get(), topic, frame, max_pending_output);
+        });
+    }
+}
+
+void WebSocketHub::deliver(Subscribers* subscribers, const std::string& topic,
+                           const SharedBuffer& frame, size_t max_pending_output) {
+    auto it = subscribers->find(topic);
+    if (it == subscribers->end()) return;
+    std::vector<std::weak_ptr<Connection>>& conns = it->second;
+    size_t kept = 0;
+    for (size_t i = 0; i < conns.size(); ++i) {
+        std::shared_ptr<Connection> conn = conns[i].lock();
+        if (!conn || !conn->connected() || !WebSocketSession::get(conn)) continue;
+        if (conn->outputBytes() > max_pending_output) {
+            LOG_WARN << "WebSocket subscriber " << conn->getPeerAddrStr() << " is too slow, closing";
+            conn->forceClose();
+            continue;
+        }
+        // 各连接引用同一份帧，内核写不下的部分也只排队引用，不为每个接收者拷贝
+        conn->send(frame);
+        conns[kept++] = conns[i];
+    }
+    conns.resize(kept);
+    if (conns.empty()) subscribers->erase(it);
+}
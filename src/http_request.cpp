@@ -1,156 +1,474 @@
 #include "http_request.h"
 #include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <sstream>
 #include <iostream>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-HttpRequest::HttpRequest(){
+namespace {
+
+// 常用头部的规范名，顺序与 HttpRequest::HeaderId 一致
+const std::string_view kKnownHeaderNames[HttpRequest::kHeaderIdCount] = {
+    "Host", "Connection", "Content-Length", "Content-Type", "Transfer-Encoding",
+    "Accept-Encoding", "If-None-Match", "If-Modified-Since", "Range", "If-Range",
+    "Cookie", "User-Agent", "Accept", "Expect", "Upgrade",
+};
+
+inline char asciiLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+HttpRequest::Limits g_limits;
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (asciiLower(a[i]) != asciiLower(b[i])) return false;
+    }
+    return true;
+}
+
+bool startsWithIgnoreCase(std::string_view s, std::string_view prefix) {
+    return s.size() >= prefix.size() && equalsIgnoreCase(s.substr(0, prefix.size()), prefix);
+}
+
+// 返回 [begin, end) 中第一个等于 a 或 b 的字节，没有则返回 end
+// SSE2 是 x86-64 的基线指令集，每次比较 16 字节；其他平台退化为逐字节扫描
+const char* findEither(const char* begin, const char* end, char a, char b) {
+#if defined(__SSE2__)
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    while (end - begin >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 16;
+    }
+#endif
+    for (; begin < end; ++begin) {
+        if (*begin == a || *begin == b) return begin;
+    }
+    return end;
+}
+
+// 在 [begin, end) 中查找 CRLF，出现单独的 CR 或 LF 视为格式错误
+// @return: 指向 '\r' 的指针；没有找到返回 end；格式错误返回 nullptr
+const char* findCRLF(const char* begin, const char* end) {
+    const char* p = findEither(begin, end, '\r', '\n');
+    if (p == end) return end;
+    if (*p != '\r' || p + 1 == end || p[1] != '\n') return nullptr;
+    return p;
+}
+
+std::string_view trimView(const char* begin, const char* end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) --end;
+    return std::string_view(begin, end - begin);
+}
+
+inline int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+inline bool hasEscape(std::string_view s) {
+    return findEither(s.data(), s.data() + s.size(), '%', '+') != s.data() + s.size();
+}
+
+// URL 解码：out 至少有 in.size() 字节，返回解码后的长度
+// 转义之间的普通字节由 findEither 按 16 字节一组找到边界后整段拷贝；% 后不是两位十六进制数时原样保留
+size_t percentDecode(std::string_view in, char* out) {
+    const char* p = in.data();
+    const char* end = p + in.size();
+    char* o = out;
+    while (p < end) {
+        const char* escape = findEither(p, end, '%', '+');
+        std::memcpy(o, p, escape - p);
+        o += escape - p;
+        p = escape;
+        if (p == end) break;
+        if (*p == '+') {
+            *o++ = ' ';
+            ++p;
+        } else if (end - p >= 3 && hexValue(p[1]) >= 0 && hexValue(p[2]) >= 0) {
+            *o++ = static_cast<char>(hexValue(p[1]) << 4 | hexValue(p[2]));
+            p += 3;
+        } else {
+            *o++ = *p++;
+        }
+    }
+    return o - out;
+}
+
+// 解码结果写入 out，复用其已有的容量；只有包含转义字符时才需要解码，否则直接拷贝
+void assignDecoded(std::string_view s, std::string* out) {
+    if (!hasEscape(s)) {
+        out->assign(s.data(), s.size());
+        return;
+    }
+    out->resize(s.size());
+    out->resize(percentDecode(s, &(*out)[0]));
+}
+
+} // namespace
+
+void UrlParams::assign(std::string_view raw) {
+    raw_ = raw;
+    indexed_ = false;
+    // 换成空容器，丢弃从内存池分配的存储
+    entries_ = decltype(entries_)(entries_.get_allocator());
+}
+
+void UrlParams::buildIndex() const {
+    indexed_ = true;
+    std::pmr::memory_resource* arena = entries_.get_allocator().resource();
+    auto decode = [arena](std::string_view s) {
+        if (!hasEscape(s)) return s;
+        char* buf = static_cast<char*>(arena->allocate(s.size(), 1));
+        return std::string_view(buf, percentDecode(s, buf));
+    };
+    size_t start = 0;
+    while (start < raw_.size()) {
+        size_t end = raw_.find('&', start);
+        if (end == std::string_view::npos) end = raw_.size();
+        std::string_view pair = raw_.substr(start, end - start);
+        start = end + 1;
+        if (pair.empty()) continue;
+        // 没有 '=' 的参数（如 ?debug）值为空
+        size_t eq = pair.find('=');
+        std::string_view name = pair.substr(0, eq);
+        std::string_view value = eq == std::string_view::npos ? std::string_view() : pair.substr(eq + 1);
+        entries_.emplace_back(decode(name), decode(value));
+    }
+}
+
+bool UrlParams::get(std::string_view name, std::string_view* value) const {
+    if (!indexed_) buildIndex();
+    for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+        if (it->first == name) {
+            *value = it->second;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string_view UrlParams::get(std::string_view name) const {
+    std::string_view value;
+    get(name, &value);
+    return value;
+}
+
+bool UrlParams::has(std::string_view name) const {
+    std::string_view value;
+    return get(name, &value);
+}
+
+size_t UrlParams::size() const {
+    if (!indexed_) buildIndex();
+    return entries_.size();
+}
+
+void HttpRequest::setLimits(const Limits& limits) {
+    g_limits = limits;
+}
+
+const HttpRequest::Limits& HttpRequest::limits() {
+    return g_limits;
+}
+
+HttpRequest::HttpRequest() : query_params_(&arena_), form_params_(&arena_), route_params_(&arena_) {
     reset();
 }
 
 void HttpRequest::reset(){
     method_ = INVALID;
     state_ = kExpectRequestLine;
-    path_ = "";
-    query_ = "";
-    version_ = "";
+    parse_error_ = kMalformed;
+    receive_time_ = Timestamp();
+    body_start_time_ = Timestamp();
+    deadline_ = Timestamp();
+    path_.clear();
+    query_ = std::string_view();
+    version_ = std::string_view();
+    raw_head_.clear();
+    head_scanned_ = 0;
     headers_.clear();
-    body_ = "";
-    post_params_.clear();
+    known_headers_.fill(std::string_view());
+    owned_fields_.clear();
+    content_length_ = 0;
+    chunked_ = false;
+    chunk_state_ = kChunkSize;
+    body_remaining_ = 0;
+    body_reader_.reset();
+    body_reader_decided_ = false;
+    body_.clear();
+    route_pattern_ = std::string_view();
+    route_param_names_ = nullptr;
+    // 从内存池分配的容器换成空容器，连同已分配的存储一起丢弃（clear() 会保留容量），再回收内存池
+    query_params_.assign(std::string_view());
+    form_params_.assign(std::string_view());
+    route_params_ = RouteParams(&arena_);
+    arena_.reset();
 }
 
-// URL解码实现
-std::string HttpRequest::urlDecode(const std::string& str) {
-    std::string result;
-    char hex[3] = {0};
-    for (size_t i = 0; i < str.length(); ++i) {
-        if (str[i] == '%') {
-            if (i + 2 < str.length()) {
-                hex[0] = str[i+1];
-                hex[1] = str[i+2];
-                result += static_cast<char>(strtol(hex, nullptr, 16));
-                i += 2;
-            }
-        } else if (str[i] == '+') {
-            result += ' ';
-        } else {
-            result += str[i];
-        }
+std::string HttpRequest::getRouteParam(std::string_view name) const {
+    if (!route_param_names_) return "";
+    for (size_t i = 0; i < route_param_names_->size() && i < route_params_.size(); ++i) {
+        if ((*route_param_names_)[i] == name) return std::string(route_params_[i]);
     }
+    return "";
+}
+
+// URL解码实现
+std::string HttpRequest::urlDecode(std::string_view str) {
+    std::string result(str.size(), '\0');
+    result.resize(percentDecode(str, &result[0]));
     return result;
 }
 
-const char* searchCRLF(const char* begin, const char* end){
-    const char* crlf = std::search(begin, end, "\r\n", "\r\n"+2);
-    return crlf == end ? nullptr : crlf;
+HttpRequest::HeaderId HttpRequest::lookupHeaderId(std::string_view name) {
+    // 按长度和首字母分派，未知头部通常不需要任何字符串比较
+    HeaderId id = kHeaderIdCount;
+    char first = name.empty() ? '\0' : asciiLower(name[0]);
+    switch (name.size()) {
+    case 4:  id = kHost; break;
+    case 5:  id = kRange; break;
+    case 6:  id = first == 'a' ? kAccept : first == 'c' ? kCookie : kExpect; break;
+    case 7:  id = kUpgrade; break;
+    case 8:  id = kIfRange; break;
+    case 10: id = first == 'c' ? kConnection : kUserAgent; break;
+    case 12: id = kContentType; break;
+    case 13: id = kIfNoneMatch; break;
+    case 14: id = kContentLength; break;
+    case 15: id = kAcceptEncoding; break;
+    case 17: id = first == 't' ? kTransferEncoding : kIfModifiedSince; break;
+    default: return kHeaderIdCount;
+    }
+    return equalsIgnoreCase(name, kKnownHeaderNames[id]) ? id : kHeaderIdCount;
 }
 
 bool HttpRequest::parse(Buffer* buffer){
-    bool ok = true;
-    bool has_more = true;
-    while(has_more){
+    if(state_ == kExpectRequestLine || state_ == kExpectHeaders){
+        if(receive_time_.microSecondSinceEpoch() == 0){
+            receive_time_ = Timestamp::now();
+        }
+        // 先找到头部结束的空行，整个头部完整后一次性拷贝出 Buffer 再解析
         const char* start = buffer->peek();
         const char* end = start + buffer->readableBytes();
-        if(state_ == kExpectRequestLine){
-            const char* crlf = searchCRLF(start, end);
-            if(crlf){
-                ok = parseRequestLine(start, crlf);
-                if(ok){
-                    buffer->retrieveUntil(crlf+2);
-                    state_ = kExpectHeaders;
-                }else{
-                    has_more = false;
-                }
-            }else{
-                has_more = false;
+        const char* head_end = nullptr;
+        const char* p = start + head_scanned_;
+        while(p < end){
+            // memchr 在 glibc 中按 CPU 分派到 SSE2/AVX2 实现
+            p = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if(!p) break;
+            if(p - start >= 3 && p[-1] == '\r' && p[-2] == '\n' && p[-3] == '\r'){
+                head_end = p + 1;
+                break;
             }
-        }else if(state_ == kExpectHeaders){
-            const char* crlf = searchCRLF(start, end);
-            if(crlf){
-                if(start == crlf){
-                    // 解析Header
-                    buffer->retrieveUntil(crlf+2);
-                    // TODO简化处理，假设GET/HEAD请求没有Body
-                    // 需根据Content-Length读取Body
-                    std::string content_length_str = getHeader("Content-Length");
-                    if(!content_length_str.empty() && method_ == POST){
-                        int content_length = std::stoi(content_length_str);
-                        if(content_length > 0){
-                            state_ = kExpectBody;
-                        }else{
-                            state_ = kGotALL;
-                            has_more = false;
-                        }
-                        
-                    }else{
-                        state_ = kGotALL;
-                        has_more = false;
-                    }
-                }else{
-                    ok = parseHeader(start, crlf);
-                    if(ok){
-                        buffer->retrieveUntil(crlf+2);
-                    }else{
-                        has_more = false;
-                    }
-                }
-            }else{
-                has_more = false;
+            ++p;
+        }
+        if(!head_end){
+            head_scanned_ = buffer->readableBytes();
+            // 头部不完整时同样检查上限，不等到空行出现才发现超长
+            if(head_scanned_ > g_limits.max_header_size){
+                return fail(kHeadersTooLarge);
+            }
+            if(head_scanned_ > g_limits.max_request_line && !std::memchr(start, '\n', g_limits.max_request_line)){
+                return fail(kRequestLineTooLong);
             }
-        }else if(state_ == kExpectBody){
-            parseBody(buffer);
-            state_ = kGotALL;
-            has_more = false;
+            return true; // 数据包不完整
         }
+        if(static_cast<size_t>(head_end - start) > g_limits.max_header_size){
+            return fail(kHeadersTooLarge);
+        }
+
+        raw_head_.assign(start, head_end - start);
+        buffer->retrieveUntil(head_end);
+        head_scanned_ = 0;
+
+        // raw_head_ 以 "\r\n\r\n" 结尾，head_last 指向最后那个空行
+        const char* line = raw_head_.data();
+        const char* head_last = line + raw_head_.size() - 2;
+        const char* crlf = findCRLF(line, head_last + 2);
+        if(crlf && static_cast<size_t>(crlf - line) > g_limits.max_request_line){
+            return fail(kRequestLineTooLong);
+        }
+        if(!crlf || !parseRequestLine(line, crlf)){
+            return false;
+        }
+        state_ = kExpectHeaders;
+        line = crlf + 2;
+        while(line < head_last){
+            crlf = findCRLF(line, head_last);
+            if(!crlf || crlf == head_last || !parseHeader(line, crlf)){
+                return false;
+            }
+            line = crlf + 2;
+        }
+
+        // 请求头完整后先返回，请求体留给下一次调用
+        return prepareBody();
+    }
+    if(state_ == kExpectBody){
+        return parseBody(buffer);
     }
-    return ok;
+    return true;
 }
 
-void HttpRequest::parseBody(Buffer* buffer) {
-    int content_length = std::stoi(getHeader("Content-Length"));
-    if (buffer->readableBytes() >= content_length) {
-        body_ = buffer->retrieveAsString(content_length);
-        state_ = kGotALL;
-        // 如果是 POST 表单，解析它
-        if (getHeader("Content-Type") == "application/x-www-form-urlencoded") {
-            parsePost();
+bool HttpRequest::prepareBody() {
+    std::string_view transfer_encoding = known_headers_[kTransferEncoding];
+    if (!transfer_encoding.empty()) {
+        // 只支持单独的 chunked；与 Content-Length 同时出现时两种理解会导致请求走私，直接拒绝
+        if (!equalsIgnoreCase(transfer_encoding, "chunked") || !known_headers_[kContentLength].empty()) {
+            return false;
         }
+        chunked_ = true;
+        chunk_state_ = kChunkSize;
+        state_ = kExpectBody;
+    } else if (content_length_ > 0) {
+        body_remaining_ = content_length_;
+        state_ = kExpectBody;
+    } else {
+        state_ = kGotALL;
     }
+    if (state_ == kExpectBody) {
+        body_start_time_ = Timestamp::now();
+    }
+    return true;
 }
 
-// 解析 POST 表单数据
-void HttpRequest::parsePost() {
-    std::string& data = body_;
-    std::string key, value;
-    size_t start = 0, end;
-    
-    while(start < data.length()){
-        end = data.find('=', start);
-        if(end == std::string::npos) break;
-        key = urlDecode(data.substr(start, end - start));
-        
-        start = end + 1;
-        end = data.find('&', start);
-        if(end == std::string::npos){
-            end = data.length();
+void HttpRequest::setBodyReader(std::unique_ptr<BodyReader> reader) {
+    body_reader_ = std::move(reader);
+    body_reader_decided_ = true;
+}
+
+bool HttpRequest::deliverBody(const char* data, size_t len) {
+    if (body_reader_) {
+        return body_reader_->onBody(data, len);
+    }
+    // chunked 请求体事先不知道长度，只能边收边检查
+    if (body_.size() + len > g_limits.max_body_size) {
+        return fail(kBodyTooLarge);
+    }
+    body_.append(data, len);
+    return true;
+}
+
+void HttpRequest::finishBody() {
+    state_ = kGotALL;
+    // POST 表单的参数在第一次查询时才解析
+    if (!body_reader_ && startsWithIgnoreCase(known_headers_[kContentType], "application/x-www-form-urlencoded")) {
+        form_params_.assign(body_);
+    }
+}
+
+// 已到达的请求体立即交出，不等待整个请求体到齐
+bool HttpRequest::parseBody(Buffer* buffer) {
+    if (chunked_) {
+        return parseChunkedBody(buffer);
+    }
+    // 声明的长度超限时不读取请求体，客户端等待 100 Continue 时也能立即拒绝
+    if (!body_reader_ && content_length_ > g_limits.max_body_size) {
+        return fail(kBodyTooLarge);
+    }
+    size_t n = std::min(buffer->readableBytes(), body_remaining_);
+    if (n > 0) {
+        bool ok = deliverBody(buffer->peek(), n);
+        buffer->retrieve(n);
+        body_remaining_ -= n;
+        if (!ok) return false;
+    }
+    if (body_remaining_ == 0) {
+        finishBody();
+    }
+    return true;
+}
+
+// chunked 编码：chunk-size [; ext] CRLF data CRLF ... 0 CRLF [trailer] CRLF
+bool HttpRequest::parseChunkedBody(Buffer* buffer) {
+    // chunk-size 行和 trailer 行的长度上限，防止不含 CRLF 的数据无限累积
+    const size_t kMaxChunkLineLength = 4096;
+    while (state_ == kExpectBody) {
+        const char* start = buffer->peek();
+        const char* end = start + buffer->readableBytes();
+        if (chunk_state_ == kChunkData) {
+            size_t n = std::min(buffer->readableBytes(), body_remaining_);
+            if (n == 0) return true;
+            bool ok = deliverBody(start, n);
+            buffer->retrieve(n);
+            body_remaining_ -= n;
+            if (!ok) return false;
+            if (body_remaining_ == 0) chunk_state_ = kChunkDataEnd;
+            continue;
         }
-        value = urlDecode(data.substr(start, end - start));
-        
-        post_params_[key] = value;
-        start = end + 1;
+
+        const char* crlf = findCRLF(start, end);
+        if (!crlf) return false;
+        if (crlf == end) {
+            return buffer->readableBytes() <= kMaxChunkLineLength;
+        }
+
+        if (chunk_state_ == kChunkSize) {
+            // 忽略 chunk 扩展
+            const char* size_end = std::find(start, crlf, ';');
+            std::string_view size_str = trimView(start, size_end);
+            size_t size = 0;
+            auto result = std::from_chars(size_str.data(), size_str.data() + size_str.size(), size, 16);
+            if (size_str.empty() || result.ec != std::errc() || result.ptr != size_str.data() + size_str.size()) {
+                return false;
+            }
+            body_remaining_ = size;
+            chunk_state_ = size > 0 ? kChunkData : kChunkTrailer;
+        } else if (chunk_state_ == kChunkDataEnd) {
+            // chunk 数据之后必须紧跟 CRLF
+            if (crlf != start) return false;
+            chunk_state_ = kChunkSize;
+        } else if (crlf == start) {
+            // trailer 以空行结束，trailer 字段本身被忽略
+            finishBody();
+        }
+        buffer->retrieveUntil(crlf + 2);
+    }
+    return true;
+}
+
+bool HttpRequest::setRequestLine(const std::string& method, const std::string& target, const std::string& version) {
+    receive_time_ = Timestamp::now();
+    raw_head_ = method + " " + target + " " + version;
+    if (!parseRequestLine(raw_head_.data(), raw_head_.data() + raw_head_.size())) {
+        return false;
     }
+    state_ = kExpectHeaders;
+    return true;
 }
 
-std::string HttpRequest::getPostValue(const std::string& key) const {
-    auto it = post_params_.find(key);
-    return (it == post_params_.end()) ? "" : it->second;
+bool HttpRequest::addHeader(const std::string& key, const std::string& value) {
+    owned_fields_.push_back(key);
+    const std::string& stored_key = owned_fields_.back();
+    owned_fields_.push_back(value);
+    return storeHeader(stored_key, owned_fields_.back());
+}
+
+void HttpRequest::setBody(const std::string& body) {
+    body_ = body;
+    finishBody();
 }
 
 bool HttpRequest::parseRequestLine(const char* begin, const char* end){
-    std::string line(begin, end);
+    std::string_view line(begin, end - begin);
     size_t method_end = line.find(' ');
-    if(method_end == std::string::npos) return false;
-    std::string method_str = line.substr(0, method_end);
+    size_t path_end = line.rfind(' ');
+    if(method_end == std::string_view::npos || method_end == path_end) return false;
 
+    std::string_view method_str = line.substr(0, method_end);
     if(method_str == "GET") method_ = GET;
     else if(method_str == "POST") method_ = POST;
     else if(method_str == "HEAD") method_ = HEAD;
@@ -160,20 +478,18 @@ bool HttpRequest::parseRequestLine(const char* begin, const char* end){
 
     if(method_ == INVALID) return false;
 
-    // 解析 Path 和 Query
-    size_t path_start = line.find(' ');
-    size_t path_end = line.rfind(' ');
-    if (path_start == std::string::npos || path_end == std::string::npos || path_start == path_end) {
-        return false;
-    }
+    version_ = line.substr(path_end + 1);
 
-    std::string url = line.substr(path_start + 1, path_end - (path_start + 1));
+    // 解析 Path 和 Query
+    std::string_view url = line.substr(method_end + 1, path_end - (method_end + 1));
     size_t query_pos = url.find('?');
-    if (query_pos != std::string::npos) {
-        path_ = urlDecode(url.substr(0, query_pos));
-        query_ = urlDecode(url.substr(query_pos + 1));
+    if (query_pos != std::string_view::npos) {
+        assignDecoded(url.substr(0, query_pos), &path_);
+        // 查询串保持原样，参数在 queryParams() 第一次查询时分别解码；整体先解码会把 %26、%3D 误当作分隔符
+        query_ = url.substr(query_pos + 1);
+        query_params_.assign(query_);
     } else {
-        path_ = urlDecode(url);
+        assignDecoded(url, &path_);
     }
 
     // 处理根路径
@@ -184,37 +500,64 @@ bool HttpRequest::parseRequestLine(const char* begin, const char* end){
     return true;
 }
 
-// 实现完整的key-value提取
+// 头部行 "name: value"，值两端的空白不属于值
 bool HttpRequest::parseHeader(const char* begin, const char* end){
-    const char* colon = std::find(begin, end, ':');
-    if(colon == end) return false;
+    const char* colon = static_cast<const char*>(std::memchr(begin, ':', end - begin));
+    if(!colon) return false;
+    return storeHeader(std::string_view(begin, colon - begin), trimView(colon + 1, end));
+}
 
-    std::string key(begin, colon);
-    // 跳过':'以及任何空格
-    const char* value_start = colon+1;
-    while(value_start < end && isspace(*value_start)){
-        value_start++;
+bool HttpRequest::storeHeader(std::string_view name, std::string_view value){
+    // 头部名不能为空或含空白（包括已废弃的折行），否则与上游代理的理解可能不一致
+    if(name.empty() || name.find_first_of(" \t") != std::string_view::npos){
+        return false;
     }
+    if(headers_.size() >= g_limits.max_headers){
+        return fail(kHeadersTooLarge);
+    }
+    headers_.push_back({name, value});
 
-    std::string value(value_start, end);
-
-    headers_[key] = value;
+    HeaderId id = lookupHeaderId(name);
+    if(id == kHeaderIdCount) return true;
+    if(id == kContentLength){
+        size_t length = 0;
+        auto result = std::from_chars(value.data(), value.data() + value.size(), length);
+        if(value.empty() || result.ec != std::errc() || result.ptr != value.data() + value.size()){
+            return false;
+        }
+        // 重复的 Content-Length 必须一致
+        if(!known_headers_[kContentLength].empty() && length != content_length_){
+            return false;
+        }
+        content_length_ = length;
+    }
+    if(known_headers_[id].empty()){
+        known_headers_[id] = value;
+    }
     return true;
 }
 
 std::string HttpRequest::getHeader(const std::string& key) const{
-    auto it = headers_.find(key);
-    return it == headers_.end() ? "" : it->second;
+    HeaderId id = lookupHeaderId(key);
+    if(id != kHeaderIdCount){
+        return std::string(known_headers_[id]);
+    }
+    for(const Header& header : headers_){
+        if(equalsIgnoreCase(header.name, key)){
+            return std::string(header.value);
+        }
+    }
+    return "";
 }
 
 bool HttpRequest::keepAlive() const {
-    std::string connection = getHeader("Connection");
-    if(connection == "close"){
+    std::string_view connection = known_headers_[kConnection];
+    if(equalsIgnoreCase(connection, "close")){
         return false;
     }
     if(version_ == "HTTP/1.0"){
-        return connection == "Keep-Alive";
+        return equalsIgnoreCase(connection, "keep-alive");
     }
     // 对于HTTP/1.1默认Keep-Alive
     return true;
-}
\ No newline at end of file
+}
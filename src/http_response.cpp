@@ -1,44 +1,258 @@
 #include "http_response.h"
+#include "http_utils.h"
+#include <array>
+#include <cassert>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <ctime>
 
-const std::unordered_map<int, std::string> kStatusCodeMessages = {
-    {200, "OK"},
-    {400, "Bad Request"},
-    {403, "Forbidden"},
-    {404, "Not Found"},
-    {500, "Internal Server Error"}
+namespace {
+
+const char* reasonPhrase(int code){
+    switch(code){
+    case 100: return "Continue";
+    case 101: return "Switching Protocols";
+    case 200: return "OK";
+    case 201: return "Created";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 206: return "Partial Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 303: return "See Other";
+    case 304: return "Not Modified";
+    case 307: return "Temporary Redirect";
+    case 308: return "Permanent Redirect";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 409: return "Conflict";
+    case 411: return "Length Required";
+    case 412: return "Precondition Failed";
+    case 413: return "Payload Too Large";
+    case 414: return "URI Too Long";
+    case 415: return "Unsupported Media Type";
+    case 416: return "Range Not Satisfiable";
+    case 417: return "Expectation Failed";
+    case 425: return "Too Early";
+    case 426: return "Upgrade Required";
+    case 429: return "Too Many Requests";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 502: return "Bad Gateway";
+    case 503: return "Service Unavailable";
+    case 504: return "Gateway Timeout";
+    case 505: return "HTTP Version Not Supported";
+    default: return "Unknown";
+    }
+}
+
+const int kMinStatusCode = 100;
+const int kMaxStatusCode = 599;
+
+// 所有状态码的状态行在启动时拼好，序列化时直接拷贝
+struct StatusLineTable {
+    std::array<std::string, kMaxStatusCode - kMinStatusCode + 1> lines;
+    StatusLineTable(){
+        for(int code = kMinStatusCode; code <= kMaxStatusCode; ++code){
+            lines[code - kMinStatusCode] = "HTTP/1.1 " + std::to_string(code) + " " + reasonPhrase(code) + "\r\n";
+        }
+    }
 };
+const StatusLineTable kStatusLines;
+
+// 与 HeaderId 顺序一致
+const std::string_view kHeaderNames[] = {
+    "Content-Type",
+    "Content-Length",
+    "Connection",
+    "Keep-Alive",
+    "Server",
+    "Date",
+    "Location",
+    "Content-Disposition",
+    "Content-Encoding",
+    "Vary",
+    "Cache-Control",
+    "ETag",
+    "Last-Modified",
+    "Accept-Ranges",
+    "Content-Range",
+    "Retry-After",
+};
+static_assert(sizeof(kHeaderNames) / sizeof(kHeaderNames[0]) == HttpResponse::kOtherHeader,
+              "kHeaderNames must match HttpResponse::HeaderId");
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b){
+    if(a.size() != b.size()) return false;
+    for(size_t i = 0; i < a.size(); ++i){
+        if(::tolower(static_cast<unsigned char>(a[i])) != ::tolower(static_cast<unsigned char>(b[i]))) return false;
+    }
+    return true;
+}
+
+void appendView(Buffer* buffer, std::string_view s){
+    buffer->append(s.data(), s.size());
+}
+
+} // namespace
+
+HttpResponse::HttpResponse(std::pmr::memory_resource* arena) : status_code_(kUnknow), headers_(arena), chunked_(true){
+
+}
+
+void HttpResponse::addHeader(HeaderId id, std::string_view value){
+    for(auto& header : headers_){
+        if(header.id == id && id != kOtherHeader){
+            header.value = value;
+            return;
+        }
+    }
+    headers_.emplace_back(id, std::string_view(), value);
+}
+
+void HttpResponse::addHeader(std::string_view key, std::string_view value){
+    for(int i = 0; i < kOtherHeader; ++i){
+        if(equalsIgnoreCase(key, kHeaderNames[i])){
+            addHeader(static_cast<HeaderId>(i), value);
+            return;
+        }
+    }
+    for(auto& header : headers_){
+        if(header.id == kOtherHeader && equalsIgnoreCase(header.name, key)){
+            header.value = value;
+            return;
+        }
+    }
+    headers_.emplace_back(kOtherHeader, key, value);
+}
+
+void HttpResponse::assignFrom(const HttpResponse& other){
+    status_code_ = other.status_code_;
+    status_message_ = other.status_message_;
+    for(const auto& header : other.headers_){
+        if(header.id == kOtherHeader) addHeader(header.name, header.value);
+        else addHeader(header.id, header.value);
+    }
+    body_ = other.body_;
+    body_producer_ = other.body_producer_;
+    slice_producer_ = other.slice_producer_;
+    wakeup_receiver_ = other.wakeup_receiver_;
+    failure_check_ = other.failure_check_;
+    upgrade_handler_ = other.upgrade_handler_;
+    chunked_ = other.chunked_;
+}
+
+std::string_view HttpResponse::getHeader(HeaderId id) const{
+    for(const auto& header : headers_){
+        if(header.id == id) return header.value;
+    }
+    return std::string_view();
+}
 
-HttpResponse::HttpResponse() : status_code_(kUnknow){
+std::string_view HttpResponse::headerName(const Header& header){
+    return header.id == kOtherHeader ? std::string_view(header.name) : kHeaderNames[header.id];
+}
 
+std::string_view HttpResponse::cachedDate(){
+    thread_local time_t cached_second = 0;
+    thread_local std::string cached_date;
+    time_t now = ::time(nullptr);
+    if(now != cached_second){
+        cached_second = now;
+        cached_date = HttpUtils::formatHttpDate(now);
+    }
+    return cached_date;
 }
+
 void HttpResponse::appendToBuffer(Buffer* buffer) const{
-    char buf[128];
+    bool with_body = !isStreaming() && !body_.empty();
+    appendHead(buffer, with_body ? body_.size() : 0);
+    // 添加正文body
+    if(with_body){
+        buffer->append(body_.data(), body_.size());
+    }
+}
+
+void HttpResponse::appendHeadToBuffer(Buffer* buffer) const{
+    appendHead(buffer, 0);
+}
 
+void HttpResponse::appendHead(Buffer* buffer, size_t body_reserve) const{
     // 添加状态行(Status Line)
-    auto it = kStatusCodeMessages.find(status_code_);
-    std::string status_message = (it == kStatusCodeMessages.end()) ? "Unknown" : it->second;
     // 如果用户设置了自定义消息，则使用用户的
-    if(!status_message_.empty()){
-        status_message = status_message_;
+    std::string custom_line;
+    std::string_view status_line;
+    if(status_code_ >= kMinStatusCode && status_code_ <= kMaxStatusCode && status_message_.empty()){
+        status_line = kStatusLines.lines[status_code_ - kMinStatusCode];
+    }else{
+        custom_line = "HTTP/1.1 " + std::to_string(status_code_) + " " +
+                      (status_message_.empty() ? reasonPhrase(status_code_) : status_message_) + "\r\n";
+        status_line = custom_line;
     }
+    std::string_view date = cachedDate();
 
-    snprintf(buf, sizeof(buf), "HTTP/1.1 %d %s\r\n", status_code_, status_message.c_str());
-    buffer->append(buf);
+    // 先算出总长度，一次预留好空间，之后逐段拷贝不会再扩容
+    const size_t kDateLineExtra = sizeof("Date: \r\n") - 1;
+    const size_t kChunkedLine = sizeof("Transfer-Encoding: chunked\r\n") - 1;
+    size_t total = status_line.size() + header_block_.size() + kDateLineExtra + date.size() + 2;
+    for(const auto& header : headers_){
+        total += headerName(header).size() + header.value.size() + 4;
+    }
+    total += (isChunked() ? kChunkedLine : 0) + body_reserve;
+    buffer->ensureWritableBytes(total);
+
+    appendView(buffer, status_line);
+    appendView(buffer, header_block_);
+    buffer->append("Date: ", 6);
+    appendView(buffer, date);
+    buffer->append("\r\n", 2);
 
     // 添加所有头部Headers
     for(const auto& header : headers_){
-        buffer->append(header.first);
-        buffer->append(": ");
-        buffer->append(header.second);
-        buffer->append("\r\n");
+        // 流式响应的长度未知，由 chunked 编码界定正文
+        if(isChunked() && header.id == kContentLength) continue;
+        appendView(buffer, headerName(header));
+        buffer->append(": ", 2);
+        buffer->append(header.value.data(), header.value.size());
+        buffer->append("\r\n", 2);
+    }
+    if(isChunked()){
+        buffer->append("Transfer-Encoding: chunked\r\n", kChunkedLine);
     }
+    // 添加一个空行，分隔头部和正文；流式正文由生产者随后写出
+    buffer->append("\r\n", 2);
+}
 
-    // 添加一个空行，分隔头部和正文
-    buffer->append("\r\n");
+bool HttpResponse::appendChunk(const BodyProducer& producer, Buffer* buffer){
+    // 先写入定长的 chunk-size 占位，生产者直接把数据写在它后面，结束后回填长度，省去一次拷贝
+    // chunk-size 允许前导 0（RFC 9112 7.1）
+    const size_t kSizeWidth = 8;
+    size_t size_offset = buffer->readableBytes();
+    buffer->append("00000000\r\n", kSizeWidth + 2);
+    size_t data_offset = buffer->readableBytes();
 
-    // 添加正文body
-    if(!body_.empty()){
-        buffer->append(body_);
+    bool more = producer(buffer);
+    size_t len = buffer->readableBytes() - data_offset;
+    if(len > 0){
+        // 占位只有 8 位十六进制数，单个 chunk 不能超过 4GB（生产者每次只写几十 KB）
+        assert(len <= 0xFFFFFFFFu);
+        char size[kSizeWidth + 1];
+        snprintf(size, sizeof(size), "%08x", static_cast<unsigned int>(static_cast<uint32_t>(len)));
+        char* size_field = buffer->beginWrite() - (buffer->readableBytes() - size_offset);
+        std::copy(size, size + kSizeWidth, size_field);
+        buffer->append("\r\n", 2);
+    }else{
+        // 没有数据时撤掉占位，0 长度的 chunk 会被当作正文结束
+        buffer->unwrite(kSizeWidth + 2);
+    }
+    if(!more){
+        buffer->append("0\r\n\r\n", 5);
     }
+    return more;
 }
\ No newline at end of file
@@ -2,6 +2,12 @@
 #include <string>
 #include <filesystem>
 #include <optional>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <strings.h>
+#include <sys/types.h>
 
 namespace HttpUtils {
 std::optional<std::string> getSafeFilePath(const std::string& base_path, const std::string& req_path) {
@@ -31,4 +37,152 @@ std::optional<std::string> getSafeFilePath(const std::string& base_path, const s
         return std::nullopt;
     }
 }
+
+std::string formatHttpDate(time_t t) {
+    // 星期和月份名固定为英文，不受 locale 影响
+    static const char* const kWeekdays[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static const char* const kMonths[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                          "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    struct tm tm_time;
+    ::gmtime_r(&t, &tm_time);
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+             kWeekdays[tm_time.tm_wday], tm_time.tm_mday, kMonths[tm_time.tm_mon], tm_time.tm_year + 1900,
+             tm_time.tm_hour, tm_time.tm_min, tm_time.tm_sec);
+    return buf;
+}
+
+time_t parseHttpDate(std::string_view date) {
+    static const char* const kMonths[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                          "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    if (date.size() >= 64) return -1;
+    char buf[64];
+    memcpy(buf, date.data(), date.size());
+    buf[date.size()] = '\0';
+
+    struct tm tm_time;
+    memset(&tm_time, 0, sizeof(tm_time));
+    char month[4] = {0};
+    int day, year, hour, minute, second;
+    if (sscanf(buf, "%*3s, %d %3s %d %d:%d:%d GMT", &day, month, &year, &hour, &minute, &second) == 6) {
+        // IMF-fixdate: Sun, 06 Nov 1994 08:49:37 GMT
+    } else if (sscanf(buf, "%*[^,], %d-%3s-%d %d:%d:%d GMT", &day, month, &year, &hour, &minute, &second) == 6) {
+        // RFC 850: Sunday, 06-Nov-94 08:49:37 GMT，两位年份按 RFC 9110 的建议取最近的年代
+        year += year < 70 ? 2000 : (year < 100 ? 1900 : 0);
+    } else if (sscanf(buf, "%*3s %3s %d %d:%d:%d %d", month, &day, &hour, &minute, &second, &year) == 6) {
+        // asctime: Sun Nov  6 08:49:37 1994
+    } else {
+        return -1;
+    }
+    int mon = -1;
+    for (int i = 0; i < 12; ++i) {
+        if (strcmp(month, kMonths[i]) == 0) {
+            mon = i;
+            break;
+        }
+    }
+    if (mon < 0 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) return -1;
+    tm_time.tm_year = year - 1900;
+    tm_time.tm_mon = mon;
+    tm_time.tm_mday = day;
+    tm_time.tm_hour = hour;
+    tm_time.tm_min = minute;
+    tm_time.tm_sec = second;
+    return ::timegm(&tm_time);
+}
+
+std::string makeETag(ino_t ino, off_t size, const struct timespec& mtime, std::string_view suffix) {
+    char buf[80];
+    int n = snprintf(buf, sizeof(buf), "\"%lx-%lx-%lx%08lx", static_cast<unsigned long>(ino),
+                     static_cast<unsigned long>(size), static_cast<unsigned long>(mtime.tv_sec),
+                     static_cast<unsigned long>(mtime.tv_nsec));
+    std::string etag(buf, n);
+    if (!suffix.empty()) {
+        etag += '-';
+        etag.append(suffix.data(), suffix.size());
+    }
+    etag += '"';
+    return etag;
+}
+
+bool etagMatches(std::string_view if_none_match, std::string_view etag) {
+    size_t pos = 0;
+    while (pos < if_none_match.size()) {
+        size_t comma = if_none_match.find(',', pos);
+        std::string_view tag = if_none_match.substr(pos, comma == std::string_view::npos ? std::string_view::npos : comma - pos);
+        pos = comma == std::string_view::npos ? if_none_match.size() : comma + 1;
+        while (!tag.empty() && (tag.front() == ' ' || tag.front() == '\t')) tag.remove_prefix(1);
+        while (!tag.empty() && (tag.back() == ' ' || tag.back() == '\t')) tag.remove_suffix(1);
+        if (tag == "*") return true;
+        if (tag.size() > 2 && tag[0] == 'W' && tag[1] == '/') tag.remove_prefix(2);
+        if (tag == etag) return true;
+    }
+    return false;
+}
+
+namespace {
+
+std::string_view trimView(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// 非负十进制整数，超过 18 位视为格式错误以免溢出
+bool parseDigits(std::string_view s, uint64_t* value) {
+    if (s.empty() || s.size() > 18) return false;
+    uint64_t v = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+        v = v * 10 + static_cast<uint64_t>(c - '0');
+    }
+    *value = v;
+    return true;
+}
+
+} // namespace
+
+RangeResult parseRange(std::string_view range, size_t size, std::vector<ByteRange>* ranges) {
+    // 区间数量上限，防止大量重叠的小区间放大读取和响应
+    const size_t kMaxRanges = 16;
+    ranges->clear();
+    range = trimView(range);
+    if (range.size() < 6 || strncasecmp(range.data(), "bytes=", 6) != 0) {
+        return kRangeIgnored;
+    }
+    range.remove_prefix(6);
+
+    size_t specs = 0;
+    size_t pos = 0;
+    while (pos < range.size()) {
+        size_t comma = range.find(',', pos);
+        std::string_view spec = trimView(range.substr(pos, comma == std::string_view::npos ? std::string_view::npos : comma - pos));
+        pos = comma == std::string_view::npos ? range.size() : comma + 1;
+        if (spec.empty()) continue; // 列表允许空元素
+        if (++specs > kMaxRanges) return kRangeIgnored;
+
+        size_t dash = spec.find('-');
+        if (dash == std::string_view::npos) return kRangeIgnored;
+        uint64_t first = 0, last = 0;
+        if (dash == 0) {
+            // "-N"：最后 N 个字节
+            if (!parseDigits(spec.substr(1), &last)) return kRangeIgnored;
+            if (last == 0 || size == 0) continue;
+            size_t length = static_cast<size_t>(std::min<uint64_t>(last, size));
+            ranges->push_back({static_cast<off_t>(size - length), length});
+            continue;
+        }
+        if (!parseDigits(spec.substr(0, dash), &first)) return kRangeIgnored;
+        if (dash + 1 == spec.size()) {
+            last = UINT64_MAX; // "N-"：从 N 到文件末尾
+        } else if (!parseDigits(spec.substr(dash + 1), &last) || last < first) {
+            return kRangeIgnored;
+        }
+        if (first >= size) continue;
+        last = std::min<uint64_t>(last, size - 1);
+        ranges->push_back({static_cast<off_t>(first), static_cast<size_t>(last - first + 1)});
+    }
+    if (specs == 0) return kRangeIgnored;
+    return ranges->empty() ? kRangeUnsatisfiable : kRangeSatisfiable;
+}
 }
@@ -10,16 +10,35 @@
 #include "utils/logger.h"
 #include "http/http_router.h"
 #include "http/handlers.h"
+#include "http/http2_session.h"
+#include "http/precompressed_cache.h"
+#include "http/static_file_cache.h"
+#include "http/embedded_assets.h"
+#include "http/dynamic_compression.h"
+#include "http/cache_control.h"
+#include "http/websocket.h"
+#include "http/request_coalescer.h"
+#include "http/response_cache.h"
+#include "http/overload_controller.h"
+#include "utils/disk_io_pool.h"
 #include "db_engine.h"
 #include <iostream>
 #include <filesystem>
 #include <fstream>
 #include <list>
+#include <csignal>
 
 std::string base_path, project_root_path;
+bool has_web_root = true; // 只使用编译进程序的资源时，磁盘上可以没有 www/
 const int kIdleConnectionTimeout = 60; // 60秒空闲超时
+// 请求头、请求体从开始接收算起的读取期限（秒），0 表示只受空闲超时限制
+double g_header_timeout = 10;
+double g_body_timeout = 30;
 std::unique_ptr<AsyncLogging> g_async_log;
 
+// 是否启用 HTTP/2（TLS 上的 ALPN h2 与明文的 h2c prior knowledge）
+bool g_enable_http2 = false;
+
 // 全局的或由 HttpServer 类持有的 Router 对象
 HttpRouter g_router;
 
@@ -38,63 +57,458 @@ void onHttpRequest(HttpRequest& req, HttpResponse* resp){
     g_router.route(req, resp);
 }
 
-// 设置给Server的MessageCallBack
-void onMessage(const std::shared_ptr<Connection>& conn, Buffer* buf){
-    HttpRequest& request = conn->getRequest();
-    bool parse_ok = true;
-    while(buf->readableBytes() > 0){
-        parse_ok = request.parse(buf);
-        if(request.gotAll()){
-            // 活动发生，先取消旧的定时器
-            TimerId old_id = conn->getTimerId();
-            if (!old_id.expired()) { 
-                conn->getLoop()->cancel(old_id);
+// 取消旧的空闲定时器并重新计时
+void rearmIdleTimer(const std::shared_ptr<Connection>& conn){
+    TimerId old_id = conn->getTimerId();
+    if (!old_id.expired()) {
+        conn->getLoop()->cancel(old_id);
+    }
+    std::weak_ptr<Connection> weak_conn = conn;
+    TimerId new_timer_id = conn->getLoop()->runAfter(kIdleConnectionTimeout, [weak_conn](){
+        std::shared_ptr<Connection> conn_ptr = weak_conn.lock();
+        if(conn_ptr){
+            // 流式响应仍在写出时不算空闲
+            if(conn_ptr->isStreaming() &&
+               timeDifference(Timestamp::now(), conn_ptr->getLastActiveTime()) < kIdleConnectionTimeout){
+                rearmIdleTimer(conn_ptr);
+                return;
             }
-            HttpResponse response;
-            response.addHeader("Server", "TF's Cpp Web Server");
-            bool keep_alive = request.keepAlive();
-            response.setKeepAlive(keep_alive);
-
-            // 告诉客户端 Keep-Alive 的超时参数
-            if (keep_alive) {
-                // 告诉浏览器：建议保持55秒（比服务器实际的60秒略短，防止竞态）
-                // max=10000 表示在这个连接上最多处理10000个请求
-                response.addHeader("Keep-Alive", "timeout=55, max=10000");
+            // 如果超时，服务器主动关闭连接
+            std::cout << "Connection from [" << conn_ptr->getPeerAddrStr() << "] timed out, closing." << ": fd = " << conn_ptr->getFd() << std::endl;
+            conn_ptr->forceClose(); 
+        }
+    });
+    conn->setTimerId(new_timer_id);
+}
+
+// HTTP/1.1 响应中每次都相同的头部，预先拼成整块
+// Keep-Alive：建议浏览器保持55秒（比服务器实际的60秒略短，防止竞态），max=10000 表示在这个连接上最多处理10000个请求
+const char kKeepAliveHeaderBlock[] =
+    "Server: TF's Cpp Web Server\r\n"
+    "Connection: Keep-Alive\r\n"
+    "Keep-Alive: timeout=55, max=10000\r\n";
+const char kCloseHeaderBlock[] =
+    "Server: TF's Cpp Web Server\r\n"
+    "Connection: close\r\n";
+const char kUpgradeHeaderBlock[] =
+    "Server: TF's Cpp Web Server\r\n"
+    "Connection: Upgrade\r\n";
+
+// 请求无法继续处理时给出错误响应并关闭连接：剩余的请求字节无法可靠地跳过
+void sendErrorAndClose(const std::shared_ptr<Connection>& conn, HttpRequest& request, HttpResponse::HttpStatusCode code){
+    HttpResponse response(request.arena());
+    response.setHeaderBlock(kCloseHeaderBlock);
+    response.setStatusCode(code);
+    response.setContentLength(0);
+    Buffer buf;
+    response.appendHeadToBuffer(&buf);
+    conn->send(&buf);
+    conn->shutdown();
+}
+
+HttpResponse::HttpStatusCode parseErrorStatus(const HttpRequest& request){
+    switch(request.parseError()){
+    case HttpRequest::kRequestLineTooLong: return HttpResponse::k414UriTooLong;
+    case HttpRequest::kHeadersTooLarge: return HttpResponse::k431RequestHeaderFieldsTooLarge;
+    case HttpRequest::kBodyTooLarge: return HttpResponse::k413PayloadTooLarge;
+    default: return HttpResponse::k400BadRequest;
+    }
+}
+
+// 请求只收到一部分时以读取期限代替空闲超时：期限从请求头（或请求体）开始接收时算起，
+// 逐字节缓慢发送不会延长期限，到期回应 408 并关闭连接
+// 流式请求体（BodyReader）可能很大，仍按空闲超时处理，只要数据在持续到达就不中断
+void armReadDeadline(const std::shared_ptr<Connection>& conn){
+    HttpRequest& request = conn->getRequest();
+    bool reading_headers = !request.headersComplete();
+    double timeout = reading_headers ? g_header_timeout : g_body_timeout;
+    if(timeout <= 0 || request.getBodyReader()){
+        rearmIdleTimer(conn);
+        return;
+    }
+    Timestamp start = reading_headers ? request.receiveTime() : request.bodyStartTime();
+    TimerId old_id = conn->getTimerId();
+    if (!old_id.expired()) {
+        conn->getLoop()->cancel(old_id);
+    }
+    std::weak_ptr<Connection> weak_conn = conn;
+    TimerId new_timer_id = conn->getLoop()->runAt(addTime(start, timeout), [weak_conn, reading_headers, start](){
+        std::shared_ptr<Connection> conn_ptr = weak_conn.lock();
+        if(!conn_ptr || !conn_ptr->connected()) return;
+        HttpRequest& req = conn_ptr->getRequest();
+        // 请求已在其他路径（如合并请求、流式响应）中读完，期限不再适用，恢复空闲超时
+        bool same_phase = reading_headers ? !req.headersComplete() : req.headersComplete() && !req.gotAll();
+        Timestamp current = reading_headers ? req.receiveTime() : req.bodyStartTime();
+        if(!same_phase || current.microSecondSinceEpoch() != start.microSecondSinceEpoch()){
+            if(!WebSocketSession::get(conn_ptr)) rearmIdleTimer(conn_ptr);
+            return;
+        }
+        LOG_INFO << "Request " << (reading_headers ? "headers" : "body") << " from " << conn_ptr->getPeerAddrStr()
+                 << " not received in time, closing";
+        sendErrorAndClose(conn_ptr, req, HttpResponse::k408RequestTimeout);
+    });
+    conn->setTimerId(new_timer_id);
+}
+
+// WebSocket 连接不使用空闲超时，由心跳判断对端是否还在
+void armWebSocketHeartbeat(const std::shared_ptr<Connection>& conn){
+    double interval = WebSocketHub::instance().options().ping_interval;
+    if(interval <= 0) return;
+    std::weak_ptr<Connection> weak_conn = conn;
+    TimerId timer_id = conn->getLoop()->runAfter(interval, [weak_conn, interval](){
+        std::shared_ptr<Connection> conn_ptr = weak_conn.lock();
+        WebSocketSession* session = conn_ptr ? WebSocketSession::get(conn_ptr) : nullptr;
+        if(!session || !conn_ptr->connected()) return;
+        Buffer output;
+        if(!session->heartbeat(interval, &output)){
+            LOG_INFO << "WebSocket peer " << conn_ptr->getPeerAddrStr() << " did not answer ping, closing";
+            conn_ptr->forceClose();
+            return;
+        }
+        if(output.readableBytes() > 0){
+            conn_ptr->send(&output);
+        }
+        armWebSocketHeartbeat(conn_ptr);
+    });
+    conn->setTimerId(timer_id);
+}
+
+// 处理已升级为 WebSocket 的连接上的数据
+void onWebSocketData(const std::shared_ptr<Connection>& conn, WebSocketSession* session, Buffer* buf){
+    Buffer output;
+    bool keep_open = session->onData(buf, &output);
+    if(output.readableBytes() > 0){
+        conn->send(&output);
+    }
+    if(!keep_open){
+        conn->shutdown();
+    }
+}
+
+// 可缓存或可合并的 GET 请求返回其路由属性，并记下路由模式（命中缓存时不经过路由，压缩统计仍按路由记录）
+// 其余请求返回 nullptr，直接交给路由
+const RouteOptions* sharedRouteOptions(HttpRequest& req){
+    if(req.getMethod() != HttpRequest::GET) return nullptr;
+    std::string_view pattern;
+    const RouteOptions* options = g_router.findOptions(req, &pattern);
+    if(!options || (!options->coalesce && options->cache_ttl <= 0)) return nullptr;
+    req.setRoutePattern(pattern);
+    return options;
+}
+
+// 执行路由，可缓存的路由把结果存入响应缓存
+void runSharedRoute(HttpRequest& req, HttpResponse* resp, const RouteOptions& options, const std::string& key,
+                    const ResponseCache::Ticket& ticket){
+    onHttpRequest(req, resp);
+    if(options.cache_ttl > 0){
+        ResponseCache::instance().store(key, options, ticket, *resp);
+    }
+}
+
+// HTTP/2 会话中的请求：与 HTTP/1.1 一样先查响应缓存，但会话要求同步给出响应，不等待进行中的相同请求
+void onHttp2Request(HttpRequest& req, HttpResponse* resp, double load){
+    const RouteOptions* options = sharedRouteOptions(req);
+    if(!options){
+        onHttpRequest(req, resp);
+        return;
+    }
+    std::string key = RequestCoalescer::key(req);
+    ResponseCache::Ticket ticket;
+    if(options->cache_ttl > 0 && ResponseCache::instance().lookup(key, *options, req, resp, load, &ticket)){
+        return;
+    }
+    auto handler = [&req, options, &key, &ticket](HttpResponse* r){ runSharedRoute(req, r, *options, key, ticket); };
+    if(options->coalesce){
+        RequestCoalescer::instance().run(key, handler, resp);
+    }else{
+        handler(resp);
+    }
+}
+
+// 流式或定长流式响应：写出头部后把正文一次产生完
+void appendWholeResponse(const HttpResponse& response, Buffer* buf){
+    response.appendToBuffer(buf);
+    if(!response.isStreaming()) return;
+    if(response.isChunked()){
+        while(HttpResponse::appendChunk(response.getBodyProducer(), buf)) {}
+    }else{
+        while(response.getBodyProducer()(buf)) {}
+    }
+}
+
+// 合并请求的等待方：以暂不产生数据的流式发送占住连接，不阻塞 I/O 线程，后续的流水线请求随之搁置；
+// 第一个请求完成后回到本线程写出共享的响应，结果不能共享时在这里自己执行处理函数
+// @return: false 表示已成为第一个请求，由调用方正常处理
+bool waitCoalescedResponse(const std::shared_ptr<Connection>& conn, HttpRequest& request, bool keep_alive,
+                           const std::string& key){
+    struct Pending {
+        bool ready = false;
+        RequestCoalescer::Result result;
+    };
+    auto pending = std::make_shared<Pending>();
+    EventLoop* loop = conn->getLoop();
+    std::function<void()> wakeup = conn->streamWakeup();
+    bool joined = RequestCoalescer::instance().join(key, [pending, loop, wakeup](const RequestCoalescer::Result& result){
+        // 两个任务按顺序在本线程执行，恢复发送时结果已经就位
+        loop->runInLoop([pending, result](){
+            pending->result = result;
+            pending->ready = true;
+        });
+        wakeup();
+    });
+    if(!joined) return false;
+
+    // 生产者由连接持有，连接存活期间 request 一直有效
+    HttpRequest* req = &request;
+    conn->sendStream([pending, req, keep_alive, loop](Buffer* buf){
+        if(!pending->ready) return true;
+        HttpResponse response(req->arena());
+        response.setHeaderBlock(keep_alive ? kKeepAliveHeaderBlock : kCloseHeaderBlock);
+        if(pending->result){
+            response.assignFrom(*pending->result);
+        }else{
+            onHttpRequest(*req, &response);
+        }
+        DynamicCompression::instance().apply(*req, &response, loop->busyRatio());
+        appendWholeResponse(response, buf);
+        req->reset();
+        return false;
+    }, [keep_alive](const std::shared_ptr<Connection>& c){
+        if(keep_alive){
+            rearmIdleTimer(c);
+        }else{
+            c->shutdown();
+        }
+    });
+    return true;
+}
+
+// 分发请求并写出响应，之后重置 request 以解析下一个请求
+// @return: 连接保持打开且需要重新计时空闲超时；同一批流水线请求只在最后重新计时一次
+bool sendResponse(const std::shared_ptr<Connection>& conn, HttpRequest& request, bool keep_alive){
+    // 头部从请求的内存池分配；缓存和合并请求保留的是复制到普通堆上的副本
+    HttpResponse response(request.arena());
+    response.setHeaderBlock(keep_alive ? kKeepAliveHeaderBlock : kCloseHeaderBlock);
+
+    const RouteOptions* options = sharedRouteOptions(request);
+    if(!options){
+        onHttpRequest(request, &response);
+    }else{
+        std::string key = RequestCoalescer::key(request);
+        ResponseCache::Ticket ticket;
+        bool hit = options->cache_ttl > 0 &&
+                   ResponseCache::instance().lookup(key, *options, request, &response, conn->getLoop()->busyRatio(), &ticket);
+        if(!hit){
+            auto handler = [&request, options, &key, &ticket](HttpResponse* r){
+                runSharedRoute(request, r, *options, key, ticket);
+            };
+            if(!options->coalesce){
+                handler(&response);
+            }else if(waitCoalescedResponse(conn, request, keep_alive, key)){
+                return false;
+            }else{
+                RequestCoalescer::instance().lead(key, handler, &response);
             }
+        }
+    }
+    if(response.getUpgradeHandler()){
+        // 101 之后不再是 HTTP，没有 keep-alive 的语义
+        response.setHeaderBlock(kUpgradeHeaderBlock);
+    }else{
+        DynamicCompression::instance().apply(request, &response, conn->getLoop()->busyRatio());
+    }
 
-            onHttpRequest(request, &response);
-
-            Buffer response_buf;
-            response.appendToBuffer(&response_buf);
-            conn->send(&response_buf);
-
-            // Keep-alive中，将不再直接关闭
-            if(keep_alive){
-                std::weak_ptr<Connection> weak_conn = conn;
-                TimerId new_timer_id = conn->getLoop()->runAfter(kIdleConnectionTimeout, [weak_conn](){
-                    std::shared_ptr<Connection> conn_ptr = weak_conn.lock();
-                    if(conn_ptr){
-                        // 如果超时，服务器主动关闭连接
-                        std::cout << "Connection from [" << conn_ptr->getPeerAddrStr() << "] timed out, closing." << ": fd = " << conn_ptr->getFd() << std::endl;
-                        conn_ptr->forceClose(); 
-                    }
-                });
-                conn->setTimerId(new_timer_id);
+    // 正文按引用发送：缓存、合并请求和静态文件的正文在多个响应之间共享，不拷贝进输出缓冲区
+    Buffer response_buf;
+    response.appendHeadToBuffer(&response_buf);
+    conn->send(&response_buf, response.getSharedBody());
+
+    if(response.getUpgradeHandler()){
+        // 新协议接管连接，HTTP 的空闲定时器换成新协议自己的心跳
+        TimerId old_id = conn->getTimerId();
+        if(!old_id.expired()){
+            conn->getLoop()->cancel(old_id);
+        }
+        response.getUpgradeHandler()(conn);
+        armWebSocketHeartbeat(conn);
+        request.reset();
+        return false;
+    }
+
+    if(response.isStreaming() && request.getMethod() != HttpRequest::HEAD){
+        // 正文由可写事件驱动逐段产生，全部写入输出缓冲区后再决定连接的去留
+        // 正文中途失败（如文件在发送期间被截断）时已发出的正文不足声明的长度，只能关闭连接让客户端察觉
+        auto done = [keep_alive, failed = response.getFailureCheck()](const std::shared_ptr<Connection>& c) {
+            if(keep_alive && !(failed && failed())){
+                rearmIdleTimer(c);
             }else{
-                conn->shutdown();
+                c->shutdown();
             }
-            request.reset();
-        
-        }else if (parse_ok) {
-            // 数据包不完整，跳出循环，等待更多数据
-            break;
+        };
+        if(response.getWakeupReceiver()){
+            // 异步正文（如等待磁盘读取的文件）就绪后回到本连接的 I/O 线程继续发送
+            response.getWakeupReceiver()(conn->streamWakeup());
+        }
+        if(response.getSliceProducer()){
+            // 文件映射等只读数据直接交给 SSL_write / writev，不经过输出缓冲区
+            conn->sendSliceStream(response.getSliceProducer(), done);
+        }else{
+            HttpResponse::BodyProducer producer = response.getBodyProducer();
+            if(response.isChunked()){
+                producer = [producer](Buffer* buf) {
+                    return HttpResponse::appendChunk(producer, buf);
+                };
+            }
+            conn->sendStream(producer, done);
+        }
+        request.reset();
+        return false;
+    }
+
+    // Keep-alive中，将不再直接关闭
+    if(!keep_alive){
+        conn->shutdown();
+    }
+    request.reset();
+    return keep_alive;
+}
+
+// 判断连接是否应按 HTTP/2 处理，必要时创建会话
+// @return: 会话指针；HTTP/1.1 连接返回 nullptr；*wait 为 true 表示前言不完整需要等待更多数据
+std::shared_ptr<Http2Session> getHttp2Session(const std::shared_ptr<Connection>& conn, Buffer* buf, bool* wait){
+    *wait = false;
+    std::any* context = conn->getMutableContext();
+    if (context->has_value()) {
+        return std::any_cast<std::shared_ptr<Http2Session>>(*context);
+    }
+    if (!g_enable_http2 || conn->getRequest().gotAll()) {
+        return nullptr;
+    }
+    if (!conn->negotiatedHttp2()) {
+        // 明文连接只支持 prior knowledge，不支持 Upgrade: h2c
+        Http2Session::PrefaceMatch match = Http2Session::matchPreface(buf);
+        if (match == Http2Session::kPrefaceMismatch) return nullptr;
+        if (match == Http2Session::kPrefacePartial) {
+            *wait = true;
+            return nullptr;
+        }
+    }
+    EventLoop* loop = conn->getLoop();
+    auto session = std::make_shared<Http2Session>([loop](HttpRequest& req, HttpResponse* resp) {
+        // 处理函数只填写响应本身的内容，缓存和合并的结果可以原样交给其他连接
+        onHttp2Request(req, resp, loop->busyRatio());
+        DynamicCompression::instance().apply(req, resp, loop->busyRatio());
+        resp->addHeader(HttpResponse::kServer, "TF's Cpp Web Server");
+    });
+    // 异步正文就绪后重新驱动连接的流式发送，由会话的 produce 继续写出 DATA 帧
+    session->setWakeup(conn->streamWakeup());
+    conn->setContext(session);
+    return session;
+}
+
+// 设置给Server的MessageCallBack
+void onMessage(const std::shared_ptr<Connection>& conn, Buffer* buf){
+    if (WebSocketSession* ws = WebSocketSession::get(conn)) {
+        onWebSocketData(conn, ws, buf);
+        return;
+    }
+    // early data 阶段的 HTTP/2 帧等握手完成后再处理
+    if (g_enable_http2 && conn->inEarlyData() && conn->negotiatedHttp2()) {
+        return;
+    }
+    bool wait_preface = false;
+    std::shared_ptr<Http2Session> session = getHttp2Session(conn, buf, &wait_preface);
+    if (wait_preface) {
+        return;
+    }
+    if (session) {
+        Buffer output;
+        bool keep_open = session->onData(buf, &output);
+        if (output.readableBytes() > 0) {
+            conn->send(&output);
+        }
+        // 流式响应的后续数据随连接的可写事件产生
+        if (keep_open && !conn->isStreaming() && session->hasWritableData()) {
+            std::weak_ptr<Http2Session> weak_session = session;
+            conn->sendStream([weak_session](Buffer* out) {
+                auto s = weak_session.lock();
+                return s && s->produce(out);
+            }, nullptr);
+        }
+        if (keep_open) {
+            rearmIdleTimer(conn);
         } else {
-            // 解析出错
-            conn->send("HTTP/1.1 400 Bad Request\r\n\r\n");
             conn->shutdown();
-            break; // 出错后必须退出
+        }
+        return;
+    }
+
+    HttpRequest& request = conn->getRequest();
+    bool rearm = false;
+    // request 可能已在 early data 阶段解析完毕，正等待握手完成
+    // 流式响应写出期间暂停处理后续的流水线请求，由 Connection 在流结束后重新投递
+    while(!conn->isStreaming() && (request.gotAll() || buf->readableBytes() > 0)){
+        if(!request.headersComplete()){
+            // 同一轮循环中排在后面处理的请求也从数据就绪时计时，处理期限包含在本线程中排队的时间
+            if(request.receiveTime().microSecondSinceEpoch() == 0){
+                request.setReceiveTime(conn->getLoop()->pollReturnTime());
+            }
+            bool parse_ok = request.parse(buf);
+            if(!parse_ok){
+                // 解析出错或超出大小上限
+                sendErrorAndClose(conn, request, parseErrorStatus(request));
+                break; // 出错后必须退出
+            }
+            if(!request.headersComplete()){
+                // 数据包不完整，跳出循环，等待更多数据
+                break;
+            }
+        }
+        // 0-RTT early data 可能被重放，只处理 replay_safe 的路由，其余请求（包括请求体）等握手完成后再处理
+        if(conn->inEarlyData()){
+            const RouteOptions* options = g_router.findOptions(request);
+            if(!options || !options->replay_safe){
+                break;
+            }
+        }
+        bool expect_continue = false;
+        if(!request.bodyReaderDecided()){
+            // 流式路由在请求体到达之前装好 BodyReader
+            g_router.prepareBody(request);
+            expect_continue = !request.gotAll() && request.header(HttpRequest::kExpect) == "100-continue";
+        }
+        if(!request.gotAll()){
+            if(!request.parse(buf)){
+                if(request.getBodyReader()){
+                    // BodyReader 中止了接收，由它给出错误响应；剩余请求体无法跳过，只能关闭连接
+                    rearm = sendResponse(conn, request, false);
+                }else{
+                    sendErrorAndClose(conn, request, parseErrorStatus(request));
+                }
+                break;
+            }
+            // 客户端在收到 100 Continue 之前不会发送请求体；声明的长度超限时上面已经回应 413
+            if(expect_continue && !request.gotAll()){
+                conn->send("HTTP/1.1 100 Continue\r\n\r\n");
+            }
+            if(!request.gotAll()){
+                break;
+            }
+        }
+        rearm = sendResponse(conn, request, request.keepAlive());
+        if(WebSocketSession* ws = WebSocketSession::get(conn)){
+            // 升级请求之后的数据已经是 WebSocket 帧
+            onWebSocketData(conn, ws, buf);
+            return;
         }
     }
+    // 请求尚未读完时改用读取期限
+    bool partial = request.headersComplete() ? !request.gotAll() : buf->readableBytes() > 0;
+    if(partial && conn->connected() && !conn->isStreaming()){
+        armReadDeadline(conn);
+    }else if(rearm){
+        rearmIdleTimer(conn);
+    }
 }
 
 // 去除首尾空白
@@ -107,6 +521,9 @@ std::string trim(const std::string& str) {
 }
 
 int main(int argc, char* argv[]){
+    // 对端已关闭时写 socket（如回应 close_notify）不应终止进程，由返回值 EPIPE 处理
+    ::signal(SIGPIPE, SIG_IGN);
+
     try{
         std::filesystem::path exe_path = std::filesystem::canonical(argv[0]);
         std::filesystem::path project_root = exe_path.parent_path().parent_path();
@@ -114,10 +531,16 @@ int main(int argc, char* argv[]){
         base_path = (project_root/"www").string();
 
         if(!std::filesystem::exists(base_path) || !std::filesystem::is_directory(base_path)){
-            std::cerr << "Error: Web root directory '" << base_path << "' not found" << std::endl;
-            return 1;
+            // 资源已编译进程序时可以不挂载 www/
+            if (EmbeddedAssets::count() == 0) {
+                std::cerr << "Error: Web root directory '" << base_path << "' not found" << std::endl;
+                return 1;
+            }
+            std::cout << "Web root '" << base_path << "' not found, serving embedded assets only" << std::endl;
+            has_web_root = false;
+        } else {
+            std::cout << "Using web root: " << base_path << std::endl;
         }
-        std::cout << "Using web root: " << base_path << std::endl;
     }catch(const std::filesystem::filesystem_error& e){
         std::cerr << "Filesystem error: " << e.what() << std::endl;
         return 1;
@@ -189,12 +612,97 @@ int main(int argc, char* argv[]){
                 return 1;
             }
             LOG_INFO << "Database opened successfully.";
+            // 数据变化时让依赖它的缓存响应失效
+            g_db->SetWriteListener([](const std::string& key) {
+                ResponseCache::instance().invalidate(key);
+            });
         }catch (const std::exception& e){
             LOG_FATAL << "Failed to open database." << e.what();
             return 1;
         }
     }
 
+    // 静态资源的压缩变体可以在启动时生成，也可以留到第一次请求时
+    if (has_web_root && config.getBool("static", "precompress", true)) {
+        PrecompressedCache::instance().warmUp(base_path);
+    }
+    {
+        StaticFileCache::Options options;
+        options.budget = static_cast<size_t>(config.getInt("static", "cache_mb", 64)) * 1024 * 1024;
+        options.max_file_size = static_cast<size_t>(config.getInt("static", "cache_max_file_kb", 256)) * 1024;
+        StaticFileCache::instance().setOptions(options);
+    }
+    // 冷文件的读取和压缩变体的生成交给磁盘线程，0 表示在 I/O 线程中同步完成
+    DiskIoPool::instance().start(config.getInt("static", "disk_threads", 2));
+
+    {
+        DynamicCompression::Options options;
+        options.enabled = config.getBool("compression", "dynamic", true);
+        options.min_size = static_cast<size_t>(config.getInt("compression", "min_size", 1024));
+        options.fast_load = config.getDouble("compression", "fast_load", 0.5);
+        options.off_load = config.getDouble("compression", "off_load", 0.85);
+        DynamicCompression::instance().setOptions(options);
+    }
+    {
+        WebSocketHub::Options options;
+        options.ping_interval = config.getDouble("websocket", "ping_interval", 30);
+        options.max_message_size = static_cast<size_t>(config.getInt("websocket", "max_message_kb", 64)) * 1024;
+        options.max_pending_output = static_cast<size_t>(config.getInt("websocket", "max_pending_kb", 1024)) * 1024;
+        WebSocketHub::instance().setOptions(options);
+    }
+    {
+        HttpRequest::Limits limits;
+        limits.max_request_line = static_cast<size_t>(config.getInt("limits", "max_request_line_kb", 8)) * 1024;
+        limits.max_header_size = static_cast<size_t>(config.getInt("limits", "max_header_kb", 32)) * 1024;
+        limits.max_headers = static_cast<size_t>(config.getInt("limits", "max_headers", 100));
+        limits.max_body_size = static_cast<size_t>(config.getInt("limits", "max_body_kb", 8192)) * 1024;
+        HttpRequest::setLimits(limits);
+        g_header_timeout = config.getDouble("limits", "header_timeout", 10);
+        g_body_timeout = config.getDouble("limits", "body_timeout", 30);
+    }
+    {
+        OverloadController::Options options;
+        options.enabled = config.getBool("overload", "enabled", true);
+        options.max_lag = config.getDouble("overload", "max_lag_ms", 100) / 1000;
+        options.retry_after = config.getInt("overload", "retry_after", 1);
+        OverloadController::instance().setOptions(options);
+        // 路由匹配之后、处理函数之前按处理该请求的 I/O 线程的事件延迟决定是否接受
+        g_router.setGuard([](HttpRequest& req, const RouteOptions& route, HttpResponse* resp){
+            EventLoop* loop = EventLoop::getEventLoopOfCurrentThread();
+            return OverloadController::instance().admit(req, route, loop ? loop->eventLag() : 0, resp);
+        });
+    }
+    {
+        ResponseCache::Options options;
+        options.enabled = config.getBool("response_cache", "enabled", true);
+        options.max_entries = static_cast<size_t>(config.getInt("response_cache", "max_entries", 1024));
+        options.max_body_size = static_cast<size_t>(config.getInt("response_cache", "max_body_kb", 1024)) * 1024;
+        ResponseCache::instance().setOptions(options);
+    }
+
+    // 静态资源的 Cache-Control 规则 "路径正则, 指令"，按名字顺序匹配
+    for (const auto& pair : config.getSection("cache_control")) {
+        std::string value = pair.second;
+        size_t comment_pos = value.find_first_of(";#");
+        if (comment_pos != std::string::npos) {
+            value = value.substr(0, comment_pos);
+        }
+        size_t comma = value.find(',');
+        if (comma == std::string::npos) {
+            LOG_ERROR << "Invalid cache_control rule: " << pair.second;
+            continue;
+        }
+        std::string pattern = trim(value.substr(0, comma));
+        std::string directive = trim(value.substr(comma + 1));
+        if (CacheControlPolicy::instance().addRule(pattern, directive)) {
+            LOG_INFO << "Cache-Control for " << pattern << ": " << directive;
+        }
+    }
+    if (EmbeddedAssets::count() > 0) {
+        EmbeddedAssets::instance();
+        LOG_INFO << "Serving " << EmbeddedAssets::count() << " embedded static assets";
+    }
+
     try{
         // **从配置文件动态加载路由**
         LOG_INFO << "Loading routes from config...";
@@ -203,6 +711,7 @@ int main(int argc, char* argv[]){
             LOG_WARN << "No [routes] section found in config file.";
         } else {
             const auto& handler_registry = Handlers::getHandlerRegistry();
+            const auto& reader_registry = Handlers::getBodyReaderRegistry();
             for (const auto& pair : routes_config) {
                 // 解析 "METHOD, /path/pattern, handler_name"
                 std::string value = pair.second;
@@ -215,12 +724,35 @@ int main(int argc, char* argv[]){
                 
                 std::getline(ss, method_str, ',');
                 std::getline(ss, path, ',');
-                std::getline(ss, handler_name);
+                std::getline(ss, handler_name, ',');
 
                 method_str = trim(method_str);
                 path = trim(path);
                 handler_name = trim(handler_name);
 
+                // 其余字段为路由属性
+                RouteOptions options;
+                std::string option;
+                while (std::getline(ss, option, ',')) {
+                    option = trim(option);
+                    size_t eq = option.find('=');
+                    std::string option_value = eq == std::string::npos ? std::string() : trim(option.substr(eq + 1));
+                    if (eq != std::string::npos) option = trim(option.substr(0, eq));
+                    if (option == "replay_safe") options.replay_safe = true;
+                    else if (option == "coalesce") options.coalesce = true;
+                    else if (option == "cache_ttl") options.cache_ttl = std::strtod(option_value.c_str(), nullptr);
+                    else if (option == "cache_stale") options.cache_stale = std::strtod(option_value.c_str(), nullptr);
+                    else if (option == "deadline") options.deadline = std::strtod(option_value.c_str(), nullptr);
+                    else if (option == "low_priority") options.low_priority = true;
+                    else if (option == "cache_tags") {
+                        std::stringstream tags(option_value);
+                        std::string tag;
+                        while (tags >> tag) options.cache_tags.push_back(tag);
+                        ResponseCache::instance().addTags(options.cache_tags);
+                    }
+                    else if (!option.empty()) LOG_WARN << "Unknown route option '" << option << "' in " << pair.first;
+                }
+
                 // 字符串转 Method 枚举
                 HttpRequest::Method method = HttpRequest::INVALID;
                 if (method_str == "GET") method = HttpRequest::GET;
@@ -229,11 +761,16 @@ int main(int argc, char* argv[]){
 
                 // 查找 Handler
                 auto handler_it = handler_registry.find(handler_name);
+                auto reader_it = reader_registry.find(handler_name);
                 
                 if (method != HttpRequest::INVALID && handler_it != handler_registry.end()) {
-                    if (g_router.addRoute(method, path, handler_it->second)) {
+                    if (g_router.addRoute(method, path, handler_it->second, options)) {
                         LOG_INFO << "Added route: " << method_str << " " << path << " -> " << handler_name;
                     }
+                } else if (method != HttpRequest::INVALID && reader_it != reader_registry.end()) {
+                    if (g_router.addStreamRoute(method, path, reader_it->second, options)) {
+                        LOG_INFO << "Added streaming route: " << method_str << " " << path << " -> " << handler_name;
+                    }
                 } else {
                     LOG_ERROR << "Failed to add route: " << pair.second;
                 }
@@ -248,12 +785,24 @@ int main(int argc, char* argv[]){
 
 
         EventLoop loop;
+        // 静态文件缓存依赖 inotify 失效，无法监视目录时关闭缓存
+        std::unique_ptr<StaticFileWatcher> static_watcher;
+        if (has_web_root && StaticFileCache::instance().enabled()) {
+            static_watcher = std::make_unique<StaticFileWatcher>(&loop, base_path);
+            if (!static_watcher->valid()) {
+                LOG_WARN << "Static file cache disabled: cannot watch " << base_path;
+                StaticFileCache::instance().setOptions(StaticFileCache::Options{0, 0});
+            }
+        }
         int num_threads = config.getInt("server", "threads", 0);
+        g_enable_http2 = config.getBool("server", "enable_http2", false);
+        size_t input_window = static_cast<size_t>(config.getInt("server", "input_window_kb", 256)) * 1024;
 
         // ----------------HTTP Server----------------------------------
         uint16_t http_port = config.getInt("server", "http_port", 8080);
         Server http_server(&loop, http_port, kIdleConnectionTimeout, num_threads);
         http_server.setMessageCallback(onMessage); // HTTP请求的处理逻辑
+        http_server.setInputWindow(input_window);
         http_server.start();
         LOG_INFO << "HTTP_Server starting...";
         LOG_INFO << "Port: " << http_port;
@@ -266,10 +815,12 @@ int main(int argc, char* argv[]){
             uint16_t https_port = config.getInt("server", "https_port", 8443);
             https_server_ptr = std::make_unique<Server>(&loop, https_port, kIdleConnectionTimeout, num_threads);
             https_server_ptr->setMessageCallback(onMessage); // 同一个处理逻辑
+            https_server_ptr->setInputWindow(input_window);
 
             std::string cert_path = project_root_path + "/" + config.getString("ssl", "cert_path");
             std::string key_path = project_root_path + "/" + config.getString("ssl", "key_path");
-            https_server_ptr->enableSsl(cert_path, key_path);
+            uint32_t max_early_data = config.getInt("ssl", "max_early_data", 0);
+            https_server_ptr->enableSsl(cert_path, key_path, max_early_data, g_enable_http2);
 
             https_server_ptr->start();
 
@@ -280,6 +831,8 @@ int main(int argc, char* argv[]){
         }
         // 启动事件循环
         loop.loop();
+        // 磁盘任务完成时会回到各 EventLoop，先于它们停止
+        DiskIoPool::instance().stop();
         
         g_async_log.release(); // 释放所有权
     }catch(const std::exception& e){
@@ -26,4 +26,14 @@ std::string MimeTypes::getMimeType(const std::string& extension){
     }
     // 如果找不到，返回通用二进制流类型
     return "application/octet-stream";
+}
+
+bool MimeTypes::isCompressible(const std::string& mime_type){
+    if(mime_type.compare(0, 5, "text/") == 0){
+        return true;
+    }
+    // 去掉 "; charset=..." 等参数
+    std::string type = mime_type.substr(0, mime_type.find(';'));
+    return type == "application/javascript" || type == "application/json" ||
+           type == "application/x-ndjson" || type == "application/xml" || type == "image/svg+xml";
 }
\ No newline at end of file
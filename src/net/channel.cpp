@@ -8,7 +8,7 @@ const int Channel::kReadEvent = EPOLLIN | EPOLLPRI | EPOLLET; // EPOLLET表示
 const int Channel::kWriteEvent = EPOLLOUT;
 
 Channel::Channel(EventLoop* loop, int fd)
-    : loop_(loop), fd_(fd), events_(0), revents_(0) {}
+    : loop_(loop), fd_(fd), events_(0), revents_(0), tied_(false) {}
 
 Channel::~Channel(){
     // Channel对象被析构时，必须确保它不再监听任何事件
@@ -4,6 +4,7 @@
 #include "connection.h"
 #include "net/timer.h"
 #include "utils/logger.h"
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <sys/eventfd.h>
@@ -19,7 +20,12 @@ EventLoop::EventLoop()
       poller_(new Poller(this)),
       timer_queue_(new TimerQueue(this)),
       wakeup_fd_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), // 创建eventfd
-      wakeup_channel_(new Channel(this, wakeup_fd_)){
+      wakeup_channel_(new Channel(this, wakeup_fd_)),
+      busy_ratio_(0),
+      window_busy_us_(0),
+      window_total_us_(0),
+      window_max_busy_us_(0),
+      loop_lag_(0){
         if(t_loop_in_this_thread){
             // Log FATAL: Another EventLoop exists in this thread
             exit(1);
@@ -57,7 +63,10 @@ void EventLoop::loop(){
             int64_t diff = earliest.microSecondSinceEpoch() - Timestamp::now().microSecondSinceEpoch();
             timeout_ms = (diff < 0) ? 0 : diff / 1000;
         }
+        Timestamp poll_begin = Timestamp::now();
         poller_->poll(static_cast<int>(timeout_ms), &active_channels_); // 10秒超时
+        Timestamp poll_end = Timestamp::now();
+        poll_return_time_ = poll_end;
 
         for(Channel* channel : active_channels_){
             channel->handleEvent();
@@ -65,6 +74,7 @@ void EventLoop::loop(){
         doPendingFunctors(); // 处理完I/O事件后，处理挂起的任务
         // 处理到期的定时器
         timer_queue_->handleExpireTimers();
+        updateBusyRatio(poll_begin, poll_end, Timestamp::now());
     }
 
     looping_ = false;
@@ -79,6 +89,36 @@ void EventLoop::handleRead(){
     }
 }
 
+void EventLoop::updateBusyRatio(Timestamp poll_begin, Timestamp poll_end, Timestamp loop_end){
+    int64_t busy_us = loop_end.microSecondSinceEpoch() - poll_end.microSecondSinceEpoch();
+    window_busy_us_ += busy_us;
+    window_total_us_ += loop_end.microSecondSinceEpoch() - poll_begin.microSecondSinceEpoch();
+    // epoll_wait 阻塞过说明当时没有积压的事件，之前的处理耗时不再代表排队延迟
+    if(poll_end.microSecondSinceEpoch() - poll_begin.microSecondSinceEpoch() >= kIdlePollUs){
+        loop_lag_ = 0;
+        window_max_busy_us_ = 0;
+    }
+    window_max_busy_us_ = std::max(window_max_busy_us_, busy_us);
+    if(window_total_us_ < kLoadWindowUs){
+        return;
+    }
+    double ratio = static_cast<double>(window_busy_us_) / static_cast<double>(window_total_us_);
+    busy_ratio_ = 0.5 * busy_ratio_ + 0.5 * ratio;
+    loop_lag_ = 0.5 * loop_lag_ + 0.5 * static_cast<double>(window_max_busy_us_) / Timestamp::kMicroSecondsPerSecond;
+    window_busy_us_ = 0;
+    window_total_us_ = 0;
+    window_max_busy_us_ = 0;
+}
+
+double EventLoop::eventLag() const{
+    if(poll_return_time_.microSecondSinceEpoch() == 0) return loop_lag_;
+    return std::max(loop_lag_, timeDifference(Timestamp::now(), poll_return_time_));
+}
+
+EventLoop* EventLoop::getEventLoopOfCurrentThread(){
+    return t_loop_in_this_thread;
+}
+
 void EventLoop::quit(){
     quit_ = true;
     // TODO 如果是在其他线程调用quit，可能需要唤醒loop，暂不实现
@@ -2,16 +2,37 @@
 #include <openssl/err.h>
 #include <stdexcept>
 
-SslContext::SslContext(const std::string& cert_path, const std::string& key_path){
+namespace {
+// ALPN 协议列表，格式为长度前缀的字符串序列，按服务端偏好排序
+const unsigned char kAlpnH2AndHttp11[] = "\x02h2\x08http/1.1";
+const unsigned char kAlpnHttp11[] = "\x08http/1.1";
+}
+
+SslContext::SslContext(const std::string& cert_path, const std::string& key_path, uint32_t max_early_data,
+                       bool enable_http2)
+    : enable_http2_(enable_http2){
     // 创建SSL_CTX
     ctx_ = SSL_CTX_new(TLS_server_method());
+    if(!ctx_){
+        throw std::runtime_error("SSL_CTX_new failed");
+    }
     // 设置 Session ID Context，这对 Session Resumption 很重要
     const unsigned char session_id_context[] = "TF_WebServer";
     SSL_CTX_set_session_id_context(ctx_, session_id_context, sizeof(session_id_context));
-    if(!ctx_){
-        throw std::runtime_error("SSL_CTX_new failed");
+    // Connection 的输出缓冲区在 SSL_write 重试之间可能扩容搬移
+    SSL_CTX_set_mode(ctx_, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+    // TLS 1.3 0-RTT：early data 可被重放，使用有状态的单次票据（服务端会话缓存）
+    // 让 OpenSSL 内建的防重放生效；是否能在 early data 阶段处理由路由的 replay_safe 决定
+    if(max_early_data > 0){
+        SSL_CTX_set_options(ctx_, SSL_OP_NO_TICKET);
+        SSL_CTX_set_max_early_data(ctx_, max_early_data);
+        SSL_CTX_set_recv_max_early_data(ctx_, max_early_data);
     }
 
+    // ALPN：客户端未携带扩展时回调不会被调用，按 HTTP/1.1 处理
+    SSL_CTX_set_alpn_select_cb(ctx_, &SslContext::alpnSelectCallback, this);
+
     // 加载服务器证书
     if(SSL_CTX_use_certificate_file(ctx_, cert_path.c_str(), SSL_FILETYPE_PEM) <= 0){
         ERR_print_errors_fp(stderr);
@@ -31,6 +52,21 @@ SslContext::SslContext(const std::string& cert_path, const std::string& key_path
     }
 }
 
+int SslContext::alpnSelectCallback(SSL* ssl, const unsigned char** out, unsigned char* outlen,
+                                   const unsigned char* in, unsigned int inlen, void* arg){
+    (void)ssl;
+    const SslContext* self = static_cast<const SslContext*>(arg);
+    const unsigned char* server = self->enable_http2_ ? kAlpnH2AndHttp11 : kAlpnHttp11;
+    unsigned int server_len = self->enable_http2_ ? sizeof(kAlpnH2AndHttp11) - 1 : sizeof(kAlpnHttp11) - 1;
+    unsigned char* selected = nullptr;
+    if(SSL_select_next_proto(&selected, outlen, server, server_len, in, inlen) != OPENSSL_NPN_NEGOTIATED){
+        // 没有共同协议时不选择，继续握手（RFC 7301 允许服务端忽略）
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+    *out = selected;
+    return SSL_TLSEXT_ERR_OK;
+}
+
 SslContext::~SslContext(){
     if(ctx_){
         SSL_CTX_free(ctx_);
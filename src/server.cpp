@@ -10,7 +10,8 @@
 
 Server::Server(EventLoop* loop, uint16_t port, const int kIdleConnectionTimeout, int num_threads) : loop_(loop), port_(port),
     listen_socket_(new Socket(::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0))),
-    accept_channel_(new Channel(loop, listen_socket_->getFd())), kIdleConnectionTimeout(kIdleConnectionTimeout),
+    accept_channel_(new Channel(loop, listen_socket_->getFd())), input_window_(Connection::kDefaultInputWindow),
+    kIdleConnectionTimeout(kIdleConnectionTimeout),
     thread_pool_(new EventLoopThreadPool(loop, "worker", num_threads))
 {
     // 创建Socket监听
@@ -79,6 +80,7 @@ void Server::handleConnection(){
                 // 设置回调函数
                 conn->setConnectionCallback(connection_callback_);
                 conn->setMessageCallback(message_callback_);
+                conn->setInputWindow(input_window_);
                 conn->setCloseCallback(std::bind(&EventLoop::removeConnection, io_loop, std::placeholders::_1));
                 // 在io_loop自己的线程中将新的连接加入自己的map管理
                 io_loop->addConnection(connfd, conn);
@@ -116,6 +118,7 @@ void Server::onConnection(const ConnectionPtr& conn){
     conn->setTimerId(timer_id);
 }
 
-void Server::enableSsl(const std::string& cert_path, const std::string& key_path){
-    ssl_context_ = std::make_unique<SslContext>(cert_path, key_path);
+void Server::enableSsl(const std::string& cert_path, const std::string& key_path, uint32_t max_early_data,
+                       bool enable_http2){
+    ssl_context_ = std::make_unique<SslContext>(cert_path, key_path, max_early_data, enable_http2);
 }
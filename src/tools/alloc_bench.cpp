@@ -0,0 +1,174 @@
+// 每种请求在 keep-alive 连接上的内存分配次数
+// 一个请求依次经过：解析、路由匹配、处理函数、序列化响应头，最后 reset() 准备下一个请求；
+// 预热后统计稳态下每个请求调用 operator new 的次数和字节数
+// 注意：测的是替身路径。处理函数不是 src/http/ 中注册的真实处理函数（它们依赖数据库和静态文件缓存），
+// 而是本文件中模仿其常见操作（路由参数、查询串、表单字段、JSON、设置头部和正文）的替身；
+// 解析、路由、HttpRequest/HttpResponse 是服务器的真实代码，结果只反映这部分的改动，不随处理函数的修改而变化
+// 用法: ./alloc_bench [iterations]
+#include "http/http_router.h"
+#include "http_request.h"
+#include "http_response.h"
+#include "buffer.h"
+#include "bench_common.h"
+#include "utils/json.hpp"
+#include "utils/logger.h"
+#include <iostream>
+#include <iomanip>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+namespace {
+
+size_t g_allocs = 0;
+size_t g_alloc_bytes = 0;
+
+} // namespace
+
+void* operator new(size_t size) {
+    ++g_allocs;
+    g_alloc_bytes += size;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+using json = nlohmann::json;
+using ArenaString = std::pmr::string;
+
+// 以下是替身处理函数：模仿 handlers.cpp / handlers_algo.cpp 中对应路由的典型操作，不访问数据库，
+// 也不会随真实处理函数一起修改
+
+// 静态页面：正文引用静态文件缓存中的内容
+void handleStaticPage(const HttpRequest& req, HttpResponse* resp) {
+    static const std::string kPage(4096, 'x');
+    resp->setStatusCode(HttpResponse::k200Ok);
+    resp->setContentType(req.getPath().size() > 4 && req.getPath().compare(req.getPath().size() - 4, 4, ".css") == 0
+                             ? "text/css; charset=utf-8" : "text/html; charset=utf-8");
+    resp->addHeader(HttpResponse::kVary, "Accept-Encoding");
+    resp->addHeader(HttpResponse::kETag, "\"5e1-18c3a2b7f40\"");
+    resp->addHeader(HttpResponse::kLastModified, "Tue, 12 Dec 2023 08:21:33 GMT");
+    resp->addHeader(HttpResponse::kAcceptRanges, "bytes");
+    resp->setBody(SharedBuffer(nullptr, kPage));
+    resp->setContentLength(kPage.size());
+}
+
+// 题目列表：读取查询参数，按条件生成 JSON 列表
+void handleProblemList(const HttpRequest& req, HttpResponse* resp) {
+    const UrlParams& query = req.queryParams();
+    size_t matched = 0;
+    for (const char* name : {"search", "tag", "fav_id", "limit", "offset", "page"}) {
+        matched += query.get(name).size();
+    }
+    json list = json::array();
+    for (int id = 1; id <= 3; ++id) {
+        list.push_back({{"id", id + static_cast<int>(matched)}, {"title", "Two Sum"}, {"difficulty", "Easy"}, {"algorithm", "hash"}});
+    }
+    resp->setStatusCode(HttpResponse::k200Ok);
+    resp->setContentType("application/json; charset=utf-8");
+    resp->setBody(list.dump());
+    resp->setContentLength(resp->getBody().size());
+}
+
+// 题目详情：路由参数拼出数据库 key
+void handleProblemDetail(const HttpRequest& req, HttpResponse* resp) {
+    const RouteParams& params = req.getRouteParams();
+    ArenaString key("problem:", req.arena());
+    key.append(params[0].data(), params[0].size());
+    json problem = {{"id", 42}, {"title", "Two Sum"}, {"difficulty", "Easy"}, {"code", "return {};"}};
+    resp->setStatusCode(HttpResponse::k200Ok);
+    resp->setContentType("application/json; charset=utf-8");
+    resp->setBody(problem.dump());
+    resp->setContentLength(resp->getBody().size());
+}
+
+// 表单提交：读取各字段后返回结果
+void handleAddProblem(const HttpRequest& req, HttpResponse* resp) {
+    static const char* const kFields[] = {"title", "difficulty", "description", "algorithm", "time_complexity", "code"};
+    size_t total = 0;
+    for (const char* field : kFields) {
+        total += req.formParams().get(field).size();
+    }
+    json result = {{"status", "success"}, {"id", static_cast<int>(total)}};
+    resp->setStatusCode(HttpResponse::k200Ok);
+    resp->setContentType("application/json; charset=utf-8");
+    resp->setBody(result.dump());
+    resp->setContentLength(resp->getBody().size());
+}
+
+// 标签列表：固定的 JSON 数组
+void handleTags(const HttpRequest&, HttpResponse* resp) {
+    json tags = {"数组", "哈希表", "动态规划"};
+    resp->setStatusCode(HttpResponse::k200Ok);
+    resp->setContentType("application/json; charset=utf-8");
+    resp->setBody(tags.dump());
+    resp->setContentLength(resp->getBody().size());
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? std::atol(argv[1]) : 100000;
+    Logger::setOutput([](const char*, int) {}); // 不输出注册路由的日志
+    std::vector<Capture> captures = loadCaptures();
+    captures.push_back({"curl_route_param",
+        "GET /api/problems/42 HTTP/1.1\r\n"
+        "Host: 127.0.0.1:12345\r\n"
+        "User-Agent: curl/7.88.1\r\n"
+        "Accept: */*\r\n"
+        "\r\n"});
+
+    HttpRouter router;
+    router.addRoute(HttpRequest::GET, "/problem.html", handleStaticPage);
+    router.addRoute(HttpRequest::GET, "/static/*path", handleStaticPage);
+    router.addRoute(HttpRequest::GET, "/api/problems", handleProblemList);
+    router.addRoute(HttpRequest::GET, "/api/problems/{id:int}", handleProblemDetail);
+    router.addRoute(HttpRequest::POST, "/api/problems", handleAddProblem);
+    router.addRoute(HttpRequest::GET, "/api/tags", handleTags);
+
+    std::cout << std::left << std::setw(20) << "capture" << std::right << std::setw(14) << "allocs/req"
+              << std::setw(14) << "bytes/req" << std::endl;
+
+    // 同一个 HttpRequest 和输出缓冲区在各请求间复用，与 keep-alive 连接相同
+    HttpRequest request;
+    Buffer input;
+    Buffer output;
+    auto serve = [&](const Capture& capture) {
+        input.append(capture.data);
+        if (!parseRequest(&request, &input) || !request.gotAll()) return false;
+        {
+            HttpResponse response(request.arena());
+            router.route(request, &response);
+            response.appendHeadToBuffer(&output);
+        }
+        output.retrieveAll();
+        request.reset();
+        return true;
+    };
+
+    for (const Capture& capture : captures) {
+        // 预热：让复用的缓冲区和内存池达到稳定容量
+        for (int i = 0; i < 16; ++i) {
+            if (!serve(capture)) {
+                std::cerr << capture.name << ": parse failed" << std::endl;
+                return 1;
+            }
+        }
+        size_t allocs = g_allocs;
+        size_t bytes = g_alloc_bytes;
+        for (long i = 0; i < iterations; ++i) {
+            serve(capture);
+        }
+        double per_req = static_cast<double>(g_allocs - allocs) / iterations;
+        double bytes_per_req = static_cast<double>(g_alloc_bytes - bytes) / iterations;
+        std::cout << std::left << std::setw(20) << capture.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << per_req << std::setw(14) << bytes_per_req << std::endl;
+    }
+    return 0;
+}
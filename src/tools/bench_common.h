@@ -0,0 +1,100 @@
+#pragma once
+// 基准工具共用的请求报文和解析辅助函数
+#include "http_request.h"
+#include "buffer.h"
+#include <string>
+#include <vector>
+
+struct Capture {
+    const char* name;
+    std::string data;
+};
+
+// 抓包来源：Chrome 120 / Firefox 121 / curl 7.88 访问本服务器，Cookie 与 IP 已替换
+inline std::vector<Capture> loadCaptures() {
+    std::vector<Capture> captures;
+    captures.push_back({"chrome_navigate",
+        "GET /problem.html?id=42 HTTP/1.1\r\n"
+        "Host: 127.0.0.1:12345\r\n"
+        "Connection: keep-alive\r\n"
+        "sec-ch-ua: \"Not_A Brand\";v=\"8\", \"Chromium\";v=\"120\", \"Google Chrome\";v=\"120\"\r\n"
+        "sec-ch-ua-mobile: ?0\r\n"
+        "sec-ch-ua-platform: \"Linux\"\r\n"
+        "Upgrade-Insecure-Requests: 1\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,image/apng,*/*;q=0.8,application/signed-exchange;v=b3;q=0.7\r\n"
+        "Sec-Fetch-Site: same-origin\r\n"
+        "Sec-Fetch-Mode: navigate\r\n"
+        "Sec-Fetch-User: ?1\r\n"
+        "Sec-Fetch-Dest: document\r\n"
+        "Referer: http://127.0.0.1:12345/index.html\r\n"
+        "Accept-Encoding: gzip, deflate, br\r\n"
+        "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8\r\n"
+        "Cookie: session_id=9f2c4e1a7b3d4c5e8f6a0b1c2d3e4f50; theme=dark\r\n"
+        "If-None-Match: \"5e1-18c3a2b7f40\"\r\n"
+        "If-Modified-Since: Tue, 12 Dec 2023 08:21:33 GMT\r\n"
+        "\r\n"});
+    captures.push_back({"chrome_static_css",
+        "GET /static/css/style.css HTTP/1.1\r\n"
+        "Host: 127.0.0.1:12345\r\n"
+        "Connection: keep-alive\r\n"
+        "sec-ch-ua: \"Not_A Brand\";v=\"8\", \"Chromium\";v=\"120\", \"Google Chrome\";v=\"120\"\r\n"
+        "sec-ch-ua-mobile: ?0\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36\r\n"
+        "sec-ch-ua-platform: \"Linux\"\r\n"
+        "Accept: text/css,*/*;q=0.1\r\n"
+        "Sec-Fetch-Site: same-origin\r\n"
+        "Sec-Fetch-Mode: no-cors\r\n"
+        "Sec-Fetch-Dest: style\r\n"
+        "Referer: http://127.0.0.1:12345/problem.html?id=42\r\n"
+        "Accept-Encoding: gzip, deflate, br\r\n"
+        "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8\r\n"
+        "Cookie: session_id=9f2c4e1a7b3d4c5e8f6a0b1c2d3e4f50; theme=dark\r\n"
+        "\r\n"});
+    captures.push_back({"firefox_xhr",
+        "GET /api/problems?tag=%E5%8A%A8%E6%80%81%E8%A7%84%E5%88%92&page=2 HTTP/1.1\r\n"
+        "Host: 127.0.0.1:12345\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:121.0) Gecko/20100101 Firefox/121.0\r\n"
+        "Accept: application/json, text/plain, */*\r\n"
+        "Accept-Language: zh-CN,zh;q=0.8,zh-TW;q=0.7,zh-HK;q=0.5,en-US;q=0.3,en;q=0.2\r\n"
+        "Accept-Encoding: gzip, deflate, br\r\n"
+        "Connection: keep-alive\r\n"
+        "Referer: http://127.0.0.1:12345/index.html\r\n"
+        "Cookie: session_id=9f2c4e1a7b3d4c5e8f6a0b1c2d3e4f50; theme=dark\r\n"
+        "Sec-Fetch-Dest: empty\r\n"
+        "Sec-Fetch-Mode: cors\r\n"
+        "Sec-Fetch-Site: same-origin\r\n"
+        "\r\n"});
+    captures.push_back({"firefox_form_post",
+        "POST /api/problems HTTP/1.1\r\n"
+        "Host: 127.0.0.1:12345\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:121.0) Gecko/20100101 Firefox/121.0\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8\r\n"
+        "Accept-Language: zh-CN,zh;q=0.8,zh-TW;q=0.7,zh-HK;q=0.5,en-US;q=0.3,en;q=0.2\r\n"
+        "Accept-Encoding: gzip, deflate, br\r\n"
+        "Content-Type: application/x-www-form-urlencoded\r\n"
+        "Content-Length: 121\r\n"
+        "Origin: http://127.0.0.1:12345\r\n"
+        "Connection: keep-alive\r\n"
+        "Referer: http://127.0.0.1:12345/add.html\r\n"
+        "Cookie: session_id=9f2c4e1a7b3d4c5e8f6a0b1c2d3e4f50; theme=dark\r\n"
+        "Upgrade-Insecure-Requests: 1\r\n"
+        "\r\n"
+        "title=Two+Sum&difficulty=Easy&description=%E7%BB%99%E5%AE%9A%E6%95%B0%E7%BB%84&algorithm=hash&time_complexity=O(n)&code=x"});
+    captures.push_back({"curl_minimal",
+        "GET /api/tags HTTP/1.1\r\n"
+        "Host: 127.0.0.1:12345\r\n"
+        "User-Agent: curl/7.88.1\r\n"
+        "Accept: */*\r\n"
+        "\r\n"});
+    return captures;
+}
+
+// 请求头解析完成时 parse 会先返回一次，再次调用解析请求体
+inline bool parseRequest(HttpRequest* request, Buffer* buffer) {
+    if (!request->parse(buffer)) return false;
+    if (request->headersComplete() && !request->gotAll()) {
+        return request->parse(buffer);
+    }
+    return true;
+}
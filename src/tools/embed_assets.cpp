@@ -0,0 +1,164 @@
+// 构建时把 www/ 打包为资源表源文件，供 EMBED_WWW 模式编译进 server
+// MIME 类型、ETag 和 gzip/brotli 变体都在这里预先算好，运行时不再处理
+// 用法: ./embed_assets <www 目录> <输出的 .cpp 文件>
+#include "http/compression.h"
+#include "mime_types.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <sys/stat.h>
+
+namespace fs = std::filesystem;
+
+// 与运行时的预压缩保持一致
+static const size_t kMinCompressSize = 256;
+static const int kGzipLevel = 9;
+static const int kBrotliQuality = 11;
+
+struct Asset {
+    std::string path;
+    std::string mime_type;
+    std::string etag;
+    time_t mtime;
+    std::string data;
+    std::string gzip;
+    std::string brotli;
+};
+
+static bool readFile(const fs::path& path, std::string* content) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file) return false;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    *content = buffer.str();
+    return true;
+}
+
+// FNV-1a，资源内容不变则 ETag 不变，与构建机器和部署方式无关
+static std::string contentETag(const std::string& data) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    char buf[40];
+    snprintf(buf, sizeof(buf), "\"%zx-%016llx\"", data.size(), static_cast<unsigned long long>(hash));
+    return buf;
+}
+
+// 字符串字面量中需要转义的只有引号和反斜杠（路径和 MIME 类型都是可打印字符）
+static std::string quote(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static void writeArray(std::ostream& out, const std::string& name, const std::string& data) {
+    out << "static const unsigned char " << name << "[] = {";
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (i % 16 == 0) out << "\n    ";
+        char buf[8];
+        snprintf(buf, sizeof(buf), "0x%02x,", static_cast<unsigned char>(data[i]));
+        out << buf;
+    }
+    // 空文件也需要一个元素，数组长度不能为 0
+    if (data.empty()) out << "\n    0x00,";
+    out << "\n};\n";
+}
+
+static bool hasCompressedSuffix(const fs::path& path) {
+    std::string ext = path.extension().string();
+    return ext == ".gz" || ext == ".br";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <www_dir> <output.cpp>" << std::endl;
+        return 1;
+    }
+    fs::path root(argv[1]);
+    std::vector<Asset> assets;
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(root, ec); !ec && it != fs::recursive_directory_iterator();
+         it.increment(ec)) {
+        if (!it->is_regular_file(ec)) continue;
+        const fs::path& file = it->path();
+        // 已有源文件的 .gz / .br 作为其变体，不单独成为资源
+        if (hasCompressedSuffix(file) && fs::exists(fs::path(file).replace_extension(""), ec)) continue;
+
+        Asset asset;
+        asset.path = "/" + fs::relative(file, root, ec).generic_string();
+        asset.mime_type = MimeTypes::getMimeType(file.extension().string());
+        struct stat st;
+        if (::stat(file.c_str(), &st) != 0 || !readFile(file, &asset.data)) {
+            std::cerr << "Failed to read " << file << std::endl;
+            return 1;
+        }
+        asset.mtime = st.st_mtime;
+        asset.etag = contentETag(asset.data);
+        if (MimeTypes::isCompressible(asset.mime_type) && asset.data.size() >= kMinCompressSize) {
+            if (!readFile(file.string() + ".gz", &asset.gzip) &&
+                !Compression::gzip(asset.data, &asset.gzip, kGzipLevel)) {
+                asset.gzip.clear();
+            }
+            if (!readFile(file.string() + ".br", &asset.brotli) &&
+                !Compression::brotli(asset.data, &asset.brotli, kBrotliQuality)) {
+                asset.brotli.clear();
+            }
+            // 没有变小的变体不值得发送
+            if (asset.gzip.size() >= asset.data.size()) asset.gzip.clear();
+            if (asset.brotli.size() >= asset.data.size()) asset.brotli.clear();
+        }
+        assets.push_back(std::move(asset));
+    }
+    if (ec) {
+        std::cerr << "Failed to scan " << root << ": " << ec.message() << std::endl;
+        return 1;
+    }
+    // 输出与遍历顺序无关，相同的输入生成相同的文件
+    std::sort(assets.begin(), assets.end(), [](const Asset& a, const Asset& b) { return a.path < b.path; });
+
+    std::ostringstream out;
+    out << "// 由 embed_assets 从 " << root.generic_string() << " 生成，不要手动修改\n";
+    out << "#include \"http/embedded_assets.h\"\n\n";
+    for (size_t i = 0; i < assets.size(); ++i) {
+        writeArray(out, "kData" + std::to_string(i), assets[i].data);
+        if (!assets[i].gzip.empty()) writeArray(out, "kGzip" + std::to_string(i), assets[i].gzip);
+        if (!assets[i].brotli.empty()) writeArray(out, "kBrotli" + std::to_string(i), assets[i].brotli);
+    }
+    out << "\nextern const EmbeddedAsset kEmbeddedAssets[];\n";
+    out << "const EmbeddedAsset kEmbeddedAssets[] = {\n";
+    for (size_t i = 0; i < assets.size(); ++i) {
+        const Asset& a = assets[i];
+        std::string n = std::to_string(i);
+        out << "    {" << quote(a.path) << ", " << quote(a.mime_type) << ", " << quote(a.etag) << ", "
+            << a.mtime << ", kData" << n << ", " << a.data.size() << ", "
+            << (a.gzip.empty() ? "nullptr" : "kGzip" + n) << ", " << a.gzip.size() << ", "
+            << (a.brotli.empty() ? "nullptr" : "kBrotli" + n) << ", " << a.brotli.size() << "},\n";
+    }
+    // 空目录时保留一个占位元素，数组长度不能为 0
+    if (assets.empty()) {
+        out << "    {nullptr, nullptr, nullptr, 0, nullptr, 0, nullptr, 0, nullptr, 0},\n";
+    }
+    out << "};\n";
+    out << "extern const size_t kEmbeddedAssetCount;\n";
+    out << "const size_t kEmbeddedAssetCount = " << assets.size() << ";\n";
+
+    std::ofstream output(argv[2], std::ios::out | std::ios::binary | std::ios::trunc);
+    output << out.str();
+    if (!output) {
+        std::cerr << "Failed to write " << argv[2] << std::endl;
+        return 1;
+    }
+    std::cout << "Embedded " << assets.size() << " assets from " << root << std::endl;
+    return 0;
+}
@@ -0,0 +1,55 @@
+// HTTP/1.1 请求解析器微基准
+// 用真实浏览器/客户端抓包得到的请求报文，测量 HttpRequest::parse 的单次耗时
+// 用法: ./parser_bench [iterations]
+#include "http_request.h"
+#include "buffer.h"
+#include "bench_common.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? std::atol(argv[1]) : 200000;
+    std::vector<Capture> captures = loadCaptures();
+
+    std::cout << std::left << std::setw(20) << "capture" << std::right << std::setw(8) << "bytes"
+              << std::setw(12) << "ns/req" << std::setw(12) << "MB/s" << std::endl;
+
+    HttpRequest request;
+    Buffer buffer;
+    for (const Capture& capture : captures) {
+        // 预热，并确认报文能被完整解析
+        buffer.append(capture.data);
+        if (!parseRequest(&request, &buffer) || !request.gotAll()) {
+            std::cerr << capture.name << ": parse failed" << std::endl;
+            return 1;
+        }
+        request.reset();
+        buffer.retrieveAll();
+
+        // 分多轮取最快一轮，减少调度和其他进程的干扰
+        const int kRounds = 5;
+        long per_round = std::max(1L, iterations / kRounds);
+        double ns = 0;
+        for (int round = 0; round < kRounds; ++round) {
+            auto start = std::chrono::steady_clock::now();
+            for (long i = 0; i < per_round; ++i) {
+                buffer.append(capture.data);
+                parseRequest(&request, &buffer);
+                request.reset();
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            double round_ns = std::chrono::duration<double, std::nano>(elapsed).count() / per_round;
+            if (round == 0 || round_ns < ns) ns = round_ns;
+        }
+        double mbps = capture.data.size() / ns * 1e9 / (1024 * 1024);
+        std::cout << std::left << std::setw(20) << capture.name << std::right << std::setw(8) << capture.data.size()
+                  << std::setw(12) << std::fixed << std::setprecision(1) << ns
+                  << std::setw(12) << std::setprecision(1) << mbps << std::endl;
+    }
+    return 0;
+}
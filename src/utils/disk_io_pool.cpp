@@ -0,0 +1,58 @@
+#include "utils/disk_io_pool.h"
+#include "utils/logger.h"
+
+DiskIoPool& DiskIoPool::instance() {
+    static DiskIoPool pool;
+    return pool;
+}
+
+DiskIoPool::~DiskIoPool() {
+    stop();
+}
+
+void DiskIoPool::start(int num_threads) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_ || num_threads <= 0) return;
+    running_ = true;
+    for (int i = 0; i < num_threads; ++i) {
+        threads_.emplace_back(&DiskIoPool::threadFunc, this);
+    }
+    LOG_INFO << "Disk I/O pool started with " << num_threads << " threads";
+}
+
+void DiskIoPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    cond_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+    threads_.clear();
+}
+
+void DiskIoPool::submit(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        tasks_.push_back(std::move(task));
+    }
+    cond_.notify_one();
+}
+
+void DiskIoPool::threadFunc() {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this] { return !running_ || !tasks_.empty(); });
+            // 停止时丢弃尚未执行的任务，等待它们的连接随进程一起结束
+            if (!running_) return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
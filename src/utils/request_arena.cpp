@@ -0,0 +1,73 @@
+#include "utils/request_arena.h"
+#include <cstdint>
+#include <new>
+
+RequestArena::RequestArena(size_t first_block, size_t max_retained)
+    : first_block_(first_block),
+      max_retained_(max_retained),
+      current_(0),
+      ptr_(nullptr),
+      end_(nullptr),
+      allocated_(0),
+      trim_pending_(false) {}
+
+RequestArena::~RequestArena() {
+    for (const Block& block : blocks_) {
+        ::operator delete(block.data);
+    }
+}
+
+void RequestArena::reset() {
+    current_ = 0;
+    ptr_ = blocks_.empty() ? nullptr : blocks_[0].data;
+    end_ = blocks_.empty() ? nullptr : blocks_[0].data + blocks_[0].size;
+    allocated_ = 0;
+    trim_pending_ = blocks_.size() > 1;
+}
+
+void* RequestArena::do_allocate(size_t bytes, size_t alignment) {
+    if (trim_pending_) trim();
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(ptr_) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    if (!ptr_ || aligned + bytes > reinterpret_cast<uintptr_t>(end_)) {
+        nextBlock(bytes, alignment);
+        aligned = (reinterpret_cast<uintptr_t>(ptr_) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    }
+    ptr_ = reinterpret_cast<char*>(aligned + bytes);
+    allocated_ += bytes;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void RequestArena::nextBlock(size_t bytes, size_t alignment) {
+    size_t needed = bytes + alignment;
+    // 上一个请求留下的块按顺序复用，放不下的块本次跳过
+    while (!blocks_.empty() && current_ + 1 < blocks_.size()) {
+        ++current_;
+        if (blocks_[current_].size >= needed) {
+            ptr_ = blocks_[current_].data;
+            end_ = ptr_ + blocks_[current_].size;
+            return;
+        }
+    }
+    size_t size = blocks_.empty() ? first_block_ : blocks_.back().size * 2;
+    while (size < needed) size *= 2;
+    // operator new 返回的地址满足 max_align_t 的对齐要求，更大的对齐由 do_allocate 在块内补齐
+    Block block{static_cast<char*>(::operator new(size)), size};
+    blocks_.push_back(block);
+    current_ = blocks_.size() - 1;
+    ptr_ = block.data;
+    end_ = block.data + block.size;
+}
+
+void RequestArena::trim() {
+    trim_pending_ = false;
+    size_t retained = 0;
+    size_t keep = 0;
+    while (keep < blocks_.size() && (keep == 0 || retained + blocks_[keep].size <= max_retained_)) {
+        retained += blocks_[keep].size;
+        ++keep;
+    }
+    for (size_t i = keep; i < blocks_.size(); ++i) {
+        ::operator delete(blocks_[i].data);
+    }
+    blocks_.resize(keep);
+}